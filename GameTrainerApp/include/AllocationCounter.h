@@ -0,0 +1,11 @@
+#pragma once
+#include <cstddef>
+
+// Counts every call to the global operator new in the process. Benchmarks
+// read it before and after a section to see how many heap allocations it made.
+// Only built with GAME_TRAINER_COUNT_ALLOCATIONS; otherwise Count stays at 0.
+class AllocationCounter {
+public:
+    static bool IsEnabled();
+    static size_t Count();
+};
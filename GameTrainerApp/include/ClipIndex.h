@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+struct ClipIndexEntry {
+    std::string clipId;
+    std::string triggerReason;
+    std::string filename;
+    double startTime;
+    double endTime;
+    double combatIntensity;
+    int enemyCount;
+    int damageTaken;
+    bool playerDied;
+    bool enemyKilled;
+};
+
+// On-disk layout: "<base>.idx" holds a header followed by fixed-size records,
+// "<base>.str" holds the strings they reference. Both files are append-only.
+#pragma pack(push, 1)
+struct ClipIndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+struct ClipIndexRecord {
+    double startTime;
+    double endTime;
+    double combatIntensity;
+    uint32_t clipIdOffset;
+    uint32_t clipIdLength;
+    uint32_t reasonOffset;
+    uint32_t reasonLength;
+    uint32_t filenameOffset;
+    uint32_t filenameLength;
+    uint32_t enemyCount;
+    int32_t damageTaken;
+    uint8_t flags;
+    uint8_t reserved[7];
+};
+#pragma pack(pop)
+
+class ClipIndex {
+private:
+    std::string basePath;
+    std::ofstream recordFile;
+    std::ofstream stringFile;
+    uint64_t stringTableSize;
+    size_t appendedRecords;
+    
+    uint32_t AppendString(const std::string& value);
+    
+public:
+    ClipIndex();
+    ~ClipIndex();
+    
+    bool Open(const std::string& basePath);
+    void Close();
+    bool IsOpen() const;
+    
+    bool Append(const ClipIndexEntry& entry);
+    
+    static bool Load(const std::string& basePath, std::vector<ClipIndexEntry>& entries);
+    static bool ExportCsv(const std::string& basePath, const std::string& csvFilename);
+    
+    std::string GetBasePath() const;
+    size_t GetAppendedCount() const;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "ClipIndex.h"
+#include <string>
+#include <vector>
+
+struct ClipIndexBenchmarkResult {
+    std::string storage;
+    int clipCount;
+    size_t files;
+    size_t bytes;
+    double writeMs;
+    double loadMs;          // Every clip's metadata back into memory
+    bool complete;          // Every clip came back, doubles to the CSV's six significant digits
+};
+
+// Session clip metadata as one clip index against the per-clip
+// "<clipId>_metadata.csv" files it replaced
+class ClipIndexBenchmark {
+private:
+    int clipCount;
+    std::string workDirectory;
+    
+    std::vector<ClipIndexEntry> GenerateEntries() const;
+    ClipIndexBenchmarkResult RunPerFile(const std::vector<ClipIndexEntry>& entries) const;
+    ClipIndexBenchmarkResult RunIndex(const std::vector<ClipIndexEntry>& entries) const;
+    static bool SameEntries(const std::vector<ClipIndexEntry>& expected, std::vector<ClipIndexEntry> loaded);
+    
+public:
+    ClipIndexBenchmark();
+    ~ClipIndexBenchmark();
+    
+    void SetClipCount(int count);
+    void SetWorkDirectory(const std::string& path);
+    
+    std::vector<ClipIndexBenchmarkResult> Run() const;
+    static void PrintResults(const std::vector<ClipIndexBenchmarkResult>& results);
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+struct CodecCandidate {
+    std::string name;
+    int fourcc;
+    std::string extension;  // Container the codec is written in
+};
+
+struct CodecBenchmarkResult {
+    std::string backend;
+    int backendApi;
+    std::string codec;
+    int fourcc;
+    std::string extension;
+    cv::Size resolution;
+    double targetFps;
+    bool supported;
+    int framesEncoded;
+    double encodeFps;
+    double cpuSeconds;
+    double bitrateMbps;
+    double psnr;            // Decoded output against the source frames, dB
+    bool keepsUp;           // Encodes faster than targetFps with headroom
+};
+
+class CodecBenchmark {
+private:
+    std::vector<CodecCandidate> codecs;
+    std::vector<cv::Size> resolutions;
+    double targetFps;
+    int framesPerRun;
+    std::string workDirectory;
+    std::vector<cv::Mat> recordedFrames;
+    
+    std::vector<cv::Mat> GenerateSyntheticFrames(cv::Size resolution) const;
+    std::vector<cv::Mat> ScaleRecordedFrames(cv::Size resolution) const;
+    CodecBenchmarkResult RunOne(const std::vector<cv::Mat>& frames, int backendApi, const CodecCandidate& candidate,
+                                cv::Size resolution) const;
+    double MeasurePsnr(const std::string& filename, const std::vector<cv::Mat>& frames) const;
+    
+public:
+    CodecBenchmark();
+    ~CodecBenchmark();
+    
+    // Configuration
+    void SetResolutions(const std::vector<cv::Size>& sizes);
+    void SetCodecs(const std::vector<CodecCandidate>& candidates);
+    void SetTargetFps(double fps);
+    void SetFramesPerRun(int frames);
+    void SetWorkDirectory(const std::string& path);
+    bool LoadRecordedFrames(const std::string& videoPath, int maxFrames = 300);
+    
+    // Benchmark
+    std::vector<CodecBenchmarkResult> Run();
+    
+    // Results
+    static bool SaveResults(const std::string& filename, const std::vector<CodecBenchmarkResult>& results);
+    static bool LoadResults(const std::string& filename, std::vector<CodecBenchmarkResult>& results);
+    static bool Recommend(const std::vector<CodecBenchmarkResult>& results, cv::Size resolution, double fps,
+                          CodecBenchmarkResult& recommendation);
+    static void PrintResults(const std::vector<CodecBenchmarkResult>& results);
+};
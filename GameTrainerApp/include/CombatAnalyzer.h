@@ -1,8 +1,17 @@
 #pragma once
 #include "EnemyDetector.h"
+#include "HudEventDetector.h"
+#include "HudGaugeReader.h"
+#include "DetectionPipeline.h"
+#include "ClipIndex.h"
+#include "OverlaySidecar.h"
+#include "PositionTracker.h"
 #include <vector>
 #include <string>
 #include <memory>
+#include <functional>
+
+class VideoRecorder;
 
 struct CombatState {
     bool isActive;
@@ -15,30 +24,54 @@ struct CombatState {
 
 struct CombatClip {
     std::string clipId;
-    double startTime;
-    double endTime;
+    double startTime; // Includes pre-roll before the trigger
+    double endTime; // Includes post-roll after combat ends
     std::string triggerReason; // "enemy_detected", "player_died", "combat_started"
     std::vector<EnemyDetection> enemies;
     bool playerDied;
     bool enemyKilled;
+    int damageTaken;
     double combatIntensity;
-    std::string filename; // Video file path
+    std::string filename; // Video file path, relative to the recorder's output path
 };
 
+// Receives the state after each analyzed frame, in frame order
+using CombatStateCallback = std::function<void(const CombatState& state, double timestamp)>;
+
 class CombatAnalyzer {
 private:
     EnemyDetector enemyDetector;
+    HudEventDetector hudEventDetector;
+    HudGaugeReader hudGaugeReader;
+    PositionTracker positionTracker;
     CombatState currentCombatState;
     std::vector<CombatClip> recordedClips;
+    ClipIndex clipIndex;
+    std::string sessionId;
     bool isRecording;
     double combatThreshold;
     double clipDuration;
+    double clipPreRoll;
+    double clipPostRoll;
+    VideoRecorder* videoRecorder; // Not owned; clips are cut from its replay buffer
     
     // Combat detection parameters
     double enemyDetectionCooldown;
     double combatTimeout;
     int minEnemiesForCombat;
     
+    DisplayGeometry displayGeometry;
+    double proximityRadius; // Normalized distance from the crosshair
+    
+    // Pipelined detection
+    DetectionPipeline detectionPipeline;
+    bool isPipelined;
+    int maxFramesInFlight;
+    CombatStateCallback stateCallback;
+    
+    CombatState ApplyFrameResult(const cv::Mat& frame, const std::vector<EnemyDetection>& enemies, double timestamp);
+    double FindDeathTime(double startTime, double endTime) const;
+    
 public:
     CombatAnalyzer();
     ~CombatAnalyzer();
@@ -47,9 +80,26 @@ public:
     bool Initialize();
     void SetCombatThreshold(double threshold);
     void SetClipDuration(double duration);
+    void SetClipPreRoll(double seconds);
+    void SetClipPostRoll(double seconds);
+    void SetDisplayGeometry(const DisplayGeometry& geometry);
+    DisplayGeometry GetDisplayGeometry() const;
+    void SetVideoRecorder(VideoRecorder* recorder); // Also shares the recorder's frame pool
+    void SetFramePool(std::shared_ptr<FramePool> pool);
     
     // Combat detection and analysis
     CombatState AnalyzeFrame(const cv::Mat& frame, double timestamp);
+    CombatState AnalyzeDetections(const cv::Mat& frame, const std::vector<EnemyDetection>& enemies, double timestamp); // Enemies found by another detector
+    
+    // Pipelined analysis: detection runs on worker threads, state updates stay in frame order
+    bool EnablePipelining(int workerCount, int maxInFlight = 4);
+    void DisablePipelining();
+    bool IsPipelined() const;
+    CombatState SubmitFrame(const cv::Mat& frame, double timestamp);
+    CombatState FlushPipeline();
+    void SetStateCallback(CombatStateCallback callback); // Pipelined results arrive frames after their submit
+    PipelineStats GetPipelineStats() const;
+    
     bool ShouldStartRecording(const CombatState& state);
     bool ShouldStopRecording(const CombatState& state);
     
@@ -61,12 +111,18 @@ public:
     // Combat event analysis
     std::string AnalyzeCombatEvent(const CombatClip& clip);
     double CalculateCombatIntensity(const std::vector<EnemyDetection>& enemies);
+    // A death is a death banner or spectator label, or a configured health gauge reading zero
     bool DetectPlayerDeath(const cv::Mat& frame);
     bool DetectEnemyKill(const cv::Mat& frame);
+    HudEventDetector& GetHudEventDetector();
+    HudGaugeReader& GetHudGaugeReader();
+    PositionTracker& GetPositionTracker();
+    std::vector<DamageEvent> GetDamageEvents(double startTime, double endTime) const;
     
     // State management
     void ResetCombatState();
     CombatState GetCurrentCombatState() const;
+    OverlayFrame GetOverlayFrame(double timestamp) const;
     bool IsRecording() const;
     
     // Configuration
@@ -76,8 +132,12 @@ public:
     
     // Utility
     std::string GenerateClipId(double timestamp);
+    bool SetSessionId(const std::string& sessionId);
+    void SetMapName(const std::string& mapName);
+    void EndSession(); // Saves <session>.gthm next to the <session>.gtta trajectory archive
     void SaveCombatMetadata(const CombatClip& clip);
     void LoadCombatMetadata(const std::string& sessionId);
+    bool ExportCombatMetadataCsv(const std::string& filename);
     
     // Debug
     void PrintCombatState() const;
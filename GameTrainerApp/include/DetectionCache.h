@@ -0,0 +1,71 @@
+#pragma once
+#include "EnemyDetector.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct DetectionCacheStats {
+    size_t lookups;
+    size_t hits;
+    size_t misses;
+    size_t invalidations;
+    size_t expirations;
+    double savedMilliseconds;
+    double averageDetectionMs;
+    double hitRate;
+};
+
+struct DetectionCacheEntry {
+    uint64_t frameHash;
+    std::vector<EnemyDetection> detections;
+    size_t lastUsed;
+    size_t storedAt;    // Lookup count when detected, for the age limit
+};
+
+class DetectionCache {
+private:
+    std::vector<DetectionCacheEntry> entries;
+    uint64_t lastFrameHash;
+    bool hasLastFrame;
+    size_t useCounter;
+    
+    int maxEntries;
+    int hashTolerance;
+    int sceneChangeDistance;
+    int maxAge;
+    bool isEnabled;
+    
+    size_t lookups;
+    size_t hits;
+    size_t invalidations;
+    size_t expirations;
+    double savedMilliseconds;
+    double averageDetectionMs;
+    size_t timedDetections;
+    
+public:
+    DetectionCache();
+    ~DetectionCache();
+    
+    // Hashing
+    static uint64_t ComputeFrameHash(const cv::Mat& grayFrame);
+    static int HammingDistance(uint64_t a, uint64_t b);
+    
+    // Cache operations
+    bool Lookup(uint64_t frameHash, std::vector<EnemyDetection>& detections);
+    void Store(uint64_t frameHash, const std::vector<EnemyDetection>& detections, double detectionMs);
+    void Invalidate();
+    
+    // Configuration
+    void SetEnabled(bool enabled);
+    void SetMaxEntries(int entries);
+    void SetHashTolerance(int bits);
+    void SetSceneChangeDistance(int bits);
+    void SetMaxAge(int frames); // Frames a detection may be reused before the frame is detected again
+    bool IsEnabled() const;
+    
+    // Stats
+    DetectionCacheStats GetStats() const;
+    void ResetStats();
+    void PrintStats() const;
+};
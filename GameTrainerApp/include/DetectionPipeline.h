@@ -0,0 +1,95 @@
+#pragma once
+#include "EnemyDetector.h"
+#include "DetectionCache.h"
+#include "FramePool.h"
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+struct DetectionJob {
+    uint64_t frameNumber;
+    double timestamp;
+    cv::Mat frame;
+    std::chrono::steady_clock::time_point submittedAt;
+};
+
+struct DetectionResult {
+    uint64_t frameNumber;
+    double timestamp;
+    cv::Mat frame;
+    std::vector<EnemyDetection> enemies;
+    double detectionMs;
+    double addedLatencyMs; // Submit to in-order delivery
+    std::chrono::steady_clock::time_point submittedAt;
+};
+
+struct PipelineStats {
+    int workerCount;
+    size_t queueDepth;      // Submitted, waiting for a worker
+    size_t inFlight;        // Submitted, not yet delivered in order
+    size_t reorderDepth;    // Finished out of order, waiting on an earlier frame
+    size_t framesSubmitted;
+    size_t framesDelivered;
+    double averageDetectionMs;
+    double averageLatencyMs;
+    double maxLatencyMs;
+    size_t cacheLookups;        // Summed over every worker's detector
+    size_t cacheHits;
+    double cacheHitRate;
+    double cacheSavedMs;
+};
+
+class DetectionPipeline {
+private:
+    std::vector<std::unique_ptr<EnemyDetector>> detectors;
+    std::vector<std::thread> workers;
+    std::deque<DetectionJob> jobQueue;
+    std::map<uint64_t, DetectionResult> completedResults;
+    
+    mutable std::mutex pipelineMutex;
+    std::condition_variable jobCondition;
+    std::condition_variable resultCondition;
+    
+    uint64_t nextFrameNumber;
+    uint64_t nextDeliveryNumber;
+    bool isRunning;
+    DisplayGeometry displayGeometry;
+    std::shared_ptr<FramePool> framePool;
+    
+    size_t detectedFrames;
+    double totalDetectionMs;
+    double totalLatencyMs;
+    double maxLatencyMs;
+    
+    // Copied from each worker's detector after every frame, so stats never touch a busy detector
+    std::vector<DetectionCacheStats> workerCacheStats;
+    
+    void WorkerLoop(int workerIndex);
+    DetectionResult TakeNextResult();
+    
+public:
+    DetectionPipeline();
+    ~DetectionPipeline();
+    
+    bool Start(int workerCount);
+    void Stop();
+    bool IsRunning() const;
+    void SetDisplayGeometry(const DisplayGeometry& geometry); // Applied to workers on Start
+    void SetFramePool(std::shared_ptr<FramePool> pool);
+    
+    // Pooled frames are shared, anything else is copied once. Never blocks;
+    // callers bound latency by draining once GetInFlightCount() reaches their limit
+    uint64_t Submit(const cv::Mat& frame, double timestamp);
+    bool TryPopResult(DetectionResult& result);
+    bool WaitForResult(DetectionResult& result);
+    
+    size_t GetInFlightCount() const;
+    PipelineStats GetStats() const;
+    void PrintStats() const;
+};
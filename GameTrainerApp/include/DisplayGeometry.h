@@ -0,0 +1,32 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Per-session screen layout. Lengths are normalized by frame height so the same
+// scene yields the same values at any resolution with the same aspect ratio.
+struct DisplayGeometry {
+    int width;
+    int height;
+    double horizontalFov; // Degrees
+    cv::Point2f crosshair; // Normalized (0.0 to 1.0)
+    cv::Rect2f hudSafeArea; // Normalized; detections outside it are HUD, not enemies
+    
+    DisplayGeometry();
+    DisplayGeometry(int width, int height, double horizontalFov = 90.0);
+    
+    static const int kReferenceHeight = 720;
+    
+    bool Matches(const cv::Mat& frame) const;
+    DisplayGeometry WithResolution(int newWidth, int newHeight) const;
+    
+    cv::Point2f GetCrosshairPixels() const;
+    cv::Point2f Normalize(const cv::Point2f& pixel) const;
+    cv::Point2f ToPixels(const cv::Point2f& normalized) const;
+    cv::Rect ToPixels(const cv::Rect2f& normalized) const;
+    
+    double NormalizeLength(double pixels) const;
+    double LengthToPixels(double normalizedLength) const;
+    double GetReferenceScale() const; // Pixels here per pixel at kReferenceHeight
+    double DistanceFromCrosshair(const cv::Point2f& pixel) const; // Normalized
+    double AngleFromCrosshair(const cv::Point2f& pixel) const; // Degrees
+    bool IsInHudSafeArea(const cv::Point2f& pixel) const;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include "DisplayGeometry.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -12,6 +13,9 @@ struct EnemyDetection {
     double timestamp;
 };
 
+struct DetectionCacheStats;
+class DetectionCache;
+
 struct CombatEvent {
     double startTime;
     double endTime;
@@ -32,6 +36,12 @@ private:
     double minDetectionConfidence;
     int maxDetectionsPerFrame;
     double detectionCooldown;
+    int frameCounter;
+    
+    DisplayGeometry displayGeometry;
+    double combatRadius; // Normalized distance from the crosshair
+    
+    std::unique_ptr<DetectionCache> detectionCache;
     
 public:
     EnemyDetector();
@@ -53,6 +63,9 @@ public:
     void SetDetectionThreshold(double threshold);
     void SetMinConfidence(double confidence);
     void SetMaxDetections(int maxDetections);
+    void SetDisplayGeometry(const DisplayGeometry& geometry);
+    DisplayGeometry GetDisplayGeometry() const;
+    void SetCombatRadius(double normalizedRadius);
     
     cv::Rect ExpandBoundingBox(const cv::Rect& box, double factor = 1.2);
     double CalculateDetectionConfidence(const cv::Mat& region);
@@ -61,6 +74,10 @@ public:
     cv::Mat DrawDetections(const cv::Mat& frame, const std::vector<EnemyDetection>& detections);
     void SaveDetectionFrame(const cv::Mat& frame, const std::vector<EnemyDetection>& detections, const std::string& filename);
     
+    void SetCacheEnabled(bool enabled);
+    DetectionCacheStats GetCacheStats() const;
+    void PrintCacheStats() const;
+    
     bool IsInitialized() const;
     void Reset();
 };
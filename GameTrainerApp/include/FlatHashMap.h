@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+// Open-addressing hash map for integer keys with linear probing. Keys and
+// values sit in flat arrays, so a lookup is usually one cache line and an
+// insert into a map that has already grown never allocates.
+template <typename Key, typename Value>
+class FlatHashMap {
+private:
+    std::vector<Key> keys;
+    std::vector<Value> values;
+    std::vector<uint8_t> occupied;
+    size_t count;
+
+    static size_t Hash(Key key) {
+        // Finalizer from MurmurHash3, so neighbouring cells spread out
+        uint64_t x = static_cast<uint64_t>(key);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return static_cast<size_t>(x);
+    }
+
+    size_t Probe(Key key) const {
+        size_t mask = keys.size() - 1;
+        size_t slot = Hash(key) & mask;
+        while (occupied[slot] && keys[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void Grow() {
+        std::vector<Key> oldKeys;
+        std::vector<Value> oldValues;
+        std::vector<uint8_t> oldOccupied;
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        oldOccupied.swap(occupied);
+
+        size_t capacity = oldKeys.empty() ? 16 : oldKeys.size() * 2;
+        keys.resize(capacity);
+        values.resize(capacity);
+        occupied.assign(capacity, 0);
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (!oldOccupied[i]) continue;
+            size_t slot = Probe(oldKeys[i]);
+            keys[slot] = oldKeys[i];
+            values[slot] = std::move(oldValues[i]);
+            occupied[slot] = 1;
+        }
+    }
+
+public:
+    FlatHashMap() : count(0) {}
+
+    Value* Find(Key key) {
+        if (count == 0) return nullptr;
+        size_t slot = Probe(key);
+        return occupied[slot] ? &values[slot] : nullptr;
+    }
+
+    const Value* Find(Key key) const {
+        if (count == 0) return nullptr;
+        size_t slot = Probe(key);
+        return occupied[slot] ? &values[slot] : nullptr;
+    }
+
+    // Inserts a default value when the key is missing
+    Value& operator[](Key key) {
+        // Kept at most half full so probe runs stay short
+        if ((count + 1) * 2 > keys.size()) {
+            Grow();
+        }
+        size_t slot = Probe(key);
+        if (!occupied[slot]) {
+            keys[slot] = key;
+            values[slot] = Value();
+            occupied[slot] = 1;
+            count++;
+        }
+        return values[slot];
+    }
+
+    // Capacity is kept for reuse
+    void Clear() {
+        for (size_t i = 0; i < occupied.size(); i++) {
+            if (occupied[i]) {
+                values[i] = Value();
+                occupied[i] = 0;
+            }
+        }
+        count = 0;
+    }
+
+    size_t Size() const { return count; }
+    bool Empty() const { return count == 0; }
+    size_t Capacity() const { return keys.size(); }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        for (size_t i = 0; i < occupied.size(); i++) {
+            if (occupied[i]) {
+                visit(keys[i], values[i]);
+            }
+        }
+    }
+};
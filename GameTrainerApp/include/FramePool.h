@@ -0,0 +1,59 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+
+struct FramePoolStats {
+    size_t capacity;
+    size_t inUse;
+    size_t peakInUse;
+    size_t framesAcquired;
+    size_t overflowAllocations;  // Pool exhausted, frame allocated on the heap
+    size_t copies;
+    size_t typeMismatches;     // Copied outside the pool, warned about once
+    double copiesPerFrame;
+    double occupancy;
+};
+
+// Fixed set of preallocated frame buffers. Handles are ordinary cv::Mat
+// headers sharing a slot's data, so OpenCV's refcount tracks every holder
+// (detector, pipeline, replay buffer, encoder) and the slot becomes free
+// again once only the pool references it.
+class FramePool {
+private:
+    std::vector<cv::Mat> slots;
+    cv::Size frameSize;
+    int frameType;
+    size_t nextSlot;
+    
+    mutable std::mutex poolMutex;
+    mutable size_t peakInUse;
+    size_t framesAcquired;
+    size_t overflowAllocations;
+    size_t copies;
+    size_t typeMismatches;
+    
+    bool IsSlotFree(const cv::Mat& slot) const;
+    
+public:
+    FramePool(size_t capacity = 64, cv::Size size = cv::Size(1280, 720), int type = CV_8UC3);
+    
+    // Initialization
+    void Reset(size_t capacity, cv::Size size, int type = CV_8UC3);
+    
+    // Handles
+    cv::Mat Acquire();
+    cv::Mat CopyIn(const cv::Mat& frame);
+    bool Owns(const cv::Mat& frame) const;
+    void RecordCopy();
+    
+    cv::Size GetFrameSize() const;
+    size_t GetCapacity() const;
+    size_t GetInUseCount() const;
+    
+    // Stats
+    FramePoolStats GetStats() const;
+    void ResetStats();
+    void PrintStats() const;
+};
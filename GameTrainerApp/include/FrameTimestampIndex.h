@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+// On-disk layout: "<video>.fts" holds a header followed by one fixed-size
+// record per written frame, in write order
+#pragma pack(push, 1)
+struct FrameTimestampHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+struct FrameTimestampRecord {
+    double timestamp;   // Capture time of the frame
+    uint32_t frameNumber;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+class FrameTimestampIndex {
+private:
+    std::ofstream file;
+    uint32_t appendedFrames;
+    std::vector<double> timestamps;
+    
+public:
+    FrameTimestampIndex();
+    ~FrameTimestampIndex();
+    
+    // Writing
+    bool Open(const std::string& path);
+    bool Append(uint32_t frameNumber, double timestamp);
+    void Close();
+    bool IsOpen() const;
+    
+    // Reading
+    bool Load(const std::string& path);
+    bool IsLoaded() const;
+    size_t GetFrameCount() const;
+    double GetStartTime() const;
+    double GetEndTime() const;
+    
+    // Time <-> frame mapping
+    int FrameAtTime(double timestamp) const;    // Frame on screen at that time
+    int NearestFrame(double timestamp) const;
+    double TimeOfFrame(int frameNumber) const;
+    double TimeOfFrame(int frameNumber, double fallbackFps) const; // Extrapolates past the last indexed frame
+    double GetMaxDrift(double nominalFps) const;
+    
+    static std::string IndexFilenameFor(const std::string& videoFilename);
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include "DisplayGeometry.h"
+#include "TrajectoryArchive.h"
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct EnemyTrajectory;
+struct DeathAnalysis;
+
+enum class HeatmapLayer {
+    ENEMY_PRESENCE,     // Every visible enemy position
+    KILLER_POSITIONS    // Where the closest enemy was on screen when the player died
+};
+
+std::string HeatmapLayerToString(HeatmapLayer layer);
+
+// Counts over a grid laid across the normalized screen
+struct Heatmap {
+    int width;
+    int height;
+    std::vector<uint32_t> counts;   // Row-major
+    uint64_t total;
+};
+
+struct HeatmapKey {
+    std::string mapName;
+    HeatmapLayer layer;
+    int width;
+    int height;
+
+    bool operator<(const HeatmapKey& other) const;
+};
+
+// A session file to fold into a multi-session heatmap: either a heatmap file
+// written by Save, or a trajectory archive, whose map name is given here.
+// Archives only hold each trajectory's recent history and no deaths, so they
+// are a fallback for sessions recorded without a heatmap file.
+struct HeatmapSource {
+    std::string path;
+    std::string mapName;
+};
+
+// On-disk layout: a header, then one record per heatmap: the record header,
+// the map name, and the counts. Sparse records store (cell, count) pairs and
+// are used whenever that is smaller, which is nearly always for killers.
+#pragma pack(push, 1)
+struct HeatmapFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sessionCount;
+    uint32_t heatmapCount;
+};
+
+struct HeatmapRecordHeader {
+    uint8_t layer;
+    uint8_t encoding;
+    uint16_t nameLength;
+    uint16_t width;
+    uint16_t height;
+    uint32_t cellCount;     // Cells stored, all of them when dense
+    uint64_t total;
+};
+#pragma pack(pop)
+
+// Per-map, per-resolution histograms updated one position at a time. Partial
+// accumulators built on different threads or from different sessions are
+// combined with Merge, so a multi-session heatmap never replays tracking.
+class HeatmapAccumulator {
+private:
+    std::map<HeatmapKey, Heatmap> heatmaps;
+    std::vector<cv::Size> resolutions;
+    std::string mapName;
+    size_t sessionCount;
+
+    // Layers of the current map at every resolution, so adding a position
+    // does not search the map
+    static const int kLayerCount = 2;
+    std::vector<Heatmap*> activeLayers[kLayerCount];
+
+    Heatmap& FindOrCreate(const HeatmapKey& key);
+    void RefreshActiveLayers();
+    static void AddToHeatmap(Heatmap& heatmap, const cv::Point2f& normalized, uint32_t weight);
+    bool LoadArchive(const std::string& path, const TrajectoryArchiveHeader& header, const std::string& archiveMapName);
+    bool LoadHeatmapFile(const std::string& path);
+
+public:
+    HeatmapAccumulator();
+    HeatmapAccumulator(const HeatmapAccumulator& other);
+    HeatmapAccumulator& operator=(const HeatmapAccumulator& other);
+    ~HeatmapAccumulator();
+
+    // Configuration
+    void SetMapName(const std::string& name);
+    const std::string& GetMapName() const;
+    void SetResolutions(const std::vector<cv::Size>& gridSizes);
+    const std::vector<cv::Size>& GetResolutions() const;
+
+    // Incremental updates for the current map
+    void BeginSession();
+    void AddPosition(HeatmapLayer layer, const cv::Point2f& normalized, uint32_t weight = 1);
+    void AddTrajectory(const EnemyTrajectory& trajectory, const DisplayGeometry& geometry);
+    void AddDeath(const DeathAnalysis& death, const DisplayGeometry& geometry);
+
+    void Merge(const HeatmapAccumulator& other);
+    void Clear();
+
+    // Heatmap files and trajectory archives are told apart by their header
+    bool Save(const std::string& filename) const;
+    bool Load(const std::string& filename, const std::string& archiveMapName = "unknown");
+
+    // Each worker folds its share of the sources into its own accumulator;
+    // the partials are merged at the end. Unreadable sources are skipped.
+    static bool Build(const std::vector<HeatmapSource>& sources, int workerCount, HeatmapAccumulator& result);
+
+    const Heatmap* Find(const std::string& map, HeatmapLayer layer, const cv::Size& gridSize) const;
+    size_t GetSessionCount() const;
+    size_t GetHeatmapCount() const;
+    std::vector<std::string> GetMapNames() const;
+
+    // Log-scaled and color mapped; empty when that heatmap does not exist
+    cv::Mat Render(const std::string& map, HeatmapLayer layer, const cv::Size& gridSize, const cv::Size& outputSize) const;
+
+    void PrintSummary() const;
+};
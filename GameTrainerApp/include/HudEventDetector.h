@@ -0,0 +1,87 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <string>
+
+enum class HudEventType {
+    ENEMY_KILLED,
+    PLAYER_DIED,
+    SPECTATING
+};
+
+struct HudEvent {
+    double timestamp;
+    HudEventType type;
+    std::string regionName;
+    double matchScore;
+};
+
+struct HudTemplate {
+    cv::Mat image; // Grayscale, as captured
+    int referenceHeight; // Frame height the template was captured at
+    cv::Mat scaled; // Resized for the current frame height and downscale factor
+};
+
+struct HudRegion {
+    std::string name;
+    cv::Rect2f area; // Normalized to frame size (0.0 to 1.0)
+    HudEventType eventType;
+    std::vector<HudTemplate> templates;
+    double cooldown;
+    double lastTriggered;
+    double scaledFor;
+};
+
+class HudEventDetector {
+private:
+    std::vector<HudRegion> regions;
+    std::vector<HudEvent> events;
+    
+    double matchThreshold;
+    double downscaleFactor;
+    double lastProcessMs;
+    double averageProcessMs;
+    size_t processedFrames;
+    
+    HudRegion* FindRegion(const std::string& name);
+    cv::Mat ExtractRegion(const cv::Mat& frame, const HudRegion& region) const;
+    void PrepareTemplates(HudRegion& region, int frameHeight);
+    double MatchRegion(const cv::Mat& crop, const HudRegion& region) const;
+    
+public:
+    HudEventDetector();
+    ~HudEventDetector();
+    
+    // Region and template configuration
+    void LoadDefaultRegions();
+    void AddRegion(const std::string& name, const cv::Rect2f& area, HudEventType type, double cooldown = 1.0);
+    bool AddTemplate(const std::string& regionName, const cv::Mat& templateImage, int referenceHeight = 720);
+    bool LoadTemplate(const std::string& regionName, const std::string& filename, int referenceHeight = 720);
+    bool HasTemplates() const;
+    std::vector<HudRegion> GetRegions() const;
+    
+    // Per-frame processing
+    std::vector<HudEvent> ProcessFrame(const cv::Mat& frame, double timestamp);
+    bool MatchesEvent(const cv::Mat& frame, HudEventType type);
+    bool MatchesDeath(const cv::Mat& frame);
+    
+    // Event queries
+    std::vector<HudEvent> GetEvents() const;
+    std::vector<HudEvent> GetEventsInRange(double startTime, double endTime) const;
+    bool HasEventInRange(HudEventType type, double startTime, double endTime) const;
+    bool HasDeathInRange(double startTime, double endTime) const;
+    void ClearEvents();
+    
+    // Configuration
+    void SetMatchThreshold(double threshold);
+    void SetDownscaleFactor(double factor);
+    
+    // Utility
+    double GetLastProcessTime() const;
+    double GetAverageProcessTime() const;
+    std::string GetEventTypeString(HudEventType type) const;
+    
+    // The death banner and the spectator label both mean the player is out
+    static bool IsDeathEvent(HudEventType type);
+    void PrintEvents() const;
+};
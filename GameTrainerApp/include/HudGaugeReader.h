@@ -0,0 +1,114 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+enum class GaugeType {
+    HEALTH,
+    ARMOR,
+    AMMO
+};
+
+enum class GaugeReadMode {
+    BAR,
+    DIGITS
+};
+
+struct GaugeRegion {
+    std::string name;
+    GaugeType type;
+    GaugeReadMode mode;
+    cv::Rect2f area; // Normalized to frame size (0.0 to 1.0)
+    cv::Scalar fillLower; // BGR range counted as "filled" for bars, as glyph ink for digits
+    cv::Scalar fillUpper;
+    cv::Scalar backgroundLower; // BGR range of a bar's empty track, to tell an empty bar from a hidden one
+    cv::Scalar backgroundUpper;
+    int maxValue;
+};
+
+struct HudGaugeSample {
+    double timestamp;
+    int16_t health; // -1 when not readable
+    int16_t armor;
+    int16_t ammo;
+};
+
+struct DamageEvent {
+    double timestamp;
+    int amount;
+    int healthBefore;
+    int healthAfter;
+};
+
+class HudGaugeReader {
+private:
+    std::vector<GaugeRegion> regions;
+    std::vector<HudGaugeSample> samples; // Not yet written to the series file, bounded
+    std::vector<DamageEvent> damageEvents; // Bounded, oldest dropped first
+    cv::Mat digitTemplates[10];
+    std::ofstream seriesFile;
+    std::string seriesPath;
+    size_t seriesSamples;
+    HudGaugeSample latestSample;
+    
+    int lastHealth;
+    int zeroHealthSamples;      // Consecutive readable samples at zero health
+    bool depletionPending;
+    DamageEvent pendingDepletion;
+    int minDamage;
+    double averageReadMs;
+    size_t readCount;
+    
+    cv::Mat ExtractRegion(const cv::Mat& frame, const GaugeRegion& region) const;
+    int ReadBar(const cv::Mat& crop, const GaugeRegion& region) const; // -1 when the bar is not on screen
+    int ReadDigits(const cv::Mat& crop, const GaugeRegion& region) const;
+    int RecognizeDigit(const cv::Mat& glyph) const;
+    void RecordSample(const HudGaugeSample& sample);
+    void TrackHealth(const HudGaugeSample& sample); // Damage and depletion events only
+    void AddDamageEvent(const DamageEvent& event);
+    void FlushSamples();
+    
+public:
+    HudGaugeReader();
+    ~HudGaugeReader();
+    
+    // Region and template configuration. Gauge layouts differ per game, so
+    // nothing is read until regions are added or loaded.
+    bool LoadRegions(const std::string& filename);
+    void AddRegion(const GaugeRegion& region);
+    bool HasRegions() const;
+    void SetDigitTemplate(int digit, const cv::Mat& glyph);
+    bool LoadDigitTemplates(const std::string& directory);
+    bool HasDigitTemplates() const;
+    
+    // Per-frame processing
+    HudGaugeSample ProcessFrame(const cv::Mat& frame, double timestamp);
+    int ReadHealth(const cv::Mat& frame) const; // -1 without a readable health region, nothing is recorded
+    double MeasureFillRatio(const cv::Mat& crop, const cv::Scalar& fillLower, const cv::Scalar& fillUpper) const;
+    
+    // Series queries
+    std::vector<HudGaugeSample> GetSamples() const;
+    std::vector<DamageEvent> GetDamageEvents() const;
+    std::vector<DamageEvent> GetDamageEventsInRange(double startTime, double endTime) const;
+    int GetDamageTakenInRange(double startTime, double endTime) const;
+    bool HealthDepletedInRange(double startTime, double endTime) const;
+    bool IsHealthDepleted() const; // Zero for long enough to count as a death
+    HudGaugeSample GetLatestSample() const;
+    
+    // Configuration
+    void SetMinDamage(int damage);
+    void Reset();
+    
+    // Persistence. With a series open, samples are appended to it in batches
+    // and the in-memory buffer only holds the ones not yet written.
+    bool OpenSeries(const std::string& filename);
+    void CloseSeries();
+    bool IsSeriesOpen() const;
+    void SaveGaugeSeries(const std::string& filename);
+    void LoadGaugeSeries(const std::string& filename);
+    
+    double GetAverageReadTime() const;
+    std::string GetGaugeTypeString(GaugeType type) const;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+
+// Minimum-cost assignment between the rows and columns of a dense cost matrix,
+// solved with shortest augmenting paths (Hungarian / Jonker-Volgenant)
+class LinearAssignment {
+public:
+    // Solver buffers, kept by callers that solve every frame so repeated
+    // solves of similar size do not allocate
+    struct Workspace {
+        std::vector<double> transposed;
+        std::vector<int> transposedAssignment;
+        std::vector<double> u;
+        std::vector<double> v;
+        std::vector<int> rowOfColumn;
+        std::vector<int> previousColumn;
+        std::vector<double> minSlack;
+        std::vector<char> visited;
+    };
+    
+    // costs is row-major, rows x cols. Returns the column assigned to each row,
+    // or -1 when there are more rows than columns and the row is left over.
+    static std::vector<int> Solve(const std::vector<double>& costs, int rows, int cols);
+    static void Solve(const std::vector<double>& costs, int rows, int cols, std::vector<int>& assignment,
+                      Workspace& workspace);
+    
+private:
+    static void SolveWide(const double* costs, int rows, int cols, std::vector<int>& assignment, Workspace& workspace);
+};
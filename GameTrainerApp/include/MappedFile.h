@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile {
+private:
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+    
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool Open(const std::string& filename);
+    void Close();
+    bool IsOpen() const;
+    
+    const uint8_t* Data() const;
+    size_t Size() const;
+};
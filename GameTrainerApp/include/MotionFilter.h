@@ -0,0 +1,41 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Constant-velocity Kalman state for one trajectory: x, y, vx, vy in pixels
+// and pixels per second. Acceleration enters as process noise.
+struct MotionState {
+    cv::Matx41d state;
+    cv::Matx44d covariance;
+    double timestamp;
+    bool initialized;
+};
+
+struct MotionPrediction {
+    cv::Point2f position;
+    cv::Point2f velocity;
+    cv::Matx22d covariance;     // Innovation covariance, position uncertainty plus measurement noise
+    double timestamp;
+};
+
+class MotionFilter {
+private:
+    double accelerationNoise;   // Standard deviation, pixels per second squared
+    double measurementNoise;    // Standard deviation, pixels
+    double initialVelocityNoise;
+    
+    void Propagate(const MotionState& motion, double timestamp, cv::Matx41d& state, cv::Matx44d& covariance) const;
+    
+public:
+    MotionFilter();
+    ~MotionFilter();
+    
+    void SetNoise(double acceleration, double measurement, double initialVelocity);
+    
+    void Initialize(MotionState& motion, const cv::Point2f& position, double timestamp) const;
+    // Predict and Update work on one trajectory at a time
+    MotionPrediction Predict(const MotionState& motion, double timestamp) const;
+    void Update(MotionState& motion, const cv::Point2f& measurement, double timestamp) const;
+    
+    static double MahalanobisSquared(const MotionPrediction& prediction, const cv::Point2f& measurement);
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include "CombatAnalyzer.h"
+#include "PositionTracker.h"
+#include "FrameTimestampIndex.h"
+#include <string>
+#include <vector>
+
+struct AnalysisSegment {
+    int index;
+    int warmupStartFrame; // Decoding starts here so state is settled by startFrame
+    int startFrame;
+    int endFrame; // Exclusive
+};
+
+struct CombatInterval {
+    double startTime;
+    double endTime;
+    double peakIntensity;
+    int maxEnemies;
+    bool continuesFromPrevious; // Already active when the segment's own range began
+    bool openEnded; // Still active when the segment's own range ended
+};
+
+struct SegmentResult {
+    AnalysisSegment segment;
+    std::vector<CombatInterval> combatIntervals;
+    std::vector<EnemyTrajectory> trajectories;
+    std::vector<IndexedPosition> positions; // Only those inside the segment's own range
+    int framesDecoded;
+    bool seekFellBack; // The seek missed its frame, so the segment decoded up to it from the start
+    bool succeeded;
+};
+
+struct OfflineAnalysisResult {
+    std::vector<CombatInterval> combatIntervals;
+    std::vector<EnemyTrajectory> trajectories;
+    SpatioTemporalIndex positionIndex; // Every position under its stitched track ID
+    int segmentCount;
+    int framesAnalyzed;
+    int framesDecoded; // Includes overlap re-decoding
+    int seekFallbacks;
+    double startTime; // Time of the first frame
+    double videoDuration;
+    double elapsedSeconds;
+};
+
+// Segmented analysis diffed against one sequential pass over the same video.
+// Positions match when both passes put them at the same frame and place.
+struct OfflineComparison {
+    OfflineAnalysisResult segmented;
+    OfflineAnalysisResult sequential;
+    int matchedIntervals;
+    int segmentedOnlyIntervals;
+    int sequentialOnlyIntervals;
+    double maxBoundaryError; // Seconds, over matched intervals' starts and ends
+    size_t sequentialPositions;
+    size_t matchedPositions;
+    int fragmentedTracks; // Sequential tracks split over several segmented tracks
+    int mergedTracks; // Segmented tracks covering several sequential tracks
+};
+
+class OfflineAnalyzer {
+private:
+    int workerCount;
+    double segmentDuration;
+    double overlapDuration;
+    int keyframeInterval;
+    double trackingDistance; // Normalized
+    bool singleSegment; // One segment on one worker, the reference for Compare
+    std::string mapName;
+    FrameTimestampIndex frameTimestamps; // Capture times when the recorder wrote them
+    
+    std::vector<AnalysisSegment> PlanSegments(int frameCount, double fps) const;
+    SegmentResult AnalyzeSegment(const std::string& videoPath, const AnalysisSegment& segment, double fps, int detectionWorkers) const;
+    void StitchCombatIntervals(const std::vector<SegmentResult>& segments, OfflineAnalysisResult& result) const;
+    void StitchTrajectories(const std::vector<SegmentResult>& segments, double fps, double matchDistance, OfflineAnalysisResult& result) const;
+    
+public:
+    OfflineAnalyzer();
+    ~OfflineAnalyzer();
+    
+    bool Analyze(const std::string& videoPath, OfflineAnalysisResult& result);
+    bool Compare(const std::string& videoPath, OfflineComparison& comparison);
+    
+    // Configuration
+    void SetWorkerCount(int workers);
+    void SetSegmentDuration(double seconds);
+    void SetOverlapDuration(double seconds);
+    void SetKeyframeInterval(int frames);
+    void SetMapName(const std::string& name); // Analyze saves the video's heatmap under it
+    
+    void PrintResult(const OfflineAnalysisResult& result) const;
+    void PrintComparison(const OfflineComparison& comparison) const;
+};
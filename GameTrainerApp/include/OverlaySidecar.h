@@ -0,0 +1,87 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "EnemyDetector.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+// Coordinates are normalized to the frame, so one sidecar renders onto the
+// master, the proxy or a re-scaled export alike
+struct OverlayDetection {
+    cv::Rect2f box;         // Zero size for point markers
+    float confidence;
+    std::string enemyType;
+};
+
+struct OverlayFrame {
+    double timestamp;
+    uint32_t frameNumber;
+    bool combatActive;
+    float combatIntensity;
+    std::vector<OverlayDetection> detections;
+    std::vector<cv::Point2f> trajectory;
+};
+
+// On-disk layout: a header, then one variable-length record per encoded
+// frame: the record header, its detections, then its trajectory points
+#pragma pack(push, 1)
+struct OverlaySidecarHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct OverlayRecordHeader {
+    double timestamp;
+    uint32_t frameNumber;
+    uint8_t flags;
+    uint8_t combatIntensity;    // 0-255
+    uint16_t detectionCount;
+    uint16_t trajectoryCount;
+};
+
+struct OverlayDetectionRecord {
+    uint16_t x;                 // Normalized to 0-65535
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint8_t confidence;         // 0-255
+    uint8_t enemyType;
+};
+
+struct OverlayPointRecord {
+    uint16_t x;
+    uint16_t y;
+};
+#pragma pack(pop)
+
+class OverlaySidecar {
+private:
+    std::string filename;
+    std::ofstream file;
+    size_t recordCount;
+    
+public:
+    OverlaySidecar();
+    ~OverlaySidecar();
+    
+    // Writing
+    bool Open(const std::string& path);
+    bool Append(const OverlayFrame& overlay);
+    void Close();
+    bool IsOpen() const;
+    size_t GetRecordCount() const;
+    
+    // Reading
+    static bool Load(const std::string& path, std::vector<OverlayFrame>& frames);
+    static const OverlayFrame* FindFrame(const std::vector<OverlayFrame>& frames, double timestamp);
+    static std::string SidecarFilenameFor(const std::string& videoFilename);
+    
+    // Rendering
+    static OverlayFrame FromDetections(double timestamp, const std::vector<EnemyDetection>& detections, cv::Size frameSize);
+    static OverlayFrame FromPositions(double timestamp, const std::vector<cv::Point2f>& positions, cv::Size frameSize);
+    static bool IsEmpty(const OverlayFrame& overlay);
+    static void Render(cv::Mat& frame, const OverlayFrame& overlay);
+    static bool RenderVideo(const std::string& videoFilename, const std::string& outputFilename);
+};
@@ -1,26 +1,52 @@
 #pragma once
 #include "EnemyDetector.h"
+#include "DisplayGeometry.h"
+#include "MotionFilter.h"
+#include "TrajectoryHistory.h"
+#include "SpatioTemporalIndex.h"
+#include "TrajectoryArchive.h"
+#include "HeatmapAccumulator.h"
+#include "LinearAssignment.h"
+#include "FlatHashMap.h"
 #include <vector>
-#include <map>
+#include <deque>
 #include <string>
+#include <functional>
+#include <cstdint>
 
 struct EnemyPosition {
     cv::Point2f position;
     double timestamp;
     double confidence;
-    std::string enemyId;
+    int trackId;
     bool isVisible;
 };
 
+// Addresses a live trajectory by slot. The generation changes whenever the
+// slot is freed, so a handle to an evicted trajectory goes stale instead of
+// aliasing whatever moves in next.
+struct TrackHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+    
+    bool IsValid() const { return slot != UINT32_MAX; }
+    bool operator==(const TrackHandle& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const TrackHandle& other) const { return !(*this == other); }
+};
+
 struct EnemyTrajectory {
-    std::string enemyId;
-    std::vector<EnemyPosition> positions;
+    int trackId;                    // Unique for the session; EnemyName gives the display form
+    TrackHandle handle;             // Invalid for copies of archived trajectories
+    TrajectoryHistory history;      // Last kHistorySeconds of positions, oldest first
     double firstSeen;
     double lastSeen;
     bool isActive;
-    cv::Point2f predictedNextPosition;
+    cv::Point2f predictedNextPosition;  // One frame interval after lastSeen
+    cv::Point2f velocity;           // Pixels per second
     double movementSpeed;
     std::string movementPattern; 
+    MotionState motion;
+    MotionPrediction prediction;    // Cached for the frame being associated
 };
 
 struct DeathAnalysis {
@@ -28,17 +54,60 @@ struct DeathAnalysis {
     cv::Point2f deathPosition;
     std::vector<EnemyPosition> nearbyEnemies;
     std::string deathCause; 
+    cv::Point2f enemyPosition;  // Closest nearby enemy, valid when enemyDistance >= 0
     double enemyDistance;
     std::string enemyWeapon;
     bool enemyWasVisible;
 };
 
+enum class AssociationMethod {
+    GREEDY,     // Each detection takes the nearest trajectory in turn
+    GLOBAL      // Minimum total distance over the whole frame
+};
+
+enum class MotionModel {
+    TWO_POINT,  // Velocity from the last two positions
+    KALMAN      // Constant-velocity Kalman filter per trajectory
+};
+
+struct AssociationStats {
+    size_t framesProcessed;
+    size_t detectionsProcessed;
+    size_t candidatesExamined;      // Trajectories distance-tested during association
+    size_t unmatchedDetections;     // Started a new trajectory
+    size_t unmatchedTracks;         // Active but not seen this frame
+    size_t componentsSolved;
+    size_t largestComponent;        // Detections plus trajectories in the biggest assignment problem
+    double averageInnovation;       // Pixels between prediction and matched detection
+    double velocityJitter;          // Mean change in estimated velocity per update
+    double averageUpdateMs;
+    double peakUpdateMs;
+    double candidatesPerDetection;
+};
+
+std::string AssociationMethodToString(AssociationMethod method);
+std::string MotionModelToString(MotionModel model);
+
 class PositionTracker {
 private:
-    std::map<std::string, EnemyTrajectory> enemyTrajectories;
+    // A deque keeps trajectory pointers stable as slots are added
+    struct TrackSlot {
+        EnemyTrajectory trajectory;
+        uint32_t generation;
+        bool occupied;
+        bool inGrid;
+        int64_t gridCell;
+    };
+    std::deque<TrackSlot> trackSlots;
+    std::vector<uint32_t> freeSlots;
+    size_t trajectoryCount;
     std::vector<DeathAnalysis> deathAnalyses;
     int nextEnemyId;
     
+    // Measured between updates, the horizon of predictedNextPosition
+    double lastUpdateTime;
+    double frameInterval;
+    
     double maxTrackingDistance;
     double trajectoryTimeout;
     int minPositionsForTrajectory;
@@ -46,6 +115,74 @@ private:
     double deathAnalysisRadius;
     double visibilityThreshold;
     
+    // Distances above are in pixels at DisplayGeometry::kReferenceHeight
+    DisplayGeometry displayGeometry;
+    double ScaledDistance(double referencePixels) const;
+    
+    // Uniform hash of each active trajectory's latest position. Cells are one
+    // tracking distance wide, so a match can only be in the 3x3 neighbourhood.
+    bool useSpatialGrid;
+    double gridCellSize;
+    FlatHashMap<int64_t, std::vector<EnemyTrajectory*>> trajectoryGrid;
+    AssociationStats associationStats;
+    double updateTotalMs;
+    double innovationTotal;
+    size_t innovationCount;
+    double velocityJitterTotal;
+    size_t velocityJitterCount;
+    
+    AssociationMethod associationMethod;
+    std::vector<TrackHandle> lastAssignedHandles;
+    
+    // Per-frame association buffers, reused so steady-state frames do not allocate
+    std::vector<std::pair<EnemyTrajectory*, double>> candidateScratch;
+    std::vector<std::pair<EnemyTrajectory*, double>> edges;
+    std::vector<size_t> edgeOffsets;
+    std::vector<int> slotTrackIndex;    // Per slot, -1 unless a candidate this frame
+    std::vector<EnemyTrajectory*> candidateTracks;
+    std::vector<int> unionParent;
+    std::vector<std::pair<int, int>> componentOrder;
+    std::vector<int> trackColumn;
+    std::vector<double> assignmentCosts;
+    std::vector<int> assignment;
+    LinearAssignment::Workspace assignmentWorkspace;
+    std::vector<EnemyTrajectory*> frameMatches;
+    std::vector<EnemyTrajectory*> updatedTrajectories;
+    
+    MotionModel motionModel;
+    MotionFilter motionFilter;
+    // Positions of the last indexRetention seconds, for queries about moments already past
+    SpatioTemporalIndex positionIndex;
+    double indexRetention;
+    
+    // Finished trajectories leave memory once older than this: for the
+    // archive when one is open, otherwise they are discarded
+    TrajectoryArchive archive;
+    double finishedRetention;
+    size_t discardedCount;
+    
+    // Visible enemy positions and killers of this session, saved for multi-session heatmaps
+    HeatmapAccumulator heatmaps;
+    
+    int64_t GridKey(const cv::Point2f& position) const;
+    void IndexTrajectory(EnemyTrajectory& trajectory, const cv::Point2f& position);
+    void RemoveFromGrid(const EnemyTrajectory& trajectory);
+    void RebuildGrid();
+    size_t IndexPredictions(double timestamp);
+    
+    MotionPrediction PredictMotion(const EnemyTrajectory& trajectory, double timestamp) const;
+    const MotionPrediction& PredictionFor(EnemyTrajectory& trajectory, double timestamp);
+    void ApplyMotionEstimate(EnemyTrajectory& trajectory);
+    void GatherCandidates(const cv::Point2f& position, double timestamp,
+                          std::vector<std::pair<EnemyTrajectory*, double>>& candidates);
+    void AssociateGlobal(const std::vector<EnemyDetection>& detections, double timestamp,
+                         std::vector<EnemyTrajectory*>& matches);
+    TrackSlot& AllocateSlot();
+    void FreeSlot(uint32_t index);
+    EnemyTrajectory& StartTrajectory(const EnemyPosition& position);
+    void IndexPosition(const EnemyPosition& position);
+    void RecordPosition(const EnemyPosition& position);    // Indexed and counted in the session heatmap
+    
 public:
     PositionTracker();
     ~PositionTracker();
@@ -54,13 +191,37 @@ public:
     void SetTrackingDistance(double distance);
     void SetTrajectoryTimeout(double timeout);
     void SetMinPositionsForTrajectory(int minPositions);
+    void SetDisplayGeometry(const DisplayGeometry& geometry);
+    void SetUseSpatialGrid(bool enabled);
+    void SetAssociationMethod(AssociationMethod method);
+    AssociationMethod GetAssociationMethod() const;
+    void SetMotionModel(MotionModel model);
+    MotionModel GetMotionModel() const;
+    
+    // The archive belongs to one session. Closing it archives every trajectory
+    // still in memory, so the file holds the whole session; Reset forgets it.
+    bool OpenArchive(const std::string& filename, bool compressed = true);
+    void CloseArchive();
+    void SetFinishedRetention(double seconds);
+    void SetIndexRetention(double seconds);     // 0 keeps every position of the session
+    size_t GetArchivedCount() const;
+    size_t GetDiscardedCount() const;           // Evicted without an archive open
+    size_t GetTrajectoryCount() const;          // In memory: active and recently finished
+    static std::string EnemyName(int trackId);
+    
+    void SetMapName(const std::string& mapName);
+    const HeatmapAccumulator& GetHeatmaps() const;
+    bool SaveHeatmaps(const std::string& filename) const;
     
     void UpdateEnemyPositions(const std::vector<EnemyDetection>& detections, double timestamp);
     std::vector<EnemyTrajectory> GetActiveTrajectories() const;
-    std::vector<EnemyTrajectory> GetAllTrajectories() const;
+    std::vector<EnemyTrajectory> GetAllTrajectories() const;      // Includes archived trajectories
+    void ForEachTrajectory(const std::function<void(const EnemyTrajectory&)>& visit) const;
+    const std::vector<TrackHandle>& GetLastAssignedHandles() const;     // One per detection of the last update
+    const EnemyTrajectory* GetTrajectory(TrackHandle handle) const;     // Null once evicted
     
     EnemyTrajectory* FindEnemyTrajectory(const cv::Point2f& position, double timestamp);
-    std::string AssignEnemyId(const cv::Point2f& position, double timestamp);
+    int AssignEnemyId(const cv::Point2f& position, double timestamp);
     void UpdateTrajectory(EnemyTrajectory& trajectory, const EnemyPosition& position);
     
     void AnalyzeDeath(const cv::Point2f& deathPosition, double timestamp);
@@ -71,12 +232,17 @@ public:
     void PredictNextPosition(EnemyTrajectory& trajectory);
     std::string AnalyzeMovementPattern(const EnemyTrajectory& trajectory);
     
-    bool WasEnemyVisibleAtTime(const std::string& enemyId, double timestamp);
+    bool WasEnemyVisibleAtTime(int trackId, double timestamp);
     std::vector<EnemyPosition> GetEnemiesNearPosition(const cv::Point2f& position, double radius, double timestamp);
+    const SpatioTemporalIndex& GetPositionIndex() const;
     
     void CleanupOldTrajectories(double currentTimestamp);
     void Reset();
     
+    AssociationStats GetAssociationStats() const;
+    void ResetAssociationStats();
+    void PrintAssociationStats() const;
+    
     void PrintTrajectoryInfo() const;
     void PrintDeathAnalyses() const;
     void SaveTrajectoryData(const std::string& filename);
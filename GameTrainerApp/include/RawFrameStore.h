@@ -0,0 +1,111 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+
+// On-disk layout: "<name>.gtraw" starts with a header page, followed by one
+// fixed-size, page-aligned slot per frame holding the pixels row by row.
+// "<name>.gtidx" holds a header and one record per frame that reached disk.
+#pragma pack(push, 1)
+struct RawFrameHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t type;          // cv::Mat type of every frame
+    uint32_t rowBytes;
+    uint64_t frameBytes;
+    uint64_t slotBytes;     // frameBytes rounded up to the I/O alignment
+    uint64_t dataOffset;    // Offset of the first slot
+};
+
+struct RawFrameIndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+struct RawFrameIndexRecord {
+    uint64_t offset;
+    double timestamp;
+    uint32_t frameNumber;
+    uint32_t reserved;
+};
+#pragma pack(pop)
+
+struct RawFrameWriterStats {
+    size_t framesWritten;
+    size_t bytesWritten;
+    size_t writeCalls;
+    size_t preallocatedFrames;
+    double writeSeconds;        // Wall time spent inside write calls
+    double throughputGBps;      // Sustained rate while writing
+    bool directIo;
+};
+
+class RawFrameWriter {
+private:
+#ifdef _WIN32
+    void* fileHandle;
+#else
+    int fileDescriptor;
+#endif
+    std::ofstream indexFile;
+    RawFrameHeader header;
+    uint8_t* stagingBuffer;
+    size_t stagingSlots;
+    size_t stagedFrames;
+    std::vector<RawFrameIndexRecord> stagedRecords;
+    uint64_t writeOffset;
+    RawFrameWriterStats stats;
+    
+    bool OpenFile(const std::string& path, bool direct);
+    bool WriteAt(const uint8_t* buffer, size_t bytes, uint64_t offset);
+    bool Preallocate(uint64_t bytes);
+    void TruncateTo(uint64_t bytes);
+    void CloseFile();
+    bool Flush();
+    
+public:
+    RawFrameWriter();
+    ~RawFrameWriter();
+    RawFrameWriter(const RawFrameWriter&) = delete;
+    RawFrameWriter& operator=(const RawFrameWriter&) = delete;
+    
+    bool Open(const std::string& path, cv::Size frameSize, int type, size_t preallocateFrames, bool directIo = true);
+    bool Append(const cv::Mat& frame, double timestamp);
+    void Close();
+    bool IsOpen() const;
+    size_t GetStagedFrameCount() const; // Accepted, not yet on disk
+    RawFrameWriterStats GetStats() const;
+    
+    static std::string IndexFilenameFor(const std::string& rawFilename);
+    static double ThreadCpuSeconds();
+};
+
+class RawFrameReader {
+private:
+    MappedFile data;
+    RawFrameHeader header;
+    std::vector<RawFrameIndexRecord> records;
+    
+public:
+    RawFrameReader();
+    ~RawFrameReader();
+    
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const;
+    
+    size_t GetFrameCount() const;
+    cv::Size GetFrameSize() const;
+    double GetTimestamp(size_t index) const;
+    
+    // Read-only view into the mapping, valid until the reader is closed
+    cv::Mat GetFrame(size_t index) const;
+};
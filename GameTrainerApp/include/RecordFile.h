@@ -0,0 +1,84 @@
+#pragma once
+#include "MappedFile.h"
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+// Reads the binary formats written as a header followed by appended records.
+// An interrupted append leaves a torn trailing record, which ends the walk
+// instead of being read.
+class RecordReader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+
+public:
+    explicit RecordReader(const MappedFile& file);
+
+    // Copies the file header and checks it is in the expected format
+    template <typename Header>
+    bool ReadHeader(Header& header, const char (&magic)[4], uint32_t version);
+    template <typename Header>
+    bool ReadHeader(Header& header, const char (&magic)[4], uint32_t version, size_t recordSize);
+
+    template <typename Record>
+    bool Peek(Record& record) const;
+    template <typename Record>
+    bool Read(Record& record); // False once no complete record is left
+    bool Fits(size_t bytes) const;
+    void Skip(size_t bytes);
+    size_t Remaining() const;
+    const uint8_t* Current() const;
+
+    // Formats with fixed-size records also store the record size
+    template <typename Header>
+    static bool MatchesFormat(const Header& header, const char (&magic)[4], uint32_t version);
+    template <typename Header>
+    static bool MatchesFormat(const Header& header, const char (&magic)[4], uint32_t version, size_t recordSize);
+
+    // Header plus every complete record, what is left after dropping a torn one
+    static uint64_t CompleteSize(uint64_t fileSize, size_t headerSize, size_t recordSize);
+
+    // Companion files sit next to the file they describe, under another extension
+    static std::string ReplaceExtension(const std::string& filename, const std::string& extension);
+};
+
+template <typename Header>
+bool RecordReader::ReadHeader(Header& header, const char (&magic)[4], uint32_t version) {
+    return Read(header) && MatchesFormat(header, magic, version);
+}
+
+template <typename Header>
+bool RecordReader::ReadHeader(Header& header, const char (&magic)[4], uint32_t version, size_t recordSize) {
+    return Read(header) && MatchesFormat(header, magic, version, recordSize);
+}
+
+template <typename Record>
+bool RecordReader::Peek(Record& record) const {
+    if (!Fits(sizeof(record))) {
+        return false;
+    }
+    std::memcpy(&record, data + offset, sizeof(record));
+    return true;
+}
+
+template <typename Record>
+bool RecordReader::Read(Record& record) {
+    if (!Peek(record)) {
+        return false;
+    }
+    offset += sizeof(record);
+    return true;
+}
+
+template <typename Header>
+bool RecordReader::MatchesFormat(const Header& header, const char (&magic)[4], uint32_t version) {
+    return std::memcmp(header.magic, magic, sizeof(header.magic)) == 0 && header.version == version;
+}
+
+template <typename Header>
+bool RecordReader::MatchesFormat(const Header& header, const char (&magic)[4], uint32_t version, size_t recordSize) {
+    return MatchesFormat(header, magic, version) && header.recordSize == recordSize;
+}
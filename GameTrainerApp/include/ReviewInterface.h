@@ -3,10 +3,12 @@
 #include <vector>
 #include "ConcentrationTracker.h"
 #include "GameplayAnalyzer.h"
+#include "FrameTimestampIndex.h"
 
 struct GameplayClip {
     std::string clipId;
     std::string filename;
+    std::string proxyFilename;  // Low-res review copy, empty when none was recorded
     double duration; 
     std::string description;
     double timestamp;
@@ -21,12 +23,16 @@ private:
     int currentClipIndex;
     double currentPlaybackTime;
     bool isPlaying;
+    FrameTimestampIndex clipTimestamps;
+    std::string clipDirectory;
 
 public:
     ReviewInterface();
     ~ReviewInterface();
     
     void LoadClips(const std::string& sessionId);
+    void SetClipDirectory(const std::string& path); // The recorder's output path, which clip filenames are relative to
+    bool LoadClipIndex(const std::string& sessionId);
     void AddClip(const GameplayClip& clip);
     std::vector<GameplayClip> GetClips() const;
     
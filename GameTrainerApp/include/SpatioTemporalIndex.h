@@ -0,0 +1,61 @@
+#pragma once
+#include "TrajectoryHistory.h"
+#include "FlatHashMap.h"
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct IndexedPosition {
+    cv::Point2f position;
+    double timestamp;
+    float confidence;
+    int trackId;
+    bool isVisible;
+};
+
+// Positions bucketed by time, then hashed into a uniform grid within each
+// bucket. Finding the buckets is logarithmic in session length and only the
+// cells under the query circle are visited.
+class SpatioTemporalIndex {
+private:
+    // Cells and tracks point at their newest entry, and each entry links to
+    // the previous one, so inserting allocates nothing beyond vector growth
+    struct Bucket {
+        std::vector<IndexedPosition> entries;
+        std::vector<uint32_t> nextInCell;
+        std::vector<uint32_t> nextInTrack;
+        FlatHashMap<int64_t, uint32_t> cells;
+        FlatHashMap<int, uint32_t> tracks;
+    };
+
+    std::map<int64_t, Bucket> buckets;
+    double bucketSeconds;
+    double cellSize;
+    size_t entryCount;
+    size_t lastBucketSize; // Size of the bucket inserted into most recently
+
+    int64_t BucketKey(double timestamp) const;
+    int64_t CellCoordinate(float value) const;
+
+public:
+    SpatioTemporalIndex(double bucketSeconds = 0.25, double cellSize = 128.0);
+
+    void Insert(const IndexedPosition& position);
+    void InsertHistory(int trackId, const TrajectoryHistory& history);
+    bool InsertArchive(const std::string& path);    // Every sample of a TrajectoryArchive file
+    void ExpireBefore(double timestamp);
+    void Clear();
+
+    // Positions within radius of center with |t - timestamp| < window
+    size_t QueryRadius(const cv::Point2f& center, double radius, double timestamp, double window,
+                       std::vector<IndexedPosition>& results) const;
+    // Positions with start <= t < end
+    size_t QueryTimeRange(double start, double end, std::vector<IndexedPosition>& results) const;
+    bool WasVisible(int trackId, double timestamp, double window) const;
+
+    size_t Size() const;
+    size_t BucketCount() const;
+    size_t MemoryBytes() const;
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <string>
+
+struct SyntheticCheckResult {
+    std::string name;
+    bool passed;
+    std::string detail;     // Measured values, or the first mismatch
+};
+
+// Runs analysis components on generated input whose answer is known, so a
+// change in behavior shows up without a recording or a game running
+class SyntheticChecks {
+private:
+    unsigned int seed;
+    
+    cv::Mat MakeBackground(const cv::Size& size, unsigned int frameSeed) const;
+    
+public:
+    SyntheticChecks();
+    ~SyntheticChecks();
+    
+    void SetSeed(unsigned int value);
+    
+    std::vector<SyntheticCheckResult> Run() const;
+    
+    // Kill feed, death banner and spectator label templates drawn into frames at 720p and 1080p
+    SyntheticCheckResult CheckHudEvents() const;
+    
+    // A combat clip cut from the replay buffer covers trigger - pre-roll to stop + post-roll, every frame once
+    SyntheticCheckResult CheckClipBoundaries() const;
+    
+    // With capture jitter and dropped frames, the recorded timestamp index maps
+    // input events to within one frame of the frame on screen
+    SyntheticCheckResult CheckTimestampAlignment() const;
+    
+    // A recorded file replayed into a throttled encoder under each backpressure
+    // policy: only BLOCK waits, and every frame is either written or counted as dropped
+    SyntheticCheckResult CheckEncoderBackpressure() const;
+    
+    // The same enemy layouts rendered at 720p, 1080p and 1440p give the same detections,
+    // tracks, combat intensity and combat state
+    SyntheticCheckResult CheckResolutionInvariance() const;
+    
+    static void PrintResults(const std::vector<SyntheticCheckResult>& results);
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include "PositionTracker.h"
+#include <vector>
+#include <string>
+
+enum class TrackingScenario {
+    RANDOM,     // Enemies wander independently
+    CROSSING    // Pairs run head-on along shared lanes and pass through each other
+};
+
+struct TrackingBenchmarkResult {
+    TrackingScenario scenario;
+    int trackCount;
+    bool spatialGrid;
+    AssociationMethod method;
+    MotionModel motionModel;
+    int frames;
+    double averageUpdateMs;
+    double peakUpdateMs;
+    double framesPerSecond;
+    double allocationsPerFrame;     // Heap allocations made inside UpdateEnemyPositions
+    double candidatesPerDetection;
+    double averageInnovation;       // Pixels between prediction and matched detection
+    double velocityJitter;          // Mean change in estimated velocity per update, pixels per second
+    size_t idSwitches;              // Times a true enemy's assigned ID changed
+    size_t trajectoriesCreated;     // Equal to trackCount when no identity was lost
+};
+
+struct HistoryBenchmarkResult {
+    std::string storage;
+    int trackCount;
+    double fps;
+    double nanosecondsPerUpdate;    // Append, expire and the speed and pattern analysis
+    double bytesPerTrack;           // Steady state with a full ten second window
+};
+
+struct IndexBenchmarkResult {
+    std::string query;
+    size_t positions;
+    double linearMicroseconds;      // Per query, scanning every stored position
+    double indexedMicroseconds;     // Per query, through SpatioTemporalIndex
+    size_t matches;                 // Over all queries, identical for both
+};
+
+struct MemoryBenchmarkResult {
+    std::string mode;               // "unbounded" keeps everything, "discarded" has no archive, "archived" evicts to disk
+    double sessionSeconds;
+    size_t trajectoriesCreated;     // Through GetAllTrajectories plus the discarded ones
+    size_t peakInMemory;            // Trajectories held in memory
+    size_t archived;
+    size_t discarded;
+    double archiveKilobytes;
+    double indexMegabytes;          // Position index at the end of the session
+    double averageUpdateMs;
+};
+
+struct TrackingScene {
+    std::vector<std::vector<EnemyDetection>> detections;
+    std::vector<std::vector<int>> truthIds;     // True enemy behind each detection
+};
+
+std::string TrackingScenarioToString(TrackingScenario scenario);
+
+class TrackingBenchmark {
+private:
+    std::vector<int> trackCounts;
+    int framesPerRun;
+    double fps;
+    cv::Size field;
+    
+    TrackingScene GenerateScene(TrackingScenario scenario, int trackCount) const;
+    TrackingBenchmarkResult RunOne(const TrackingScene& scene, TrackingScenario scenario, int trackCount,
+                                   bool spatialGrid, AssociationMethod method, MotionModel motionModel) const;
+    
+public:
+    TrackingBenchmark();
+    ~TrackingBenchmark();
+    
+    void SetTrackCounts(const std::vector<int>& counts);
+    void SetFramesPerRun(int frames);
+    
+    std::vector<TrackingBenchmarkResult> Run();
+    std::vector<HistoryBenchmarkResult> RunHistory() const;
+    std::vector<IndexBenchmarkResult> RunSpatialIndex() const;
+    std::vector<MemoryBenchmarkResult> RunBoundedMemory() const;
+    static void PrintResults(const std::vector<TrackingBenchmarkResult>& results);
+    static void PrintHistoryResults(const std::vector<HistoryBenchmarkResult>& results);
+    static void PrintIndexResults(const std::vector<IndexBenchmarkResult>& results);
+    static void PrintMemoryResults(const std::vector<MemoryBenchmarkResult>& results);
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <functional>
+#include <cstdint>
+
+struct EnemyTrajectory;
+
+// On-disk layout: a header, then one variable-length record per finished
+// trajectory: the record header followed by its samples. Compressed records
+// store samples as zigzag varint deltas of 1/16 px positions and microsecond
+// timestamps, which takes roughly a third of the raw size.
+#pragma pack(push, 1)
+struct TrajectoryArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint16_t frameWidth;        // Pixels the positions are in, 0 when unknown
+    uint16_t frameHeight;
+};
+
+struct TrajectoryRecordHeader {
+    int32_t trackId;
+    uint32_t sampleCount;
+    uint32_t payloadBytes;
+    uint8_t encoding;
+    uint8_t movementPattern;
+    uint16_t reserved;
+    double firstSeen;
+    double lastSeen;
+    float velocityX;
+    float velocityY;
+    float movementSpeed;
+};
+
+struct TrajectorySampleRecord {
+    double timestamp;
+    float x;
+    float y;
+    uint8_t confidence;         // 0-255
+    uint8_t visible;
+};
+#pragma pack(pop)
+
+class TrajectoryArchive {
+private:
+    std::string filename;
+    std::ofstream file;
+    bool compressed;
+    int frameWidth;
+    int frameHeight;
+    size_t recordCount;
+    size_t sampleCount;
+    uint64_t bytesWritten;
+    std::vector<uint8_t> payload;
+
+public:
+    TrajectoryArchive();
+    ~TrajectoryArchive();
+
+    // Writing
+    bool Open(const std::string& path, bool compress = true, int width = 0, int height = 0);
+    bool Append(const EnemyTrajectory& trajectory);
+    void Close();
+    void Reset();       // Closes and forgets the file, which stays on disk
+    bool IsOpen() const;
+    bool IsCompressed() const;
+    int GetFrameWidth() const;
+    int GetFrameHeight() const;
+    const std::string& GetFilename() const;
+    size_t GetRecordCount() const;
+    size_t GetSampleCount() const;
+    uint64_t GetBytesWritten() const;
+
+    // Reading, one trajectory at a time. Return false from visit to stop early.
+    static bool ReadHeader(const std::string& path, TrajectoryArchiveHeader& header);
+    static bool ForEach(const std::string& path, const std::function<bool(const EnemyTrajectory&)>& visit);
+    static bool Load(const std::string& path, std::vector<EnemyTrajectory>& trajectories);
+};
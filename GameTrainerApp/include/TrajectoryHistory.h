@@ -0,0 +1,58 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <cstdint>
+
+// Per-track circular buffer of recent samples, one array per field so the
+// analysis loops run over contiguous floats. Storage doubles on demand up to
+// maxCapacity, after which the oldest sample is overwritten.
+class TrajectoryHistory {
+private:
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> confidences;
+    std::vector<double> timestamps;
+    std::vector<uint8_t> visible;
+    size_t head;            // Slot of the oldest sample
+    size_t count;
+    size_t maxCapacity;
+
+    // Kept in step with every push and expiry so speed and centroid are O(1)
+    double pathLength;
+    double pathDuration;
+    double sumX;
+    double sumY;
+
+    size_t Slot(size_t index) const;
+    void Reallocate(size_t capacity);
+    void PopFront();
+
+public:
+    static const size_t kDefaultMaxCapacity = 2048;     // 10 s at 200 fps
+
+    explicit TrajectoryHistory(size_t maxCapacity = kDefaultMaxCapacity);
+
+    void SetMaxCapacity(size_t capacity);
+    void Push(const cv::Point2f& position, double timestamp, float confidence, bool isVisible);
+    size_t ExpireBefore(double cutoffTime);
+    void Clear();
+
+    size_t Size() const;
+    bool Empty() const;
+    size_t Capacity() const;
+    size_t MaxCapacity() const;
+    size_t MemoryBytes() const;
+
+    // Index 0 is the oldest sample
+    cv::Point2f Position(size_t index) const;
+    double Timestamp(size_t index) const;
+    float Confidence(size_t index) const;
+    bool IsVisible(size_t index) const;
+    cv::Point2f Back() const;
+    double BackTimestamp() const;
+
+    double PathLength() const;      // Summed over steps with a positive time difference
+    double PathDuration() const;
+    cv::Point2f Centroid() const;
+    double MeanDistanceFrom(const cv::Point2f& center) const;
+};
@@ -1,57 +1,279 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include "DisplayGeometry.h"
+#include "FramePool.h"
+#include "OverlaySidecar.h"
+#include "FrameTimestampIndex.h"
+#include "RawFrameStore.h"
 #include <string>
 #include <vector>
 #include <memory>
-#include <queue>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
 
 struct FrameBuffer {
     cv::Mat frame;
+    std::vector<uchar> encoded;     // JPEG bytes once compressed, frame is then empty
     double timestamp;
-    std::vector<cv::Point2f> enemyPositions;
+    uint64_t sequence;
+    std::shared_ptr<const OverlayFrame> overlay;    // Written to the sidecar, not burned in
 };
 
+struct ReplayBufferStats {
+    size_t frames;
+    size_t compressedFrames;
+    size_t bytes;
+    size_t budgetBytes;
+    double historySeconds;
+    double secondsPerMB;
+    double averageCompressMs;
+    double averageFrameKB;
+};
+
+// What AddFrame does when the encoder queue is full
+enum class BackpressurePolicy {
+    BLOCK,              // Wait for the encoder to free a slot
+    DROP_OLDEST,        // Discard the oldest queued frame
+    DROP_NEWEST,        // Discard the incoming frame
+    DEGRADE_RESOLUTION  // Queue half-resolution frames past the high-water mark
+};
+
+struct EncoderStats {
+    size_t framesSubmitted;
+    size_t framesEncoded;
+    size_t framesDropped;
+    size_t framesDegraded;
+    size_t queueDepth;
+    size_t maxQueueDepth;
+    size_t queueCapacity;
+    double encoderFps;
+    double averageEncodeMs;
+    double averageCpuMs;    // Encoder thread CPU per frame
+    double inputGBps;       // Frame bytes consumed per second of encode time
+    double blockedMs;       // Time the caller spent waiting under BLOCK
+};
+
+struct RecordingSegment {
+    int index;
+    std::string filename;
+    double startTime;
+    double endTime;
+    int frameCount;
+};
+
+// A clip as a list of segment files trimmed at the edges, written in
+// ffconcat format so players can stream it without re-encoding
+struct ClipSegmentRef {
+    std::string filename;
+    double inPoint;     // Seconds into the segment
+    double outPoint;
+};
+
+struct ClipManifest {
+    std::string filename;
+    double startTime;
+    double endTime;
+    std::vector<ClipSegmentRef> segments;
+};
+
+struct ClipRequest {
+    double startTime;
+    double endTime;
+    std::string filename;
+    double proxyScale;          // 0 when no review proxy is written
+    std::vector<FrameBuffer> frames;
+};
+
+std::string BackpressurePolicyToString(BackpressurePolicy policy);
+
 class VideoRecorder {
 private:
     cv::VideoWriter videoWriter;
-    std::queue<FrameBuffer> frameBuffer;
+    std::deque<FrameBuffer> frameBuffer;
     std::string outputPath;
     std::string currentFilename;
     bool isRecording;
     bool isInitialized;
+    bool isBuffering;
     
     int frameWidth;
     int frameHeight;
     double fps;
     int bufferSize;
+    double replayDuration;
     int codec;
+    int writerApi;
+    std::string containerExtension;
+    bool codecPinned;           // Set explicitly, so benchmark results are not applied
+    
+    // Byte-budgeted replay buffer, compressed on worker threads
+    size_t replayBudgetBytes;
+    size_t bufferedBytes;
+    uint64_t nextBufferSequence;
+    bool compressReplayBuffer;
+    int replayJpegQuality;
+    std::deque<FrameBuffer> compressionQueue;
+    std::condition_variable compressionCondition;
+    std::vector<std::thread> compressionThreads;
+    bool stopCompressionThreads;
+    size_t compressedFrameCount;
+    double compressTotalMs;
+    
+    // Retroactive clip extraction
+    mutable std::mutex bufferMutex;
+    std::condition_variable clipCondition;
+    std::vector<ClipRequest> pendingClips;
+    std::deque<ClipRequest> readyClips;
+    std::thread clipThread;
+    bool stopClipThread;
+    size_t savedClipCount;
+    
+    // Asynchronous encoding of the live recording
+    std::deque<FrameBuffer> encodeQueue;
+    mutable std::mutex encoderMutex;
+    std::condition_variable encoderCondition;
+    std::condition_variable encoderSpaceCondition;
+    std::thread encoderThread;
+    bool stopEncoderThread;
+    size_t encodeQueueCapacity;
+    size_t encodeQueuePixels;
+    BackpressurePolicy backpressurePolicy;
+    double encoderThrottleMs;
+    EncoderStats encoderStats;
+    double encodeTotalMs;
+    double encodeCpuSeconds;
+    double encodedFrameBytes;
+    std::chrono::steady_clock::time_point recordingStartTime;
+    
+    // Continuous recording split into fixed-duration segments
+    bool isSegmented;
+    double segmentDuration;
+    std::string segmentPrefix;
+    RecordingSegment currentSegment;
+    std::vector<RecordingSegment> segments;
+    std::vector<ClipManifest> pendingManifests;
+    mutable std::mutex segmentMutex;
+    
+    // Lossless recording into a raw frame container instead of the encoder
+    bool isRawRecording;
+    RawFrameWriter rawWriter;
+    RawFrameWriterStats rawWriterStats;
+    std::deque<OverlayFrame> pendingRawFrames;  // Staged in the writer, not yet on disk
+    size_t rawFramesCommitted;
+    
+    // Per-frame overlay metadata and capture times written next to each video file
+    OverlaySidecar overlaySidecar;
+    FrameTimestampIndex timestampIndex;
+    bool burnInOverlays;
     
-    void AddFrameToBuffer(const cv::Mat& frame, double timestamp);
-    void WriteBufferedFrames();
+    // Low-resolution review proxy encoded alongside the master
+    bool writeProxy;
+    double proxyScale;
+    double thumbnailInterval;
+    cv::VideoWriter proxyWriter;
+    std::string proxyFilename;
+    std::string thumbnailStripFilename;
+    std::unique_ptr<FramePool> proxyPool;
+    std::deque<FrameBuffer> proxyQueue;
+    std::mutex proxyMutex;
+    std::condition_variable proxyCondition;
+    std::thread proxyThread;
+    bool stopProxyThread;
+    std::vector<cv::Mat> thumbnails;
+    double lastThumbnailTime;
+    size_t proxyFramesWritten;
+    size_t proxyFramesDropped;
+    
+    // Shared by capture, analysis and recording
+    std::shared_ptr<FramePool> framePool;
+    
+    void AddFrameToBuffer(const FrameBuffer& bufferFrame);
+    void TrimBuffer(double newestTimestamp);
     void ClearBuffer();
+    void CompressionWorker();
+    void ClipWorker();
+    bool WriteClip(const ClipRequest& request);
+    void StartEncoder();
+    void EnqueueForEncoding(const FrameBuffer& bufferFrame);
+    void WriteFrameRecords(OverlayFrame record, uint32_t frameNumber);
+    void CommitRawFrames();
+    bool OpenSegment(double timestamp);
+    void CloseSegment();
+    bool WriteManifest(const ClipManifest& manifest);
+    bool StartProxyEncoder(const std::string& masterFilename);
+    void StopProxyEncoder();
+    void EnqueueProxyFrame(const cv::Mat& renderedFrame, double timestamp);
+    void ProxyWorker();
+    bool SaveThumbnailStrip();
+    const cv::Mat& RenderFrame(const FrameBuffer& bufferFrame, cv::Mat& scratch);
+    void EncoderWorker();
+    bool ApplyCodecBenchmark();
     
 public:
     VideoRecorder();
     ~VideoRecorder();
     
     bool Initialize(int width = 1280, int height = 720, double fps = 30.0);
+    bool Initialize(const DisplayGeometry& geometry, double fps = 30.0);
     void SetOutputPath(const std::string& path);
     void SetBufferSize(int size);
+    void SetReplayDuration(double seconds);
+    void SetReplayBudget(size_t megabytes);
+    void SetReplayCompression(bool enabled, int jpegQuality = 90);
+    void SetFramePool(std::shared_ptr<FramePool> pool);
+    std::shared_ptr<FramePool> GetFramePool() const;
+    
+    // Review proxy and thumbnail strip
+    void EnableProxy(double scale = 0.25, double thumbnailSeconds = 0.0);
+    void DisableProxy();
+    std::string GetProxyFilename() const;
+    static std::string ProxyFilenameFor(const std::string& masterFilename);
+    static std::string ThumbnailStripFilenameFor(const std::string& masterFilename);
     
     bool StartRecording(const std::string& filename);
+    bool StartSegmentedRecording(const std::string& prefix, double segmentSeconds = 2.0);
+    bool StartRawRecording(const std::string& filename, double preallocateSeconds = 10.0);
+    RawFrameWriterStats GetRawWriterStats() const;
     void StopRecording();
     bool IsRecording() const;
     
     void AddFrame(const cv::Mat& frame, double timestamp);
     void AddFrameWithEnemies(const cv::Mat& frame, double timestamp, const std::vector<cv::Point2f>& enemyPositions);
+    void AddFrameWithOverlay(const cv::Mat& frame, const OverlayFrame& overlay);
+    void SetBurnInOverlays(bool enabled);
     
     void StartBuffering();
     void StopBuffering();
     size_t GetBufferSize() const;
+    ReplayBufferStats GetReplayBufferStats() const;
+    
+    // Retroactive clips from the replay buffer, written on a background thread
+    bool SaveClip(double startTime, double endTime, const std::string& filename);
+    size_t GetPendingClipCount() const;
+    size_t GetSavedClipCount() const;
+    
+    // Clips referencing recorded segments, no re-encoding
+    bool SaveSegmentClip(double startTime, double endTime, const std::string& filename);
+    std::vector<RecordingSegment> GetSegments() const;
+    static std::vector<RecordingSegment> LoadSegmentIndex(const std::string& filename);
+    static bool LoadClipManifest(const std::string& filename, ClipManifest& manifest);
     
     std::string GenerateFilename(const std::string& prefix, double timestamp);
     bool SaveFrameAsImage(const cv::Mat& frame, const std::string& filename);
-    void SetCodec(int codec);
+    void SetCodec(int codec, int api = cv::CAP_ANY, const std::string& extension = ".mp4");
+    std::string GetContainerExtension() const;
+    
+    // Encoder queue and backpressure
+    void SetEncodeQueueCapacity(size_t frames);
+    void SetBackpressurePolicy(BackpressurePolicy policy);
+    BackpressurePolicy GetBackpressurePolicy() const;
+    void SetEncoderThrottle(double milliseconds);   // Added to every encode, to rehearse a slow encoder
+    EncoderStats GetEncoderStats() const;
+    void PrintEncoderStats() const;
     
     void PrintRecordingInfo() const;
     void PrintBufferInfo() const;
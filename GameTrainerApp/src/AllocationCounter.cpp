@@ -0,0 +1,41 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<size_t> allocationCount(0);
+}
+
+bool AllocationCounter::IsEnabled() {
+#ifdef GAME_TRAINER_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+size_t AllocationCounter::Count() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+#ifdef GAME_TRAINER_COUNT_ALLOCATIONS
+
+// The array forms forward to these
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#endif
@@ -0,0 +1,227 @@
+#include "ClipIndex.h"
+#include "RecordFile.h"
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+
+namespace {
+const char kClipIndexMagic[4] = { 'G', 'T', 'C', 'I' };
+const uint32_t kClipIndexVersion = 1;
+const uint8_t kFlagPlayerDied = 0x01;
+const uint8_t kFlagEnemyKilled = 0x02;
+}
+
+ClipIndex::ClipIndex() 
+    : stringTableSize(0), appendedRecords(0) {
+}
+
+ClipIndex::~ClipIndex() {
+    Close();
+}
+
+bool ClipIndex::Open(const std::string& path) {
+    Close();
+    
+    basePath = path;
+    std::string recordFilename = basePath + ".idx";
+    std::string stringFilename = basePath + ".str";
+    
+    std::error_code error;
+    uint64_t recordFileSize = std::filesystem::exists(recordFilename, error) ? std::filesystem::file_size(recordFilename, error) : 0;
+    bool isNewIndex = recordFileSize < sizeof(ClipIndexHeader);
+    
+    if (!isNewIndex) {
+        ClipIndexHeader header;
+        std::ifstream existing(recordFilename, std::ios::binary);
+        existing.read(reinterpret_cast<char*>(&header), sizeof(header));
+        
+        // Appending to a file in another format would corrupt it
+        if (!existing || !RecordReader::MatchesFormat(header, kClipIndexMagic, kClipIndexVersion, sizeof(ClipIndexRecord))) {
+            std::cerr << "[ClipIndex] Unsupported clip index format: " << basePath << std::endl;
+            return false;
+        }
+    }
+    
+    // Drop a torn header or trailing record from an interrupted append, so new
+    // records start on a record boundary
+    uint64_t validSize = RecordReader::CompleteSize(recordFileSize, sizeof(ClipIndexHeader), sizeof(ClipIndexRecord));
+    if (validSize != recordFileSize) {
+        std::filesystem::resize_file(recordFilename, validSize, error);
+        if (error) {
+            std::cerr << "[ClipIndex] Failed to truncate torn record in " << recordFilename << std::endl;
+            return false;
+        }
+        std::cout << "[ClipIndex] Dropped " << (recordFileSize - validSize) << " bytes of torn record from " << recordFilename << std::endl;
+    }
+    
+    recordFile.open(recordFilename, std::ios::binary | std::ios::app);
+    stringFile.open(stringFilename, std::ios::binary | std::ios::app);
+    
+    if (!recordFile.is_open() || !stringFile.is_open()) {
+        std::cerr << "[ClipIndex] Failed to open clip index " << basePath << std::endl;
+        Close();
+        return false;
+    }
+    
+    if (isNewIndex) {
+        ClipIndexHeader header;
+        std::memcpy(header.magic, kClipIndexMagic, sizeof(header.magic));
+        header.version = kClipIndexVersion;
+        header.recordSize = sizeof(ClipIndexRecord);
+        header.reserved = 0;
+        recordFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        recordFile.flush();
+    }
+    
+    stringTableSize = std::filesystem::exists(stringFilename) ? std::filesystem::file_size(stringFilename) : 0;
+    
+    std::cout << "[ClipIndex] Opened clip index " << basePath << std::endl;
+    return true;
+}
+
+void ClipIndex::Close() {
+    if (recordFile.is_open()) {
+        recordFile.close();
+    }
+    if (stringFile.is_open()) {
+        stringFile.close();
+    }
+    stringTableSize = 0;
+}
+
+bool ClipIndex::IsOpen() const {
+    return recordFile.is_open() && stringFile.is_open();
+}
+
+uint32_t ClipIndex::AppendString(const std::string& value) {
+    uint32_t offset = static_cast<uint32_t>(stringTableSize);
+    stringFile.write(value.data(), value.size());
+    stringTableSize += value.size();
+    return offset;
+}
+
+bool ClipIndex::Append(const ClipIndexEntry& entry) {
+    if (!IsOpen()) {
+        std::cerr << "[ClipIndex] Clip index not open" << std::endl;
+        return false;
+    }
+    
+    ClipIndexRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.startTime = entry.startTime;
+    record.endTime = entry.endTime;
+    record.combatIntensity = entry.combatIntensity;
+    record.clipIdOffset = AppendString(entry.clipId);
+    record.clipIdLength = static_cast<uint32_t>(entry.clipId.size());
+    record.reasonOffset = AppendString(entry.triggerReason);
+    record.reasonLength = static_cast<uint32_t>(entry.triggerReason.size());
+    record.filenameOffset = AppendString(entry.filename);
+    record.filenameLength = static_cast<uint32_t>(entry.filename.size());
+    record.enemyCount = static_cast<uint32_t>(entry.enemyCount);
+    record.damageTaken = entry.damageTaken;
+    record.flags = (entry.playerDied ? kFlagPlayerDied : 0) | (entry.enemyKilled ? kFlagEnemyKilled : 0);
+    
+    // Strings land first so a record never references bytes that were not written
+    stringFile.flush();
+    recordFile.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    recordFile.flush();
+    
+    if (!recordFile.good() || !stringFile.good()) {
+        std::cerr << "[ClipIndex] Failed to append clip " << entry.clipId << std::endl;
+        return false;
+    }
+    
+    appendedRecords++;
+    return true;
+}
+
+bool ClipIndex::Load(const std::string& path, std::vector<ClipIndexEntry>& entries) {
+    MappedFile records;
+    MappedFile strings;
+    
+    if (!records.Open(path + ".idx") || !strings.Open(path + ".str")) {
+        return false;
+    }
+    
+    if (records.Size() < sizeof(ClipIndexHeader)) {
+        return false;
+    }
+    
+    RecordReader reader(records);
+    ClipIndexHeader header;
+    if (!reader.ReadHeader(header, kClipIndexMagic, kClipIndexVersion, sizeof(ClipIndexRecord))) {
+        std::cerr << "[ClipIndex] Unsupported clip index format: " << path << std::endl;
+        return false;
+    }
+    
+    const char* stringData = reinterpret_cast<const char*>(strings.Data());
+    size_t stringSize = strings.Size();
+    
+    auto readString = [stringData, stringSize](uint32_t offset, uint32_t length) {
+        if (static_cast<size_t>(offset) + length > stringSize) {
+            return std::string();
+        }
+        return std::string(stringData + offset, length);
+    };
+    
+    entries.reserve(entries.size() + reader.Remaining() / sizeof(ClipIndexRecord));
+    
+    ClipIndexRecord record;
+    while (reader.Read(record)) {
+        ClipIndexEntry entry;
+        entry.clipId = readString(record.clipIdOffset, record.clipIdLength);
+        entry.triggerReason = readString(record.reasonOffset, record.reasonLength);
+        entry.filename = readString(record.filenameOffset, record.filenameLength);
+        entry.startTime = record.startTime;
+        entry.endTime = record.endTime;
+        entry.combatIntensity = record.combatIntensity;
+        entry.enemyCount = static_cast<int>(record.enemyCount);
+        entry.damageTaken = record.damageTaken;
+        entry.playerDied = (record.flags & kFlagPlayerDied) != 0;
+        entry.enemyKilled = (record.flags & kFlagEnemyKilled) != 0;
+        entries.push_back(std::move(entry));
+    }
+    
+    return true;
+}
+
+bool ClipIndex::ExportCsv(const std::string& path, const std::string& csvFilename) {
+    std::vector<ClipIndexEntry> entries;
+    if (!Load(path, entries)) {
+        std::cerr << "[ClipIndex] Failed to load clip index " << path << std::endl;
+        return false;
+    }
+    
+    std::ofstream file(csvFilename);
+    if (!file.is_open()) {
+        std::cerr << "[ClipIndex] Failed to export clip index to " << csvFilename << std::endl;
+        return false;
+    }
+    
+    file << "clip_id,start_time,end_time,duration,trigger_reason,combat_intensity,player_died,enemy_killed,enemy_count,damage_taken,filename\n";
+    for (const auto& entry : entries) {
+        file << entry.clipId << ","
+             << entry.startTime << ","
+             << entry.endTime << ","
+             << (entry.endTime - entry.startTime) << ","
+             << entry.triggerReason << ","
+             << entry.combatIntensity << ","
+             << (entry.playerDied ? "true" : "false") << ","
+             << (entry.enemyKilled ? "true" : "false") << ","
+             << entry.enemyCount << ","
+             << entry.damageTaken << ","
+             << entry.filename << "\n";
+    }
+    
+    file.close();
+    std::cout << "[ClipIndex] Exported " << entries.size() << " clips to " << csvFilename << std::endl;
+    return true;
+}
+
+std::string ClipIndex::GetBasePath() const {
+    return basePath;
+}
+
+size_t ClipIndex::GetAppendedCount() const {
+    return appendedRecords;
+}
@@ -0,0 +1,241 @@
+#include "ClipIndexBenchmark.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+namespace {
+const char* const kTriggerReasons[] = { "enemy_detected", "player_died", "combat_started" };
+
+// The CSV wrote doubles at the stream's default six significant digits
+bool NearlyEqual(double a, double b) {
+    return std::abs(a - b) <= 1e-5 * std::max(1.0, std::abs(a));
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The format CombatAnalyzer::SaveCombatMetadata wrote before the clip index
+void WriteMetadataCsv(const std::string& filename, const ClipIndexEntry& entry) {
+    std::ofstream file(filename);
+    file << "clip_id,start_time,end_time,duration,trigger_reason,combat_intensity,player_died,enemy_killed,enemy_count,damage_taken,filename\n";
+    file << entry.clipId << ","
+         << entry.startTime << ","
+         << entry.endTime << ","
+         << (entry.endTime - entry.startTime) << ","
+         << entry.triggerReason << ","
+         << entry.combatIntensity << ","
+         << (entry.playerDied ? "true" : "false") << ","
+         << (entry.enemyKilled ? "true" : "false") << ","
+         << entry.enemyCount << ","
+         << entry.damageTaken << ","
+         << entry.filename << "\n";
+}
+
+bool ReadMetadataCsv(const std::string& filename, ClipIndexEntry& entry) {
+    std::ifstream file(filename);
+    std::string line;
+    if (!std::getline(file, line) || !std::getline(file, line)) {
+        return false;
+    }
+    
+    std::vector<std::string> fields;
+    std::istringstream iss(line);
+    std::string field;
+    while (std::getline(iss, field, ',')) {
+        fields.push_back(field);
+    }
+    if (fields.size() != 11) {
+        return false;
+    }
+    
+    entry.clipId = fields[0];
+    entry.startTime = std::stod(fields[1]);
+    entry.endTime = std::stod(fields[2]);
+    entry.triggerReason = fields[4];
+    entry.combatIntensity = std::stod(fields[5]);
+    entry.playerDied = fields[6] == "true";
+    entry.enemyKilled = fields[7] == "true";
+    entry.enemyCount = std::stoi(fields[8]);
+    entry.damageTaken = std::stoi(fields[9]);
+    entry.filename = fields[10];
+    return true;
+}
+}
+
+ClipIndexBenchmark::ClipIndexBenchmark() 
+    : clipCount(10000), workDirectory("./recordings/clip_index_benchmark/") {
+}
+
+ClipIndexBenchmark::~ClipIndexBenchmark() {
+}
+
+void ClipIndexBenchmark::SetClipCount(int count) {
+    clipCount = std::max(1, count);
+    std::cout << "[ClipIndexBenchmark] Clip count set to " << clipCount << std::endl;
+}
+
+void ClipIndexBenchmark::SetWorkDirectory(const std::string& path) {
+    workDirectory = path;
+    if (!workDirectory.empty() && workDirectory.back() != '/') {
+        workDirectory += "/";
+    }
+    std::cout << "[ClipIndexBenchmark] Work directory set to " << workDirectory << std::endl;
+}
+
+std::vector<ClipIndexEntry> ClipIndexBenchmark::GenerateEntries() const {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> intensity(0.0, 1.0);
+    std::uniform_real_distribution<double> duration(5.0, 20.0);
+    std::uniform_int_distribution<int> enemies(1, 5);
+    std::uniform_int_distribution<int> damage(0, 100);
+    
+    std::vector<ClipIndexEntry> entries;
+    entries.reserve(clipCount);
+    
+    double time = 0.0;
+    for (int i = 0; i < clipCount; ++i) {
+        ClipIndexEntry entry;
+        time += duration(rng);
+        entry.clipId = "combat_20240115_143025_" + std::to_string(i);
+        entry.triggerReason = kTriggerReasons[i % 3];
+        entry.filename = entry.clipId + ".mp4";
+        entry.startTime = time;
+        entry.endTime = time + 10.0;
+        entry.combatIntensity = intensity(rng);
+        entry.enemyCount = enemies(rng);
+        entry.damageTaken = damage(rng);
+        entry.playerDied = i % 7 == 0;
+        entry.enemyKilled = i % 3 == 0;
+        entries.push_back(entry);
+    }
+    
+    return entries;
+}
+
+bool ClipIndexBenchmark::SameEntries(const std::vector<ClipIndexEntry>& expected, std::vector<ClipIndexEntry> loaded) {
+    if (loaded.size() != expected.size()) {
+        return false;
+    }
+    
+    // Directory listings come back in no particular order
+    std::sort(loaded.begin(), loaded.end(), [](const ClipIndexEntry& a, const ClipIndexEntry& b) { return a.startTime < b.startTime; });
+    
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const ClipIndexEntry& a = expected[i];
+        const ClipIndexEntry& b = loaded[i];
+        if (a.clipId != b.clipId || a.triggerReason != b.triggerReason || a.filename != b.filename ||
+            !NearlyEqual(a.startTime, b.startTime) || !NearlyEqual(a.endTime, b.endTime) ||
+            !NearlyEqual(a.combatIntensity, b.combatIntensity) ||
+            a.enemyCount != b.enemyCount || a.damageTaken != b.damageTaken ||
+            a.playerDied != b.playerDied || a.enemyKilled != b.enemyKilled) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ClipIndexBenchmarkResult ClipIndexBenchmark::RunPerFile(const std::vector<ClipIndexEntry>& entries) const {
+    ClipIndexBenchmarkResult result = ClipIndexBenchmarkResult();
+    result.storage = "per-clip CSV";
+    result.clipCount = static_cast<int>(entries.size());
+    
+    std::string directory = workDirectory + "per_clip/";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::create_directories(directory, error);
+    
+    auto writeStart = std::chrono::steady_clock::now();
+    for (const auto& entry : entries) {
+        WriteMetadataCsv(directory + entry.clipId + "_metadata.csv", entry);
+    }
+    result.writeMs = ElapsedMs(writeStart);
+    
+    std::vector<ClipIndexEntry> loaded;
+    auto loadStart = std::chrono::steady_clock::now();
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        ClipIndexEntry entry;
+        if (ReadMetadataCsv(file.path().string(), entry)) {
+            loaded.push_back(entry);
+        }
+    }
+    result.loadMs = ElapsedMs(loadStart);
+    
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        result.files++;
+        result.bytes += static_cast<size_t>(file.file_size(error));
+    }
+    
+    result.complete = SameEntries(entries, loaded);
+    std::filesystem::remove_all(directory, error);
+    return result;
+}
+
+ClipIndexBenchmarkResult ClipIndexBenchmark::RunIndex(const std::vector<ClipIndexEntry>& entries) const {
+    ClipIndexBenchmarkResult result = ClipIndexBenchmarkResult();
+    result.storage = "clip index";
+    result.clipCount = static_cast<int>(entries.size());
+    
+    std::string basePath = workDirectory + "session_clips";
+    std::error_code error;
+    std::filesystem::create_directories(workDirectory, error);
+    std::filesystem::remove(basePath + ".idx", error);
+    std::filesystem::remove(basePath + ".str", error);
+    
+    auto writeStart = std::chrono::steady_clock::now();
+    {
+        ClipIndex index;
+        if (!index.Open(basePath)) {
+            return result;
+        }
+        for (const auto& entry : entries) {
+            index.Append(entry);
+        }
+    }
+    result.writeMs = ElapsedMs(writeStart);
+    
+    std::vector<ClipIndexEntry> loaded;
+    auto loadStart = std::chrono::steady_clock::now();
+    ClipIndex::Load(basePath, loaded);
+    result.loadMs = ElapsedMs(loadStart);
+    
+    result.files = 2;
+    result.bytes = static_cast<size_t>(std::filesystem::file_size(basePath + ".idx", error) +
+                                       std::filesystem::file_size(basePath + ".str", error));
+    result.complete = SameEntries(entries, loaded);
+    
+    std::filesystem::remove(basePath + ".idx", error);
+    std::filesystem::remove(basePath + ".str", error);
+    return result;
+}
+
+std::vector<ClipIndexBenchmarkResult> ClipIndexBenchmark::Run() const {
+    std::vector<ClipIndexEntry> entries = GenerateEntries();
+    std::cout << "[ClipIndexBenchmark] Writing and loading " << entries.size() << " clips" << std::endl;
+    
+    std::vector<ClipIndexBenchmarkResult> results;
+    results.push_back(RunPerFile(entries));
+    results.push_back(RunIndex(entries));
+    return results;
+}
+
+void ClipIndexBenchmark::PrintResults(const std::vector<ClipIndexBenchmarkResult>& results) {
+    std::cout << "\n=== CLIP INDEX BENCHMARK ===" << std::endl;
+    std::cout << std::left << std::setw(14) << "Storage" << std::setw(8) << "Clips"
+              << std::right << std::setw(8) << "Files" << std::setw(12) << "KB" << std::setw(12) << "Write ms"
+              << std::setw(12) << "Load ms" << "  Complete" << std::endl;
+    
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(14) << result.storage << std::setw(8) << result.clipCount
+                  << std::right << std::setw(8) << result.files << std::fixed << std::setprecision(1)
+                  << std::setw(12) << (result.bytes / 1024.0) << std::setw(12) << result.writeMs
+                  << std::setw(12) << result.loadMs << "  " << (result.complete ? "YES" : "NO") << std::endl;
+    }
+    std::cout << std::endl;
+}
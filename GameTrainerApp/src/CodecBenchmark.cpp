@@ -0,0 +1,368 @@
+#include "CodecBenchmark.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const double kRealtimeHeadroom = 1.25;     // Encoder must beat the capture rate by this factor
+const double kMinimumPsnr = 30.0;
+}
+
+CodecBenchmark::CodecBenchmark() 
+    : targetFps(60.0), framesPerRun(120), workDirectory("./recordings/benchmark/") {
+    codecs = {
+        { "MJPG", cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), ".avi" },
+        { "XVID", cv::VideoWriter::fourcc('X', 'V', 'I', 'D'), ".avi" },
+        { "MP4V", cv::VideoWriter::fourcc('M', 'P', '4', 'V'), ".mp4" },
+        { "avc1", cv::VideoWriter::fourcc('a', 'v', 'c', '1'), ".mp4" },
+        { "hvc1", cv::VideoWriter::fourcc('h', 'v', 'c', '1'), ".mp4" },
+        { "VP80", cv::VideoWriter::fourcc('V', 'P', '8', '0'), ".webm" }
+    };
+    resolutions = { cv::Size(1280, 720), cv::Size(1920, 1080), cv::Size(2560, 1440) };
+}
+
+CodecBenchmark::~CodecBenchmark() {
+}
+
+void CodecBenchmark::SetResolutions(const std::vector<cv::Size>& sizes) {
+    resolutions = sizes;
+}
+
+void CodecBenchmark::SetCodecs(const std::vector<CodecCandidate>& candidates) {
+    codecs = candidates;
+}
+
+void CodecBenchmark::SetTargetFps(double fps) {
+    targetFps = std::max(1.0, fps);
+    std::cout << "[CodecBenchmark] Target FPS set to " << targetFps << std::endl;
+}
+
+void CodecBenchmark::SetFramesPerRun(int frames) {
+    framesPerRun = std::max(10, frames);
+    std::cout << "[CodecBenchmark] Frames per run set to " << framesPerRun << std::endl;
+}
+
+void CodecBenchmark::SetWorkDirectory(const std::string& path) {
+    workDirectory = path;
+    if (!workDirectory.empty() && workDirectory.back() != '/') {
+        workDirectory += "/";
+    }
+}
+
+bool CodecBenchmark::LoadRecordedFrames(const std::string& videoPath, int maxFrames) {
+    cv::VideoCapture capture(videoPath);
+    if (!capture.isOpened()) {
+        std::cerr << "[CodecBenchmark] Failed to open video: " << videoPath << std::endl;
+        return false;
+    }
+    
+    recordedFrames.clear();
+    cv::Mat frame;
+    while (static_cast<int>(recordedFrames.size()) < maxFrames && capture.read(frame)) {
+        recordedFrames.push_back(frame.clone());
+    }
+    
+    std::cout << "[CodecBenchmark] Loaded " << recordedFrames.size() << " recorded frames from " << videoPath << std::endl;
+    return !recordedFrames.empty();
+}
+
+std::vector<cv::Mat> CodecBenchmark::GenerateSyntheticFrames(cv::Size resolution) const {
+    // Moving shapes over a scrolling gradient with sensor-like noise, so the
+    // encoder sees both motion and detail like real gameplay
+    std::vector<cv::Mat> frames;
+    frames.reserve(framesPerRun);
+    
+    cv::Mat gradient(resolution, CV_8UC3);
+    for (int y = 0; y < resolution.height; y++) {
+        for (int x = 0; x < resolution.width; x++) {
+            gradient.at<cv::Vec3b>(y, x) = cv::Vec3b(static_cast<uchar>(x * 255 / resolution.width),
+                                                     static_cast<uchar>(y * 255 / resolution.height), 96);
+        }
+    }
+    
+    cv::Mat noise(resolution, CV_8UC3);
+    cv::RNG rng(42);
+    
+    for (int i = 0; i < framesPerRun; i++) {
+        cv::Mat frame;
+        int shift = (i * 4) % resolution.width;
+        if (shift == 0) {
+            frame = gradient.clone();
+        } else {
+            cv::hconcat(std::vector<cv::Mat>{ gradient.colRange(shift, resolution.width), gradient.colRange(0, shift) }, frame);
+        }
+        
+        for (int s = 0; s < 6; s++) {
+            cv::Point center((s * 211 + i * (s + 3) * 5) % resolution.width,
+                             (s * 137 + i * (s + 2) * 3) % resolution.height);
+            cv::circle(frame, center, resolution.height / 20 + s * 4, cv::Scalar(40 * s, 255 - 30 * s, 60), -1);
+        }
+        
+        rng.fill(noise, cv::RNG::NORMAL, 0, 6);
+        cv::add(frame, noise, frame);
+        frames.push_back(frame);
+    }
+    
+    return frames;
+}
+
+std::vector<cv::Mat> CodecBenchmark::ScaleRecordedFrames(cv::Size resolution) const {
+    std::vector<cv::Mat> frames;
+    frames.reserve(std::min<size_t>(recordedFrames.size(), framesPerRun));
+    
+    for (size_t i = 0; i < recordedFrames.size() && static_cast<int>(i) < framesPerRun; i++) {
+        cv::Mat scaled;
+        cv::resize(recordedFrames[i], scaled, resolution, 0, 0, cv::INTER_AREA);
+        frames.push_back(scaled);
+    }
+    
+    return frames;
+}
+
+CodecBenchmarkResult CodecBenchmark::RunOne(const std::vector<cv::Mat>& frames, int backendApi,
+                                            const CodecCandidate& candidate, cv::Size resolution) const {
+    CodecBenchmarkResult result = CodecBenchmarkResult();
+    result.backend = cv::videoio_registry::getBackendName(static_cast<cv::VideoCaptureAPIs>(backendApi));
+    result.backendApi = backendApi;
+    result.codec = candidate.name;
+    result.fourcc = candidate.fourcc;
+    result.extension = candidate.extension;
+    result.resolution = resolution;
+    result.targetFps = targetFps;
+    result.supported = false;
+    
+    std::string filename = workDirectory + result.backend + "_" + candidate.name + "_" +
+                           std::to_string(resolution.width) + "x" + std::to_string(resolution.height) + candidate.extension;
+    
+    cv::VideoWriter writer;
+    if (!writer.open(filename, backendApi, candidate.fourcc, targetFps, resolution)) {
+        return result;
+    }
+    
+    std::clock_t cpuStart = std::clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    
+    for (const auto& frame : frames) {
+        writer.write(frame);
+    }
+    writer.release();
+    
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    result.cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    
+    std::error_code error;
+    uintmax_t bytes = std::filesystem::file_size(filename, error);
+    if (error || bytes == 0) {
+        return result;
+    }
+    
+    result.supported = true;
+    result.framesEncoded = static_cast<int>(frames.size());
+    result.encodeFps = wallSeconds > 0.0 ? frames.size() / wallSeconds : 0.0;
+    result.bitrateMbps = bytes * 8.0 / (frames.size() / targetFps) / 1e6;
+    result.psnr = MeasurePsnr(filename, frames);
+    result.keepsUp = result.encodeFps >= targetFps * kRealtimeHeadroom;
+    
+    std::filesystem::remove(filename, error);
+    return result;
+}
+
+double CodecBenchmark::MeasurePsnr(const std::string& filename, const std::vector<cv::Mat>& frames) const {
+    cv::VideoCapture capture(filename);
+    if (!capture.isOpened()) {
+        return 0.0;
+    }
+    
+    double total = 0.0;
+    int compared = 0;
+    cv::Mat decoded;
+    
+    for (const auto& frame : frames) {
+        if (!capture.read(decoded)) {
+            break;
+        }
+        if (decoded.size() != frame.size() || decoded.type() != frame.type()) {
+            continue;
+        }
+        
+        // Identical frames report infinity, cap so averages stay meaningful
+        total += std::min(99.0, cv::PSNR(frame, decoded));
+        compared++;
+    }
+    
+    return compared > 0 ? total / compared : 0.0;
+}
+
+std::vector<CodecBenchmarkResult> CodecBenchmark::Run() {
+    std::vector<CodecBenchmarkResult> results;
+    std::filesystem::create_directories(workDirectory);
+    
+    std::vector<cv::VideoCaptureAPIs> backends = cv::videoio_registry::getWriterBackends();
+    std::cout << "[CodecBenchmark] " << backends.size() << " writer backends, " << codecs.size() << " codecs, "
+              << resolutions.size() << " resolutions, " << framesPerRun << " frames per run" << std::endl;
+    
+    for (const auto& resolution : resolutions) {
+        std::vector<cv::Mat> frames = recordedFrames.empty()
+            ? GenerateSyntheticFrames(resolution)
+            : ScaleRecordedFrames(resolution);
+        
+        for (auto backend : backends) {
+            for (const auto& candidate : codecs) {
+                CodecBenchmarkResult result = RunOne(frames, static_cast<int>(backend), candidate, resolution);
+                if (result.supported) {
+                    std::cout << "[CodecBenchmark] " << result.backend << "/" << result.codec << " "
+                              << resolution.width << "x" << resolution.height << ": "
+                              << std::fixed << std::setprecision(1) << result.encodeFps << " fps, "
+                              << result.bitrateMbps << " Mbps, " << result.psnr << " dB" << std::endl;
+                }
+                results.push_back(result);
+            }
+        }
+    }
+    
+    return results;
+}
+
+bool CodecBenchmark::SaveResults(const std::string& filename, const std::vector<CodecBenchmarkResult>& results) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "[CodecBenchmark] Failed to save results to " << filename << std::endl;
+        return false;
+    }
+    
+    file << "backend,backend_api,codec,fourcc,extension,width,height,target_fps,supported,frames,encode_fps,cpu_seconds,bitrate_mbps,psnr,keeps_up\n";
+    for (const auto& result : results) {
+        file << result.backend << ","
+             << result.backendApi << ","
+             << result.codec << ","
+             << result.fourcc << ","
+             << result.extension << ","
+             << result.resolution.width << ","
+             << result.resolution.height << ","
+             << result.targetFps << ","
+             << (result.supported ? "true" : "false") << ","
+             << result.framesEncoded << ","
+             << result.encodeFps << ","
+             << result.cpuSeconds << ","
+             << result.bitrateMbps << ","
+             << result.psnr << ","
+             << (result.keepsUp ? "true" : "false") << "\n";
+    }
+    
+    file.close();
+    std::cout << "[CodecBenchmark] Saved " << results.size() << " results to " << filename << std::endl;
+    return true;
+}
+
+bool CodecBenchmark::LoadResults(const std::string& filename, std::vector<CodecBenchmarkResult>& results) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    std::getline(file, line); // Skip header
+    
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string token;
+        CodecBenchmarkResult result;
+        
+        std::getline(ss, result.backend, ',');
+        std::getline(ss, token, ',');
+        result.backendApi = std::stoi(token);
+        std::getline(ss, result.codec, ',');
+        std::getline(ss, token, ',');
+        result.fourcc = std::stoi(token);
+        std::getline(ss, result.extension, ',');
+        std::getline(ss, token, ',');
+        result.resolution.width = std::stoi(token);
+        std::getline(ss, token, ',');
+        result.resolution.height = std::stoi(token);
+        std::getline(ss, token, ',');
+        result.targetFps = std::stod(token);
+        std::getline(ss, token, ',');
+        result.supported = (token == "true");
+        std::getline(ss, token, ',');
+        result.framesEncoded = std::stoi(token);
+        std::getline(ss, token, ',');
+        result.encodeFps = std::stod(token);
+        std::getline(ss, token, ',');
+        result.cpuSeconds = std::stod(token);
+        std::getline(ss, token, ',');
+        result.bitrateMbps = std::stod(token);
+        std::getline(ss, token, ',');
+        result.psnr = std::stod(token);
+        std::getline(ss, token, ',');
+        result.keepsUp = (token == "true");
+        
+        results.push_back(result);
+    }
+    
+    return !results.empty();
+}
+
+bool CodecBenchmark::Recommend(const std::vector<CodecBenchmarkResult>& results, cv::Size resolution, double fps,
+                               CodecBenchmarkResult& recommendation) {
+    // Judge against the benchmarked resolution closest in pixel count
+    long long targetPixels = static_cast<long long>(resolution.width) * resolution.height;
+    long long closestPixels = -1;
+    for (const auto& result : results) {
+        if (!result.supported) continue;
+        long long pixels = static_cast<long long>(result.resolution.width) * result.resolution.height;
+        if (closestPixels < 0 || std::llabs(pixels - targetPixels) < std::llabs(closestPixels - targetPixels)) {
+            closestPixels = pixels;
+        }
+    }
+    
+    if (closestPixels < 0) {
+        return false;
+    }
+    
+    // Among codecs that keep up with headroom and look acceptable, the smallest
+    // output wins. If none keep up, the fastest encoder is the least bad choice.
+    const CodecBenchmarkResult* best = nullptr;
+    const CodecBenchmarkResult* fastest = nullptr;
+    
+    for (const auto& result : results) {
+        if (!result.supported) continue;
+        if (static_cast<long long>(result.resolution.width) * result.resolution.height != closestPixels) continue;
+        
+        if (!fastest || result.encodeFps > fastest->encodeFps) {
+            fastest = &result;
+        }
+        
+        bool keepsUp = result.encodeFps >= fps * kRealtimeHeadroom;
+        if (keepsUp && result.psnr >= kMinimumPsnr && (!best || result.bitrateMbps < best->bitrateMbps)) {
+            best = &result;
+        }
+    }
+    
+    recommendation = best ? *best : *fastest;
+    return true;
+}
+
+void CodecBenchmark::PrintResults(const std::vector<CodecBenchmarkResult>& results) {
+    std::cout << "\n=== CODEC BENCHMARK ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "Backend" << std::setw(8) << "Codec" << std::setw(12) << "Resolution"
+              << std::right << std::setw(10) << "Enc FPS" << std::setw(10) << "CPU s" << std::setw(10) << "Mbps"
+              << std::setw(10) << "PSNR" << "  Realtime" << std::endl;
+    
+    for (const auto& result : results) {
+        if (!result.supported) continue;
+        
+        std::string resolution = std::to_string(result.resolution.width) + "x" + std::to_string(result.resolution.height);
+        std::cout << std::left << std::setw(12) << result.backend << std::setw(8) << result.codec << std::setw(12) << resolution
+                  << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << result.encodeFps << std::setw(10) << result.cpuSeconds
+                  << std::setw(10) << result.bitrateMbps << std::setw(10) << result.psnr
+                  << "  " << (result.keepsUp ? "YES" : "NO") << std::endl;
+    }
+    std::cout << std::endl;
+}
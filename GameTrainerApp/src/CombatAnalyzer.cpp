@@ -1,20 +1,32 @@
 #include "CombatAnalyzer.h"
+#include "DetectionCache.h"
+#include "VideoRecorder.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
 #include <sstream>
 #include <iomanip>
 
+namespace {
+const char* const kGaugeRegionsFile = "hud_gauges.csv";
+}
+
 CombatAnalyzer::CombatAnalyzer() 
-    : isRecording(false), combatThreshold(0.5), clipDuration(10.0),
-      enemyDetectionCooldown(0.1), combatTimeout(3.0), minEnemiesForCombat(1) {
+    : isRecording(false), combatThreshold(0.5), clipDuration(10.0), clipPreRoll(5.0), clipPostRoll(2.0), videoRecorder(nullptr),
+      enemyDetectionCooldown(0.1), combatTimeout(3.0), minEnemiesForCombat(1),
+      proximityRadius(500.0 / DisplayGeometry::kReferenceHeight),
+      isPipelined(false), maxFramesInFlight(4) {
     ResetCombatState();
 }
 
 CombatAnalyzer::~CombatAnalyzer() {
+    if (isPipelined) {
+        DisablePipelining();
+    }
     if (isRecording) {
         std::cout << "[CombatAnalyzer] Stopping active recording on destruction" << std::endl;
     }
+    EndSession();
 }
 
 bool CombatAnalyzer::Initialize() {
@@ -25,6 +37,12 @@ bool CombatAnalyzer::Initialize() {
         return false;
     }
     
+    hudEventDetector.LoadDefaultRegions();
+    if (!hudGaugeReader.LoadRegions(kGaugeRegionsFile)) {
+        std::cout << "[CombatAnalyzer] No HUD gauge regions configured in " << kGaugeRegionsFile
+                  << ", health and ammo are not read" << std::endl;
+    }
+    
     ResetCombatState();
     std::cout << "[CombatAnalyzer] Combat analysis system initialized successfully" << std::endl;
     return true;
@@ -40,12 +58,68 @@ void CombatAnalyzer::SetClipDuration(double duration) {
     std::cout << "[CombatAnalyzer] Clip duration set to " << clipDuration << " seconds" << std::endl;
 }
 
+void CombatAnalyzer::SetDisplayGeometry(const DisplayGeometry& geometry) {
+    displayGeometry = geometry;
+    enemyDetector.SetDisplayGeometry(geometry);
+    detectionPipeline.SetDisplayGeometry(geometry);
+    positionTracker.SetDisplayGeometry(geometry);
+    std::cout << "[CombatAnalyzer] Display geometry set to " << geometry.width << "x" << geometry.height
+              << " (FOV " << geometry.horizontalFov << ")" << std::endl;
+}
+
+DisplayGeometry CombatAnalyzer::GetDisplayGeometry() const {
+    return displayGeometry;
+}
+
+void CombatAnalyzer::SetVideoRecorder(VideoRecorder* recorder) {
+    videoRecorder = recorder;
+    if (recorder && recorder->GetFramePool()) {
+        SetFramePool(recorder->GetFramePool());
+    }
+    std::cout << "[CombatAnalyzer] Clips " << (recorder ? "are saved from the replay buffer" : "are not saved") << std::endl;
+}
+
+void CombatAnalyzer::SetFramePool(std::shared_ptr<FramePool> pool) {
+    // Frames acquired from the pool reach the detection workers without a copy
+    detectionPipeline.SetFramePool(pool);
+}
+
+void CombatAnalyzer::SetClipPreRoll(double seconds) {
+    clipPreRoll = std::max(0.0, seconds);
+    std::cout << "[CombatAnalyzer] Clip pre-roll set to " << clipPreRoll << " seconds" << std::endl;
+}
+
+void CombatAnalyzer::SetClipPostRoll(double seconds) {
+    clipPostRoll = std::max(0.0, seconds);
+    std::cout << "[CombatAnalyzer] Clip post-roll set to " << clipPostRoll << " seconds" << std::endl;
+}
+
 CombatState CombatAnalyzer::AnalyzeFrame(const cv::Mat& frame, double timestamp) {
     if (frame.empty()) {
         return currentCombatState;
     }
     
     std::vector<EnemyDetection> enemies = enemyDetector.DetectEnemies(frame);
+    return ApplyFrameResult(frame, enemies, timestamp);
+}
+
+CombatState CombatAnalyzer::AnalyzeDetections(const cv::Mat& frame, const std::vector<EnemyDetection>& enemies, double timestamp) {
+    if (frame.empty()) {
+        return currentCombatState;
+    }
+    
+    return ApplyFrameResult(frame, enemies, timestamp);
+}
+
+CombatState CombatAnalyzer::ApplyFrameResult(const cv::Mat& frame, const std::vector<EnemyDetection>& enemies, double timestamp) {
+    if (!displayGeometry.Matches(frame)) {
+        displayGeometry = displayGeometry.WithResolution(frame.cols, frame.rows);
+        positionTracker.SetDisplayGeometry(displayGeometry);
+    }
+    
+    hudEventDetector.ProcessFrame(frame, timestamp);
+    hudGaugeReader.ProcessFrame(frame, timestamp);
+    positionTracker.UpdateEnemyPositions(enemies, timestamp);
     
     if (!enemies.empty()) {
         currentCombatState.lastEnemySeen = timestamp;
@@ -75,9 +149,90 @@ CombatState CombatAnalyzer::AnalyzeFrame(const cv::Mat& frame, double timestamp)
         }
     }
     
+    if (stateCallback) {
+        stateCallback(currentCombatState, timestamp);
+    }
+    
     return currentCombatState;
 }
 
+bool CombatAnalyzer::EnablePipelining(int workerCount, int maxInFlight) {
+    if (isPipelined) {
+        DisablePipelining();
+    }
+    
+    maxFramesInFlight = std::max(1, maxInFlight);
+    
+    if (!detectionPipeline.Start(workerCount)) {
+        std::cerr << "[CombatAnalyzer] Failed to start detection pipeline" << std::endl;
+        return false;
+    }
+    
+    isPipelined = true;
+    std::cout << "[CombatAnalyzer] Pipelined analysis enabled (" << workerCount << " workers, "
+              << maxFramesInFlight << " frames in flight)" << std::endl;
+    return true;
+}
+
+void CombatAnalyzer::DisablePipelining() {
+    if (!isPipelined) {
+        return;
+    }
+    
+    FlushPipeline();
+    detectionPipeline.Stop();
+    isPipelined = false;
+    std::cout << "[CombatAnalyzer] Pipelined analysis disabled" << std::endl;
+}
+
+bool CombatAnalyzer::IsPipelined() const {
+    return isPipelined;
+}
+
+CombatState CombatAnalyzer::SubmitFrame(const cv::Mat& frame, double timestamp) {
+    if (!isPipelined) {
+        return AnalyzeFrame(frame, timestamp);
+    }
+    
+    if (frame.empty()) {
+        return currentCombatState;
+    }
+    
+    DetectionResult result;
+    
+    // Bound latency: once the window is full, wait for the oldest frame before admitting a new one
+    while (detectionPipeline.GetInFlightCount() >= static_cast<size_t>(maxFramesInFlight)) {
+        if (!detectionPipeline.WaitForResult(result)) {
+            break;
+        }
+        ApplyFrameResult(result.frame, result.enemies, result.timestamp);
+    }
+    
+    detectionPipeline.Submit(frame, timestamp);
+    
+    while (detectionPipeline.TryPopResult(result)) {
+        ApplyFrameResult(result.frame, result.enemies, result.timestamp);
+    }
+    
+    return currentCombatState;
+}
+
+CombatState CombatAnalyzer::FlushPipeline() {
+    DetectionResult result;
+    while (detectionPipeline.WaitForResult(result)) {
+        ApplyFrameResult(result.frame, result.enemies, result.timestamp);
+    }
+    return currentCombatState;
+}
+
+void CombatAnalyzer::SetStateCallback(CombatStateCallback callback) {
+    stateCallback = std::move(callback);
+}
+
+PipelineStats CombatAnalyzer::GetPipelineStats() const {
+    return detectionPipeline.GetStats();
+}
+
 bool CombatAnalyzer::ShouldStartRecording(const CombatState& state) {
     return state.isActive && !isRecording && state.combatIntensity >= combatThreshold;
 }
@@ -96,14 +251,15 @@ bool CombatAnalyzer::ShouldStopRecording(const CombatState& state) {
 CombatClip CombatAnalyzer::StartRecording(const std::string& reason, double timestamp) {
     CombatClip clip;
     clip.clipId = GenerateClipId(timestamp);
-    clip.startTime = timestamp;
+    clip.startTime = timestamp - clipPreRoll;
     clip.endTime = timestamp + clipDuration;
     clip.triggerReason = reason;
     clip.enemies = currentCombatState.activeEnemies;
     clip.playerDied = false;
     clip.enemyKilled = false;
+    clip.damageTaken = 0;
     clip.combatIntensity = currentCombatState.combatIntensity;
-    clip.filename = clip.clipId + ".mp4";
+    clip.filename = clip.clipId + (videoRecorder ? videoRecorder->GetContainerExtension() : ".mp4");
     
     isRecording = true;
     
@@ -115,12 +271,24 @@ CombatClip CombatAnalyzer::StartRecording(const std::string& reason, double time
 }
 
 void CombatAnalyzer::StopRecording(CombatClip& clip, double timestamp) {
-    clip.endTime = timestamp;
+    clip.endTime = timestamp + clipPostRoll;
     clip.enemies = currentCombatState.activeEnemies;
     clip.combatIntensity = currentCombatState.combatIntensity;
     
-    clip.playerDied = DetectPlayerDeath(cv::Mat());
-    clip.enemyKilled = DetectEnemyKill(cv::Mat());
+    clip.playerDied = hudEventDetector.HasDeathInRange(clip.startTime, timestamp) ||
+                      hudGaugeReader.HealthDepletedInRange(clip.startTime, timestamp);
+    clip.enemyKilled = hudEventDetector.HasEventInRange(HudEventType::ENEMY_KILLED, clip.startTime, timestamp);
+    clip.damageTaken = hudGaugeReader.GetDamageTakenInRange(clip.startTime, timestamp);
+    
+    // Nearby enemies are measured from the crosshair, where the player was looking
+    if (clip.playerDied) {
+        positionTracker.AnalyzeDeath(displayGeometry.GetCrosshairPixels(), FindDeathTime(clip.startTime, timestamp));
+    }
+    
+    // The recorder holds the clip open until frames past the post-roll arrive
+    if (videoRecorder && !videoRecorder->SaveClip(clip.startTime, clip.endTime, clip.filename)) {
+        std::cerr << "[CombatAnalyzer] Failed to save video for clip " << clip.clipId << std::endl;
+    }
     
     recordedClips.push_back(clip);
     
@@ -132,6 +300,21 @@ void CombatAnalyzer::StopRecording(CombatClip& clip, double timestamp) {
     std::cout << "[CombatAnalyzer] Duration: " << (clip.endTime - clip.startTime) << "s" << std::endl;
     std::cout << "[CombatAnalyzer] Player died: " << (clip.playerDied ? "YES" : "NO") << std::endl;
     std::cout << "[CombatAnalyzer] Enemy killed: " << (clip.enemyKilled ? "YES" : "NO") << std::endl;
+    std::cout << "[CombatAnalyzer] Damage taken: " << clip.damageTaken << std::endl;
+}
+
+double CombatAnalyzer::FindDeathTime(double startTime, double endTime) const {
+    for (const auto& event : hudEventDetector.GetEventsInRange(startTime, endTime)) {
+        if (HudEventDetector::IsDeathEvent(event.type)) {
+            return event.timestamp;
+        }
+    }
+    for (const auto& damage : hudGaugeReader.GetDamageEventsInRange(startTime, endTime)) {
+        if (damage.healthAfter == 0) {
+            return damage.timestamp;
+        }
+    }
+    return endTime;
 }
 
 std::vector<CombatClip> CombatAnalyzer::GetRecordedClips() const {
@@ -147,6 +330,7 @@ std::string CombatAnalyzer::AnalyzeCombatEvent(const CombatClip& clip) {
     analysis << "- Enemies Detected: " << clip.enemies.size() << "\n";
     analysis << "- Player Died: " << (clip.playerDied ? "YES" : "NO") << "\n";
     analysis << "- Enemy Killed: " << (clip.enemyKilled ? "YES" : "NO") << "\n";
+    analysis << "- Damage Taken: " << clip.damageTaken << "\n";
     
     if (clip.playerDied) {
         analysis << "\nEvent Type: DEATH\n";
@@ -174,9 +358,8 @@ double CombatAnalyzer::CalculateCombatIntensity(const std::vector<EnemyDetection
     for (const auto& enemy : enemies) {
         totalConfidence += enemy.confidence;
         
-        cv::Point2f screenCenter(640, 360);
-        double distance = cv::norm(enemy.center - screenCenter);
-        double normalizedDistance = std::max(0.0, 1.0 - (distance / 500.0));
+        double distance = displayGeometry.DistanceFromCrosshair(enemy.center);
+        double normalizedDistance = std::max(0.0, 1.0 - (distance / proximityRadius));
         proximityFactor += normalizedDistance;
     }
     
@@ -187,11 +370,28 @@ double CombatAnalyzer::CalculateCombatIntensity(const std::vector<EnemyDetection
 }
 
 bool CombatAnalyzer::DetectPlayerDeath(const cv::Mat& frame) {
-    return currentCombatState.combatIntensity > 0.8 && currentCombatState.enemyCount > 0;
+    // A single zero read is a hidden or misread bar as often as a death, so the gauge has to agree over several frames
+    return hudEventDetector.MatchesDeath(frame) || hudGaugeReader.IsHealthDepleted();
 }
 
 bool CombatAnalyzer::DetectEnemyKill(const cv::Mat& frame) {
-    return currentCombatState.combatIntensity > 0.6 && currentCombatState.enemyCount == 0;
+    return hudEventDetector.MatchesEvent(frame, HudEventType::ENEMY_KILLED);
+}
+
+HudEventDetector& CombatAnalyzer::GetHudEventDetector() {
+    return hudEventDetector;
+}
+
+HudGaugeReader& CombatAnalyzer::GetHudGaugeReader() {
+    return hudGaugeReader;
+}
+
+PositionTracker& CombatAnalyzer::GetPositionTracker() {
+    return positionTracker;
+}
+
+std::vector<DamageEvent> CombatAnalyzer::GetDamageEvents(double startTime, double endTime) const {
+    return hudGaugeReader.GetDamageEventsInRange(startTime, endTime);
 }
 
 void CombatAnalyzer::ResetCombatState() {
@@ -207,6 +407,14 @@ CombatState CombatAnalyzer::GetCurrentCombatState() const {
     return currentCombatState;
 }
 
+OverlayFrame CombatAnalyzer::GetOverlayFrame(double timestamp) const {
+    OverlayFrame overlay = OverlaySidecar::FromDetections(timestamp, currentCombatState.activeEnemies,
+                                                          cv::Size(displayGeometry.width, displayGeometry.height));
+    overlay.combatActive = currentCombatState.isActive;
+    overlay.combatIntensity = static_cast<float>(currentCombatState.combatIntensity);
+    return overlay;
+}
+
 bool CombatAnalyzer::IsRecording() const {
     return isRecording;
 }
@@ -240,32 +448,91 @@ std::string CombatAnalyzer::GenerateClipId(double timestamp) {
     return oss.str();
 }
 
+bool CombatAnalyzer::SetSessionId(const std::string& id) {
+    EndSession();
+    sessionId = id;
+    
+    positionTracker.Reset();
+    positionTracker.OpenArchive(sessionId + ".gtta");
+    if (hudGaugeReader.HasRegions()) {
+        hudGaugeReader.OpenSeries(sessionId + "_gauges.csv");
+    }
+    return clipIndex.Open(sessionId + "_clips");
+}
+
+void CombatAnalyzer::SetMapName(const std::string& mapName) {
+    positionTracker.SetMapName(mapName);
+}
+
+void CombatAnalyzer::EndSession() {
+    hudGaugeReader.CloseSeries();
+    if (!sessionId.empty()) {
+        positionTracker.SaveHeatmaps(sessionId + ".gthm");
+    }
+    positionTracker.CloseArchive();
+}
+
 void CombatAnalyzer::SaveCombatMetadata(const CombatClip& clip) {
-    std::string filename = clip.clipId + "_metadata.csv";
-    std::ofstream file(filename);
+    if (sessionId.empty()) {
+        sessionId = "combat_session";
+    }
+    if (!clipIndex.IsOpen() && !clipIndex.Open(sessionId + "_clips")) {
+        std::cerr << "[CombatAnalyzer] Failed to save metadata for " << clip.clipId << std::endl;
+        return;
+    }
     
-    if (!file.is_open()) {
-        std::cerr << "[CombatAnalyzer] Failed to save metadata to " << filename << std::endl;
+    ClipIndexEntry entry;
+    entry.clipId = clip.clipId;
+    entry.triggerReason = clip.triggerReason;
+    entry.filename = clip.filename;
+    entry.startTime = clip.startTime;
+    entry.endTime = clip.endTime;
+    entry.combatIntensity = clip.combatIntensity;
+    entry.enemyCount = static_cast<int>(clip.enemies.size());
+    entry.damageTaken = clip.damageTaken;
+    entry.playerDied = clip.playerDied;
+    entry.enemyKilled = clip.enemyKilled;
+    
+    if (clipIndex.Append(entry)) {
+        std::cout << "[CombatAnalyzer] Appended clip metadata to " << clipIndex.GetBasePath() << std::endl;
+    }
+}
+
+void CombatAnalyzer::LoadCombatMetadata(const std::string& id) {
+    std::cout << "[CombatAnalyzer] Loading combat metadata for session: " << id << std::endl;
+    
+    std::vector<ClipIndexEntry> entries;
+    if (!ClipIndex::Load(id + "_clips", entries)) {
+        std::cout << "[CombatAnalyzer] No clip index found for session: " << id << std::endl;
         return;
     }
     
-    file << "clip_id,start_time,end_time,duration,trigger_reason,combat_intensity,player_died,enemy_killed,enemy_count\n";
-    file << clip.clipId << ","
-         << clip.startTime << ","
-         << clip.endTime << ","
-         << (clip.endTime - clip.startTime) << ","
-         << clip.triggerReason << ","
-         << clip.combatIntensity << ","
-         << (clip.playerDied ? "true" : "false") << ","
-         << (clip.enemyKilled ? "true" : "false") << ","
-         << clip.enemies.size() << "\n";
+    recordedClips.clear();
+    recordedClips.reserve(entries.size());
+    
+    for (const auto& entry : entries) {
+        CombatClip clip;
+        clip.clipId = entry.clipId;
+        clip.startTime = entry.startTime;
+        clip.endTime = entry.endTime;
+        clip.triggerReason = entry.triggerReason;
+        clip.playerDied = entry.playerDied;
+        clip.enemyKilled = entry.enemyKilled;
+        clip.damageTaken = entry.damageTaken;
+        clip.combatIntensity = entry.combatIntensity;
+        clip.filename = entry.filename;
+        recordedClips.push_back(clip);
+    }
     
-    file.close();
-    std::cout << "[CombatAnalyzer] Saved combat metadata to " << filename << std::endl;
+    std::cout << "[CombatAnalyzer] Loaded " << recordedClips.size() << " clips" << std::endl;
 }
 
-void CombatAnalyzer::LoadCombatMetadata(const std::string& sessionId) {
-    std::cout << "[CombatAnalyzer] Loading combat metadata for session: " << sessionId << std::endl;
+bool CombatAnalyzer::ExportCombatMetadataCsv(const std::string& filename) {
+    if (clipIndex.GetBasePath().empty()) {
+        std::cerr << "[CombatAnalyzer] No clip index to export" << std::endl;
+        return false;
+    }
+    return ClipIndex::ExportCsv(clipIndex.GetBasePath(), filename);
 }
 
 void CombatAnalyzer::PrintCombatState() const {
@@ -276,6 +543,29 @@ void CombatAnalyzer::PrintCombatState() const {
     std::cout << "Enemy Count: " << currentCombatState.enemyCount << std::endl;
     std::cout << "Combat Intensity: " << currentCombatState.combatIntensity << std::endl;
     std::cout << "Recording: " << (isRecording ? "YES" : "NO") << std::endl;
+    
+    // Pipelined frames go through the workers' detectors, not this one
+    DetectionCacheStats cacheStats = enemyDetector.GetCacheStats();
+    double cacheHitRate = cacheStats.hitRate;
+    double cacheSavedMs = cacheStats.savedMilliseconds;
+    if (isPipelined) {
+        PipelineStats pipelineStats = detectionPipeline.GetStats();
+        cacheHitRate = pipelineStats.cacheHitRate;
+        cacheSavedMs = pipelineStats.cacheSavedMs;
+    }
+    std::cout << "Detection Cache Hit Rate: " << (cacheHitRate * 100.0) << "%" << std::endl;
+    std::cout << "Detection Time Saved: " << cacheSavedMs << "ms" << std::endl;
+    std::cout << "HUD Events: " << hudEventDetector.GetEvents().size()
+              << " (avg " << hudEventDetector.GetAverageProcessTime() << "ms/frame)" << std::endl;
+    
+    if (isPipelined) {
+        PipelineStats pipelineStats = detectionPipeline.GetStats();
+        std::cout << "Pipeline: " << pipelineStats.inFlight << " in flight, " << pipelineStats.queueDepth
+                  << " queued, +" << pipelineStats.averageLatencyMs << "ms latency" << std::endl;
+    }
+    
+    HudGaugeSample gauges = hudGaugeReader.GetLatestSample();
+    std::cout << "Health: " << gauges.health << " Armor: " << gauges.armor << " Ammo: " << gauges.ammo << std::endl;
     std::cout << std::endl;
 }
 
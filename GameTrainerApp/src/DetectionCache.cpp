@@ -0,0 +1,190 @@
+#include "DetectionCache.h"
+#include <iostream>
+#include <algorithm>
+#include <bitset>
+
+DetectionCache::DetectionCache() 
+    : lastFrameHash(0), hasLastFrame(false), useCounter(0), maxEntries(16),
+      hashTolerance(4), sceneChangeDistance(20), maxAge(3), isEnabled(false) {
+    ResetStats();
+}
+
+DetectionCache::~DetectionCache() {
+    Invalidate();
+}
+
+uint64_t DetectionCache::ComputeFrameHash(const cv::Mat& grayFrame) {
+    if (grayFrame.empty()) {
+        return 0;
+    }
+    
+    // Average hash over an 8x8 thumbnail; INTER_AREA downscaling is vectorized by OpenCV
+    cv::Mat thumbnail;
+    cv::resize(grayFrame, thumbnail, cv::Size(8, 8), 0, 0, cv::INTER_AREA);
+    
+    double average = cv::mean(thumbnail)[0];
+    
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uchar* row = thumbnail.ptr<uchar>(y);
+        for (int x = 0; x < 8; ++x) {
+            if (row[x] > average) {
+                hash |= (uint64_t(1) << (y * 8 + x));
+            }
+        }
+    }
+    
+    return hash;
+}
+
+int DetectionCache::HammingDistance(uint64_t a, uint64_t b) {
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+bool DetectionCache::Lookup(uint64_t frameHash, std::vector<EnemyDetection>& detections) {
+    if (!isEnabled) {
+        return false;
+    }
+    
+    lookups++;
+    
+    if (hasLastFrame && HammingDistance(frameHash, lastFrameHash) > sceneChangeDistance) {
+        Invalidate();
+    }
+    lastFrameHash = frameHash;
+    hasLastFrame = true;
+    
+    DetectionCacheEntry* bestEntry = nullptr;
+    int bestDistance = hashTolerance + 1;
+    
+    for (auto& entry : entries) {
+        int distance = HammingDistance(frameHash, entry.frameHash);
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            bestEntry = &entry;
+        }
+    }
+    
+    if (!bestEntry) {
+        return false;
+    }
+    
+    // A coarse hash does not change when only an enemy moves, so reuse is
+    // limited to a few frames and the detector then runs on the frame again
+    if (lookups - bestEntry->storedAt > static_cast<size_t>(maxAge)) {
+        entries.erase(entries.begin() + (bestEntry - entries.data()));
+        expirations++;
+        return false;
+    }
+    
+    bestEntry->lastUsed = ++useCounter;
+    detections = bestEntry->detections;
+    
+    hits++;
+    savedMilliseconds += averageDetectionMs;
+    return true;
+}
+
+void DetectionCache::Store(uint64_t frameHash, const std::vector<EnemyDetection>& detections, double detectionMs) {
+    timedDetections++;
+    averageDetectionMs += (detectionMs - averageDetectionMs) / timedDetections;
+    
+    if (!isEnabled) {
+        return;
+    }
+    
+    if (entries.size() >= static_cast<size_t>(maxEntries)) {
+        auto oldest = std::min_element(entries.begin(), entries.end(),
+                                       [](const DetectionCacheEntry& a, const DetectionCacheEntry& b) {
+                                           return a.lastUsed < b.lastUsed;
+                                       });
+        entries.erase(oldest);
+    }
+    
+    DetectionCacheEntry entry;
+    entry.frameHash = frameHash;
+    entry.detections = detections;
+    entry.lastUsed = ++useCounter;
+    entry.storedAt = lookups;
+    entries.push_back(entry);
+}
+
+void DetectionCache::Invalidate() {
+    if (!entries.empty()) {
+        invalidations++;
+    }
+    entries.clear();
+}
+
+void DetectionCache::SetEnabled(bool enabled) {
+    isEnabled = enabled;
+    if (!isEnabled) {
+        Invalidate();
+    }
+    std::cout << "[DetectionCache] Cache " << (isEnabled ? "enabled" : "disabled") << std::endl;
+}
+
+void DetectionCache::SetMaxEntries(int newMaxEntries) {
+    maxEntries = std::max(1, newMaxEntries);
+    while (entries.size() > static_cast<size_t>(maxEntries)) {
+        entries.erase(entries.begin());
+    }
+    std::cout << "[DetectionCache] Max entries set to " << maxEntries << std::endl;
+}
+
+void DetectionCache::SetHashTolerance(int bits) {
+    hashTolerance = std::max(0, std::min(32, bits));
+    std::cout << "[DetectionCache] Hash tolerance set to " << hashTolerance << " bits" << std::endl;
+}
+
+void DetectionCache::SetSceneChangeDistance(int bits) {
+    sceneChangeDistance = std::max(hashTolerance, std::min(64, bits));
+    std::cout << "[DetectionCache] Scene change distance set to " << sceneChangeDistance << " bits" << std::endl;
+}
+
+void DetectionCache::SetMaxAge(int frames) {
+    maxAge = std::max(0, frames);
+    std::cout << "[DetectionCache] Max age set to " << maxAge << " frames" << std::endl;
+}
+
+bool DetectionCache::IsEnabled() const {
+    return isEnabled;
+}
+
+DetectionCacheStats DetectionCache::GetStats() const {
+    DetectionCacheStats stats;
+    stats.lookups = lookups;
+    stats.hits = hits;
+    stats.misses = lookups - hits;
+    stats.invalidations = invalidations;
+    stats.expirations = expirations;
+    stats.savedMilliseconds = savedMilliseconds;
+    stats.averageDetectionMs = averageDetectionMs;
+    stats.hitRate = lookups > 0 ? static_cast<double>(hits) / lookups : 0.0;
+    return stats;
+}
+
+void DetectionCache::ResetStats() {
+    lookups = 0;
+    hits = 0;
+    invalidations = 0;
+    expirations = 0;
+    savedMilliseconds = 0.0;
+    averageDetectionMs = 0.0;
+    timedDetections = 0;
+}
+
+void DetectionCache::PrintStats() const {
+    DetectionCacheStats stats = GetStats();
+    
+    std::cout << "\n=== DETECTION CACHE ===" << std::endl;
+    std::cout << "Enabled: " << (isEnabled ? "YES" : "NO") << std::endl;
+    std::cout << "Entries: " << entries.size() << "/" << maxEntries << std::endl;
+    std::cout << "Lookups: " << stats.lookups << std::endl;
+    std::cout << "Hits: " << stats.hits << " (" << (stats.hitRate * 100.0) << "%)" << std::endl;
+    std::cout << "Scene Changes: " << stats.invalidations << std::endl;
+    std::cout << "Expired: " << stats.expirations << " (max age " << maxAge << " frames)" << std::endl;
+    std::cout << "Avg Detection Time: " << stats.averageDetectionMs << "ms" << std::endl;
+    std::cout << "Saved Time: " << stats.savedMilliseconds << "ms" << std::endl;
+    std::cout << std::endl;
+}
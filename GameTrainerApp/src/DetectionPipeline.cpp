@@ -0,0 +1,251 @@
+#include "DetectionPipeline.h"
+#include <iostream>
+#include <algorithm>
+
+DetectionPipeline::DetectionPipeline() 
+    : nextFrameNumber(0), nextDeliveryNumber(0), isRunning(false), detectedFrames(0),
+      totalDetectionMs(0.0), totalLatencyMs(0.0), maxLatencyMs(0.0) {
+}
+
+DetectionPipeline::~DetectionPipeline() {
+    Stop();
+}
+
+bool DetectionPipeline::Start(int workerCount) {
+    if (isRunning) {
+        std::cerr << "[DetectionPipeline] Already running" << std::endl;
+        return false;
+    }
+    
+    workerCount = std::max(1, workerCount);
+    
+    // Detectors keep per-frame state, so every worker owns its own instance
+    detectors.clear();
+    for (int i = 0; i < workerCount; ++i) {
+        auto detector = std::make_unique<EnemyDetector>();
+        if (!detector->Initialize()) {
+            std::cerr << "[DetectionPipeline] Failed to initialize detector for worker " << i << std::endl;
+            detectors.clear();
+            return false;
+        }
+        detector->SetDisplayGeometry(displayGeometry);
+        detectors.push_back(std::move(detector));
+    }
+    
+    nextFrameNumber = 0;
+    nextDeliveryNumber = 0;
+    detectedFrames = 0;
+    totalDetectionMs = 0.0;
+    totalLatencyMs = 0.0;
+    maxLatencyMs = 0.0;
+    workerCacheStats.assign(workerCount, DetectionCacheStats());
+    isRunning = true;
+    
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&DetectionPipeline::WorkerLoop, this, i);
+    }
+    
+    std::cout << "[DetectionPipeline] Started with " << workerCount << " detection workers" << std::endl;
+    return true;
+}
+
+void DetectionPipeline::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(pipelineMutex);
+        if (!isRunning) {
+            return;
+        }
+        isRunning = false;
+    }
+    jobCondition.notify_all();
+    resultCondition.notify_all();
+    
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+    detectors.clear();
+    
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    jobQueue.clear();
+    completedResults.clear();
+    nextDeliveryNumber = nextFrameNumber;
+    
+    std::cout << "[DetectionPipeline] Stopped" << std::endl;
+}
+
+bool DetectionPipeline::IsRunning() const {
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    return isRunning;
+}
+
+void DetectionPipeline::SetDisplayGeometry(const DisplayGeometry& geometry) {
+    displayGeometry = geometry;
+}
+
+void DetectionPipeline::SetFramePool(std::shared_ptr<FramePool> pool) {
+    framePool = pool;
+}
+
+uint64_t DetectionPipeline::Submit(const cv::Mat& frame, double timestamp) {
+    DetectionJob job;
+    job.timestamp = timestamp;
+    
+    // Callers reuse their capture buffer for the next frame unless it came
+    // from the pool, in which case holding the handle keeps the slot busy
+    if (framePool && framePool->Owns(frame)) {
+        job.frame = frame;
+    } else if (framePool && frame.size() == framePool->GetFrameSize()) {
+        job.frame = framePool->CopyIn(frame);
+    } else {
+        job.frame = frame.clone();
+    }
+    job.submittedAt = std::chrono::steady_clock::now();
+    
+    {
+        std::lock_guard<std::mutex> lock(pipelineMutex);
+        job.frameNumber = nextFrameNumber++;
+        jobQueue.push_back(job);
+    }
+    jobCondition.notify_one();
+    
+    return job.frameNumber;
+}
+
+void DetectionPipeline::WorkerLoop(int workerIndex) {
+    EnemyDetector& detector = *detectors[workerIndex];
+    
+    while (true) {
+        DetectionJob job;
+        {
+            std::unique_lock<std::mutex> lock(pipelineMutex);
+            jobCondition.wait(lock, [this] { return !isRunning || !jobQueue.empty(); });
+            
+            if (!isRunning) {
+                return;
+            }
+            
+            job = std::move(jobQueue.front());
+            jobQueue.pop_front();
+        }
+        
+        auto detectionStart = std::chrono::steady_clock::now();
+        
+        DetectionResult result;
+        result.frameNumber = job.frameNumber;
+        result.timestamp = job.timestamp;
+        result.frame = job.frame;
+        result.enemies = detector.DetectEnemies(job.frame);
+        result.detectionMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - detectionStart).count();
+        result.addedLatencyMs = 0.0;
+        result.submittedAt = job.submittedAt;
+        DetectionCacheStats cacheStats = detector.GetCacheStats();
+        
+        bool isNext = false;
+        {
+            std::lock_guard<std::mutex> lock(pipelineMutex);
+            workerCacheStats[workerIndex] = cacheStats;
+            detectedFrames++;
+            totalDetectionMs += result.detectionMs;
+            isNext = result.frameNumber == nextDeliveryNumber;
+            completedResults.emplace(result.frameNumber, std::move(result));
+        }
+        
+        if (isNext) {
+            resultCondition.notify_all();
+        }
+    }
+}
+
+DetectionResult DetectionPipeline::TakeNextResult() {
+    auto it = completedResults.find(nextDeliveryNumber);
+    DetectionResult result = std::move(it->second);
+    completedResults.erase(it);
+    nextDeliveryNumber++;
+    
+    result.addedLatencyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - result.submittedAt).count();
+    totalLatencyMs += result.addedLatencyMs;
+    maxLatencyMs = std::max(maxLatencyMs, result.addedLatencyMs);
+    
+    return result;
+}
+
+bool DetectionPipeline::TryPopResult(DetectionResult& result) {
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    
+    if (completedResults.find(nextDeliveryNumber) == completedResults.end()) {
+        return false;
+    }
+    
+    result = TakeNextResult();
+    return true;
+}
+
+bool DetectionPipeline::WaitForResult(DetectionResult& result) {
+    std::unique_lock<std::mutex> lock(pipelineMutex);
+    
+    resultCondition.wait(lock, [this] {
+        return !isRunning || nextDeliveryNumber == nextFrameNumber ||
+               completedResults.find(nextDeliveryNumber) != completedResults.end();
+    });
+    
+    if (completedResults.find(nextDeliveryNumber) == completedResults.end()) {
+        return false;
+    }
+    
+    result = TakeNextResult();
+    return true;
+}
+
+size_t DetectionPipeline::GetInFlightCount() const {
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    return static_cast<size_t>(nextFrameNumber - nextDeliveryNumber);
+}
+
+PipelineStats DetectionPipeline::GetStats() const {
+    std::lock_guard<std::mutex> lock(pipelineMutex);
+    
+    size_t delivered = static_cast<size_t>(nextDeliveryNumber);
+    
+    PipelineStats stats;
+    stats.workerCount = static_cast<int>(workers.size());
+    stats.queueDepth = jobQueue.size();
+    stats.inFlight = static_cast<size_t>(nextFrameNumber - nextDeliveryNumber);
+    stats.reorderDepth = completedResults.size();
+    stats.framesSubmitted = static_cast<size_t>(nextFrameNumber);
+    stats.framesDelivered = delivered;
+    stats.averageDetectionMs = detectedFrames > 0 ? totalDetectionMs / detectedFrames : 0.0;
+    stats.averageLatencyMs = delivered > 0 ? totalLatencyMs / delivered : 0.0;
+    stats.maxLatencyMs = maxLatencyMs;
+    
+    stats.cacheLookups = 0;
+    stats.cacheHits = 0;
+    stats.cacheSavedMs = 0.0;
+    for (const auto& cacheStats : workerCacheStats) {
+        stats.cacheLookups += cacheStats.lookups;
+        stats.cacheHits += cacheStats.hits;
+        stats.cacheSavedMs += cacheStats.savedMilliseconds;
+    }
+    stats.cacheHitRate = stats.cacheLookups > 0 ? static_cast<double>(stats.cacheHits) / stats.cacheLookups : 0.0;
+    return stats;
+}
+
+void DetectionPipeline::PrintStats() const {
+    PipelineStats stats = GetStats();
+    
+    std::cout << "\n=== DETECTION PIPELINE ===" << std::endl;
+    std::cout << "Workers: " << stats.workerCount << std::endl;
+    std::cout << "Queue Depth: " << stats.queueDepth << std::endl;
+    std::cout << "In Flight: " << stats.inFlight << std::endl;
+    std::cout << "Reorder Buffer: " << stats.reorderDepth << std::endl;
+    std::cout << "Frames: " << stats.framesDelivered << "/" << stats.framesSubmitted << " delivered" << std::endl;
+    std::cout << "Avg Detection Time: " << stats.averageDetectionMs << "ms" << std::endl;
+    std::cout << "Avg Added Latency: " << stats.averageLatencyMs << "ms (max " << stats.maxLatencyMs << "ms)" << std::endl;
+    std::cout << "Cache Hits: " << stats.cacheHits << "/" << stats.cacheLookups << " (" << (stats.cacheHitRate * 100.0) << "%)" << std::endl;
+    std::cout << "Cache Saved Time: " << stats.cacheSavedMs << "ms" << std::endl;
+    std::cout << std::endl;
+}
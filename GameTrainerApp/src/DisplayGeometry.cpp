@@ -0,0 +1,71 @@
+#include "DisplayGeometry.h"
+#include <cmath>
+#include <algorithm>
+
+DisplayGeometry::DisplayGeometry() 
+    : DisplayGeometry(1280, 720) {
+}
+
+DisplayGeometry::DisplayGeometry(int frameWidth, int frameHeight, double fov) 
+    : width(std::max(1, frameWidth)), height(std::max(1, frameHeight)), horizontalFov(fov),
+      crosshair(0.5f, 0.5f), hudSafeArea(0.0f, 0.0f, 1.0f, 1.0f) {
+}
+
+bool DisplayGeometry::Matches(const cv::Mat& frame) const {
+    return frame.cols == width && frame.rows == height;
+}
+
+DisplayGeometry DisplayGeometry::WithResolution(int newWidth, int newHeight) const {
+    DisplayGeometry resized = *this;
+    resized.width = std::max(1, newWidth);
+    resized.height = std::max(1, newHeight);
+    return resized;
+}
+
+cv::Point2f DisplayGeometry::GetCrosshairPixels() const {
+    return ToPixels(crosshair);
+}
+
+cv::Point2f DisplayGeometry::Normalize(const cv::Point2f& pixel) const {
+    return cv::Point2f(pixel.x / width, pixel.y / height);
+}
+
+cv::Point2f DisplayGeometry::ToPixels(const cv::Point2f& normalized) const {
+    return cv::Point2f(normalized.x * width, normalized.y * height);
+}
+
+cv::Rect DisplayGeometry::ToPixels(const cv::Rect2f& normalized) const {
+    cv::Rect pixels(static_cast<int>(normalized.x * width),
+                    static_cast<int>(normalized.y * height),
+                    static_cast<int>(normalized.width * width),
+                    static_cast<int>(normalized.height * height));
+    return pixels & cv::Rect(0, 0, width, height);
+}
+
+double DisplayGeometry::NormalizeLength(double pixels) const {
+    return pixels / height;
+}
+
+double DisplayGeometry::LengthToPixels(double normalizedLength) const {
+    return normalizedLength * height;
+}
+
+double DisplayGeometry::GetReferenceScale() const {
+    return static_cast<double>(height) / kReferenceHeight;
+}
+
+double DisplayGeometry::DistanceFromCrosshair(const cv::Point2f& pixel) const {
+    return NormalizeLength(cv::norm(pixel - GetCrosshairPixels()));
+}
+
+double DisplayGeometry::AngleFromCrosshair(const cv::Point2f& pixel) const {
+    const double pi = 3.14159265358979323846;
+    double focalLength = (width / 2.0) / std::tan(horizontalFov * pi / 360.0);
+    return std::atan(cv::norm(pixel - GetCrosshairPixels()) / focalLength) * 180.0 / pi;
+}
+
+bool DisplayGeometry::IsInHudSafeArea(const cv::Point2f& pixel) const {
+    cv::Point2f normalized = Normalize(pixel);
+    return normalized.x >= hudSafeArea.x && normalized.x <= hudSafeArea.x + hudSafeArea.width &&
+           normalized.y >= hudSafeArea.y && normalized.y <= hudSafeArea.y + hudSafeArea.height;
+}
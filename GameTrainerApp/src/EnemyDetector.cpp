@@ -1,11 +1,14 @@
 #include "EnemyDetector.h"
+#include "DetectionCache.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
 
 EnemyDetector::EnemyDetector() 
     : isInitialized(false), detectionThreshold(0.5), minDetectionConfidence(0.3),
-      maxDetectionsPerFrame(10), detectionCooldown(0.1) {
+      maxDetectionsPerFrame(10), detectionCooldown(0.1), frameCounter(0),
+      combatRadius(300.0 / DisplayGeometry::kReferenceHeight),
+      detectionCache(std::make_unique<DetectionCache>()) {
 }
 
 EnemyDetector::~EnemyDetector() {
@@ -39,18 +42,36 @@ std::vector<EnemyDetection> EnemyDetector::DetectEnemies(const cv::Mat& frame) {
         return detections;
     }
     
+    if (!displayGeometry.Matches(frame)) {
+        SetDisplayGeometry(displayGeometry.WithResolution(frame.cols, frame.rows));
+    }
+    
     cv::Mat gray;
     cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
     
-    static int frameCounter = 0;
+    uint64_t frameHash = DetectionCache::ComputeFrameHash(gray);
+    if (detectionCache->Lookup(frameHash, detections)) {
+        double now = std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+        for (auto& detection : detections) {
+            detection.timestamp = now;
+        }
+        recentDetections = detections;
+        return detections;
+    }
+    
+    auto detectionStart = std::chrono::high_resolution_clock::now();
+    
     frameCounter++;
     
     if (frameCounter % 30 == 0) {
+        double scale = displayGeometry.GetReferenceScale();
+        
         EnemyDetection detection;
-        detection.boundingBox = cv::Rect(100, 100, 80, 120);
+        detection.boundingBox = cv::Rect(static_cast<int>(100 * scale), static_cast<int>(100 * scale),
+                                         static_cast<int>(80 * scale), static_cast<int>(120 * scale));
         detection.confidence = 0.75 + (rand() % 25) / 100.0;
         detection.enemyType = "player";
-        detection.center = cv::Point2f(140, 160);
+        detection.center = cv::Point2f(static_cast<float>(140 * scale), static_cast<float>(160 * scale));
         detection.timestamp = std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
         
         detections.push_back(detection);
@@ -58,6 +79,10 @@ std::vector<EnemyDetection> EnemyDetector::DetectEnemies(const cv::Mat& frame) {
     
     detections = FilterDetections(detections);
     
+    double detectionMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - detectionStart).count();
+    detectionCache->Store(frameHash, detections, detectionMs);
+    
     recentDetections = detections;
     
     return detections;
@@ -92,10 +117,7 @@ std::vector<EnemyDetection> EnemyDetector::DetectBots(const cv::Mat& frame) {
 bool EnemyDetector::IsCombatActive(const std::vector<EnemyDetection>& detections) {
     for (const auto& detection : detections) {
         if (detection.confidence > minDetectionConfidence) {
-            cv::Point2f screenCenter(640, 360);
-            double distance = cv::norm(detection.center - screenCenter);
-            
-            if (distance < 300) {
+            if (displayGeometry.DistanceFromCrosshair(detection.center) < combatRadius) {
                 return true;
             }
         }
@@ -127,12 +149,19 @@ CombatEvent EnemyDetector::AnalyzeCombatEvent(const std::vector<EnemyDetection>&
 std::vector<EnemyDetection> EnemyDetector::FilterDetections(const std::vector<EnemyDetection>& detections) {
     std::vector<EnemyDetection> filteredDetections;
     
+    // Area limits are defined at the reference height and scale with pixel count
+    double areaScale = displayGeometry.GetReferenceScale() * displayGeometry.GetReferenceScale();
+    
     for (const auto& detection : detections) {
         if (detection.confidence < minDetectionConfidence) {
             continue;
         }
         
-        if (detection.boundingBox.area() < 1000 || detection.boundingBox.area() > 50000) {
+        if (detection.boundingBox.area() < 1000 * areaScale || detection.boundingBox.area() > 50000 * areaScale) {
+            continue;
+        }
+        
+        if (!displayGeometry.IsInHudSafeArea(detection.center)) {
             continue;
         }
         
@@ -192,6 +221,21 @@ void EnemyDetector::SetMaxDetections(int maxDetections) {
     std::cout << "[EnemyDetector] Max detections per frame set to " << maxDetectionsPerFrame << std::endl;
 }
 
+void EnemyDetector::SetDisplayGeometry(const DisplayGeometry& geometry) {
+    displayGeometry = geometry;
+    detectionCache->Invalidate();
+    std::cout << "[EnemyDetector] Display geometry set to " << displayGeometry.width << "x" << displayGeometry.height << std::endl;
+}
+
+DisplayGeometry EnemyDetector::GetDisplayGeometry() const {
+    return displayGeometry;
+}
+
+void EnemyDetector::SetCombatRadius(double normalizedRadius) {
+    combatRadius = std::max(0.01, normalizedRadius);
+    std::cout << "[EnemyDetector] Combat radius set to " << combatRadius << " (normalized)" << std::endl;
+}
+
 cv::Rect EnemyDetector::ExpandBoundingBox(const cv::Rect& box, double factor) {
     int newWidth = static_cast<int>(box.width * factor);
     int newHeight = static_cast<int>(box.height * factor);
@@ -205,8 +249,10 @@ double EnemyDetector::CalculateDetectionConfidence(const cv::Mat& region) {
 
     if (region.empty()) return 0.0;
     
-    double area = region.rows * region.cols;
-    double normalizedArea = std::min(1.0, area / 10000.0); 
+    // Measured at the reference height, like the area limits in FilterDetections
+    double referenceScale = displayGeometry.GetReferenceScale();
+    double area = region.rows * region.cols / (referenceScale * referenceScale);
+    double normalizedArea = std::min(1.0, area / 10000.0);
     
     cv::Scalar mean, stddev;
     cv::meanStdDev(region, mean, stddev);
@@ -251,12 +297,26 @@ void EnemyDetector::SaveDetectionFrame(const cv::Mat& frame, const std::vector<E
     std::cout << "[EnemyDetector] Saved detection frame to " << filename << std::endl;
 }
 
+void EnemyDetector::SetCacheEnabled(bool enabled) {
+    detectionCache->SetEnabled(enabled);
+}
+
+DetectionCacheStats EnemyDetector::GetCacheStats() const {
+    return detectionCache->GetStats();
+}
+
+void EnemyDetector::PrintCacheStats() const {
+    detectionCache->PrintStats();
+}
+
 bool EnemyDetector::IsInitialized() const {
     return isInitialized;
 }
 
 void EnemyDetector::Reset() {
     recentDetections.clear();
+    detectionCache->Invalidate();
+    frameCounter = 0;
     isInitialized = false;
     std::cout << "[EnemyDetector] Reset detection system" << std::endl;
 }
@@ -0,0 +1,160 @@
+#include "FramePool.h"
+#include <iostream>
+#include <algorithm>
+
+FramePool::FramePool(size_t capacity, cv::Size size, int type)
+    : frameType(type), nextSlot(0), peakInUse(0), framesAcquired(0), overflowAllocations(0), copies(0), typeMismatches(0) {
+    Reset(capacity, size, type);
+}
+
+void FramePool::Reset(size_t capacity, cv::Size size, int type) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    
+    // Outstanding handles keep their own reference, so dropping the old slots
+    // here never frees memory a holder is still using
+    slots.clear();
+    slots.reserve(std::max<size_t>(1, capacity));
+    for (size_t i = 0; i < std::max<size_t>(1, capacity); i++) {
+        slots.emplace_back(size, type);
+    }
+    
+    frameSize = size;
+    frameType = type;
+    nextSlot = 0;
+    
+    std::cout << "[FramePool] Preallocated " << slots.size() << " frames of "
+              << size.width << "x" << size.height << std::endl;
+}
+
+bool FramePool::IsSlotFree(const cv::Mat& slot) const {
+    // Only the pool's own header references the buffer. Nobody else holds the
+    // slot, so nobody can raise the count while we look at it.
+    return slot.u != nullptr && slot.u->refcount == 1;
+}
+
+cv::Mat FramePool::Acquire() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    framesAcquired++;
+    
+    for (size_t i = 0; i < slots.size(); i++) {
+        size_t index = (nextSlot + i) % slots.size();
+        if (IsSlotFree(slots[index])) {
+            nextSlot = (index + 1) % slots.size();
+            return slots[index];
+        }
+    }
+    
+    // Never stall capture on an exhausted pool, just make the allocation visible
+    overflowAllocations++;
+    return cv::Mat(frameSize, frameType);
+}
+
+cv::Mat FramePool::CopyIn(const cv::Mat& frame) {
+    if (frame.type() != frameType) {
+        bool firstMismatch;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            firstMismatch = typeMismatches == 0;
+            typeMismatches++;
+            copies++;
+        }
+        // A mismatched source stays mismatched, so warn once rather than every frame
+        if (firstMismatch) {
+            std::cerr << "[FramePool] Frame type " << frame.type() << " does not match pool type " << frameType
+                      << ", copying such frames outside the pool" << std::endl;
+        }
+        return frame.clone();
+    }
+    
+    cv::Mat pooledFrame = Acquire();
+    if (frame.size() == frameSize) {
+        frame.copyTo(pooledFrame);
+    } else {
+        cv::resize(frame, pooledFrame, frameSize);
+    }
+    
+    RecordCopy();
+    return pooledFrame;
+}
+
+bool FramePool::Owns(const cv::Mat& frame) const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    
+    for (const auto& slot : slots) {
+        if (frame.u != nullptr && frame.u == slot.u) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FramePool::RecordCopy() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    copies++;
+}
+
+cv::Size FramePool::GetFrameSize() const {
+    return frameSize;
+}
+
+size_t FramePool::GetCapacity() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return slots.size();
+}
+
+size_t FramePool::GetInUseCount() const {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    
+    size_t inUse = 0;
+    for (const auto& slot : slots) {
+        if (!IsSlotFree(slot)) {
+            inUse++;
+        }
+    }
+    
+    peakInUse = std::max(peakInUse, inUse);
+    return inUse;
+}
+
+FramePoolStats FramePool::GetStats() const {
+    size_t inUse = GetInUseCount();
+    
+    std::lock_guard<std::mutex> lock(poolMutex);
+    
+    FramePoolStats stats;
+    stats.capacity = slots.size();
+    stats.inUse = inUse;
+    stats.peakInUse = peakInUse;
+    stats.framesAcquired = framesAcquired;
+    stats.overflowAllocations = overflowAllocations;
+    stats.copies = copies;
+    stats.typeMismatches = typeMismatches;
+    stats.copiesPerFrame = framesAcquired > 0 ? static_cast<double>(copies) / framesAcquired : 0.0;
+    stats.occupancy = !slots.empty() ? static_cast<double>(inUse) / slots.size() : 0.0;
+    return stats;
+}
+
+void FramePool::ResetStats() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    peakInUse = 0;
+    framesAcquired = 0;
+    overflowAllocations = 0;
+    copies = 0;
+    typeMismatches = 0;
+}
+
+void FramePool::PrintStats() const {
+    FramePoolStats stats = GetStats();
+    
+    std::cout << "\n=== FRAME POOL ===" << std::endl;
+    std::cout << "Frame Size: " << frameSize.width << "x" << frameSize.height << std::endl;
+    std::cout << "Occupancy: " << stats.inUse << "/" << stats.capacity
+              << " (" << static_cast<int>(stats.occupancy * 100) << "%, peak " << stats.peakInUse << ")" << std::endl;
+    std::cout << "Frames Acquired: " << stats.framesAcquired << std::endl;
+    std::cout << "Overflow Allocations: " << stats.overflowAllocations << std::endl;
+    std::cout << "Copies: " << stats.copies << " (" << stats.copiesPerFrame << " per frame)" << std::endl;
+    if (stats.typeMismatches > 0) {
+        std::cout << "Type Mismatches: " << stats.typeMismatches << std::endl;
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,175 @@
+#include "FrameTimestampIndex.h"
+#include "RecordFile.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const char kTimestampIndexMagic[4] = { 'G', 'T', 'F', 'T' };
+const uint32_t kTimestampIndexVersion = 1;
+}
+
+FrameTimestampIndex::FrameTimestampIndex() 
+    : appendedFrames(0) {
+}
+
+FrameTimestampIndex::~FrameTimestampIndex() {
+    Close();
+}
+
+bool FrameTimestampIndex::Open(const std::string& path) {
+    Close();
+    
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[FrameTimestampIndex] Failed to open timestamp index " << path << std::endl;
+        return false;
+    }
+    
+    FrameTimestampHeader header;
+    std::memcpy(header.magic, kTimestampIndexMagic, sizeof(header.magic));
+    header.version = kTimestampIndexVersion;
+    header.recordSize = sizeof(FrameTimestampRecord);
+    header.reserved = 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    appendedFrames = 0;
+    return file.good();
+}
+
+bool FrameTimestampIndex::Append(uint32_t frameNumber, double timestamp) {
+    if (!IsOpen()) {
+        return false;
+    }
+    
+    FrameTimestampRecord record;
+    record.timestamp = timestamp;
+    record.frameNumber = frameNumber;
+    record.reserved = 0;
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    
+    appendedFrames++;
+    return file.good();
+}
+
+void FrameTimestampIndex::Close() {
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+bool FrameTimestampIndex::IsOpen() const {
+    return file.is_open();
+}
+
+bool FrameTimestampIndex::Load(const std::string& path) {
+    timestamps.clear();
+    
+    MappedFile mapped;
+    if (!mapped.Open(path) || mapped.Size() < sizeof(FrameTimestampHeader)) {
+        return false;
+    }
+    
+    RecordReader reader(mapped);
+    FrameTimestampHeader header;
+    if (!reader.ReadHeader(header, kTimestampIndexMagic, kTimestampIndexVersion, sizeof(FrameTimestampRecord))) {
+        std::cerr << "[FrameTimestampIndex] Unsupported timestamp index format: " << path << std::endl;
+        return false;
+    }
+    
+    timestamps.reserve(reader.Remaining() / sizeof(FrameTimestampRecord));
+    FrameTimestampRecord record;
+    for (size_t i = 0; reader.Read(record); ++i) {
+        if (record.frameNumber != i) {
+            std::cerr << "[FrameTimestampIndex] Frame " << record.frameNumber << " out of order at record " << i
+                      << " in " << path << std::endl;
+            break;
+        }
+        timestamps.push_back(record.timestamp);
+    }
+    
+    return !timestamps.empty();
+}
+
+bool FrameTimestampIndex::IsLoaded() const {
+    return !timestamps.empty();
+}
+
+size_t FrameTimestampIndex::GetFrameCount() const {
+    return timestamps.size();
+}
+
+double FrameTimestampIndex::GetStartTime() const {
+    return timestamps.empty() ? 0.0 : timestamps.front();
+}
+
+double FrameTimestampIndex::GetEndTime() const {
+    return timestamps.empty() ? 0.0 : timestamps.back();
+}
+
+int FrameTimestampIndex::FrameAtTime(double timestamp) const {
+    if (timestamps.empty()) {
+        return -1;
+    }
+    
+    // Last frame captured at or before the requested time
+    auto it = std::upper_bound(timestamps.begin(), timestamps.end(), timestamp);
+    if (it == timestamps.begin()) {
+        return 0;
+    }
+    return static_cast<int>(it - timestamps.begin()) - 1;
+}
+
+int FrameTimestampIndex::NearestFrame(double timestamp) const {
+    int frame = FrameAtTime(timestamp);
+    if (frame < 0 || frame + 1 >= static_cast<int>(timestamps.size())) {
+        return frame;
+    }
+    
+    double before = timestamp - timestamps[frame];
+    double after = timestamps[frame + 1] - timestamp;
+    return after < before ? frame + 1 : frame;
+}
+
+double FrameTimestampIndex::TimeOfFrame(int frameNumber) const {
+    if (timestamps.empty()) {
+        return 0.0;
+    }
+    
+    size_t index = static_cast<size_t>(std::max(0, std::min(frameNumber, static_cast<int>(timestamps.size()) - 1)));
+    return timestamps[index];
+}
+
+double FrameTimestampIndex::TimeOfFrame(int frameNumber, double fallbackFps) const {
+    if (frameNumber >= 0 && static_cast<size_t>(frameNumber) < timestamps.size()) {
+        return timestamps[frameNumber];
+    }
+    if (fallbackFps <= 0.0) {
+        return timestamps.empty() ? 0.0 : timestamps.back();
+    }
+    if (timestamps.empty() || frameNumber < 0) {
+        return frameNumber / fallbackFps;
+    }
+    // Stay on the capture time base rather than restarting the clock at 0
+    int lastFrame = static_cast<int>(timestamps.size()) - 1;
+    return timestamps.back() + (frameNumber - lastFrame) / fallbackFps;
+}
+
+double FrameTimestampIndex::GetMaxDrift(double nominalFps) const {
+    if (timestamps.empty() || nominalFps <= 0.0) {
+        return 0.0;
+    }
+    
+    // How far constant-fps playback would stray from the captured times
+    double maxDrift = 0.0;
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        double nominal = timestamps.front() + i / nominalFps;
+        maxDrift = std::max(maxDrift, std::abs(timestamps[i] - nominal));
+    }
+    return maxDrift;
+}
+
+std::string FrameTimestampIndex::IndexFilenameFor(const std::string& videoFilename) {
+    return RecordReader::ReplaceExtension(videoFilename, ".fts");
+}
@@ -0,0 +1,423 @@
+#include "HeatmapAccumulator.h"
+#include "PositionTracker.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+
+namespace {
+const char kHeatmapMagic[4] = { 'G', 'T', 'H', 'M' };
+const uint32_t kHeatmapVersion = 2;   // 2: the second layer holds killer positions
+
+const uint8_t kEncodingDense = 0;
+const uint8_t kEncodingSparse = 1;
+
+struct SparseCell {
+    uint32_t cell;
+    uint32_t count;
+};
+}
+
+std::string HeatmapLayerToString(HeatmapLayer layer) {
+    switch (layer) {
+        case HeatmapLayer::ENEMY_PRESENCE: return "ENEMY_PRESENCE";
+        case HeatmapLayer::KILLER_POSITIONS: return "KILLER_POSITIONS";
+        default: return "UNKNOWN";
+    }
+}
+
+bool HeatmapKey::operator<(const HeatmapKey& other) const {
+    if (mapName != other.mapName) return mapName < other.mapName;
+    if (layer != other.layer) return layer < other.layer;
+    if (width != other.width) return width < other.width;
+    return height < other.height;
+}
+
+HeatmapAccumulator::HeatmapAccumulator()
+    : resolutions({ cv::Size(64, 36), cv::Size(256, 144) }), mapName("unknown"), sessionCount(0) {
+    RefreshActiveLayers();
+}
+
+HeatmapAccumulator::HeatmapAccumulator(const HeatmapAccumulator& other)
+    : heatmaps(other.heatmaps), resolutions(other.resolutions), mapName(other.mapName), sessionCount(other.sessionCount) {
+    RefreshActiveLayers();
+}
+
+HeatmapAccumulator& HeatmapAccumulator::operator=(const HeatmapAccumulator& other) {
+    // The active layer pointers must point into this map, not the other one
+    heatmaps = other.heatmaps;
+    resolutions = other.resolutions;
+    mapName = other.mapName;
+    sessionCount = other.sessionCount;
+    RefreshActiveLayers();
+    return *this;
+}
+
+HeatmapAccumulator::~HeatmapAccumulator() {
+}
+
+void HeatmapAccumulator::SetMapName(const std::string& name) {
+    mapName = name.empty() ? "unknown" : name;
+    RefreshActiveLayers();
+}
+
+const std::string& HeatmapAccumulator::GetMapName() const {
+    return mapName;
+}
+
+void HeatmapAccumulator::SetResolutions(const std::vector<cv::Size>& gridSizes) {
+    resolutions.clear();
+    for (const auto& size : gridSizes) {
+        // Stored as 16-bit dimensions
+        resolutions.emplace_back(std::max(1, std::min(size.width, 4096)), std::max(1, std::min(size.height, 4096)));
+    }
+    RefreshActiveLayers();
+    std::cout << "[HeatmapAccumulator] Accumulating at " << resolutions.size() << " resolutions" << std::endl;
+}
+
+const std::vector<cv::Size>& HeatmapAccumulator::GetResolutions() const {
+    return resolutions;
+}
+
+Heatmap& HeatmapAccumulator::FindOrCreate(const HeatmapKey& key) {
+    auto it = heatmaps.find(key);
+    if (it == heatmaps.end()) {
+        Heatmap heatmap;
+        heatmap.width = key.width;
+        heatmap.height = key.height;
+        heatmap.counts.assign(static_cast<size_t>(key.width) * key.height, 0);
+        heatmap.total = 0;
+        it = heatmaps.emplace(key, std::move(heatmap)).first;
+    }
+    return it->second;
+}
+
+void HeatmapAccumulator::RefreshActiveLayers() {
+    // Map nodes never move, so the pointers stay valid until Clear
+    for (int layer = 0; layer < kLayerCount; layer++) {
+        activeLayers[layer].clear();
+        for (const auto& size : resolutions) {
+            HeatmapKey key = { mapName, static_cast<HeatmapLayer>(layer), size.width, size.height };
+            activeLayers[layer].push_back(&FindOrCreate(key));
+        }
+    }
+}
+
+void HeatmapAccumulator::AddToHeatmap(Heatmap& heatmap, const cv::Point2f& normalized, uint32_t weight) {
+    // Off-screen positions have no cell
+    if (!(normalized.x >= 0.0f && normalized.x < 1.0f && normalized.y >= 0.0f && normalized.y < 1.0f)) {
+        return;
+    }
+    int x = std::min(heatmap.width - 1, static_cast<int>(normalized.x * heatmap.width));
+    int y = std::min(heatmap.height - 1, static_cast<int>(normalized.y * heatmap.height));
+    heatmap.counts[static_cast<size_t>(y) * heatmap.width + x] += weight;
+    heatmap.total += weight;
+}
+
+void HeatmapAccumulator::BeginSession() {
+    sessionCount++;
+}
+
+void HeatmapAccumulator::AddPosition(HeatmapLayer layer, const cv::Point2f& normalized, uint32_t weight) {
+    for (Heatmap* heatmap : activeLayers[static_cast<int>(layer)]) {
+        AddToHeatmap(*heatmap, normalized, weight);
+    }
+}
+
+void HeatmapAccumulator::AddTrajectory(const EnemyTrajectory& trajectory, const DisplayGeometry& geometry) {
+    const TrajectoryHistory& history = trajectory.history;
+    for (size_t i = 0; i < history.Size(); i++) {
+        if (history.IsVisible(i)) {
+            AddPosition(HeatmapLayer::ENEMY_PRESENCE, geometry.Normalize(history.Position(i)));
+        }
+    }
+}
+
+void HeatmapAccumulator::AddDeath(const DeathAnalysis& death, const DisplayGeometry& geometry) {
+    // The death itself is always at the crosshair, so only where the killer stood says anything
+    if (death.enemyDistance >= 0.0) {
+        AddPosition(HeatmapLayer::KILLER_POSITIONS, geometry.Normalize(death.enemyPosition));
+    }
+}
+
+void HeatmapAccumulator::Merge(const HeatmapAccumulator& other) {
+    for (const auto& [key, heatmap] : other.heatmaps) {
+        if (heatmap.total == 0) {
+            continue;
+        }
+
+        Heatmap& target = FindOrCreate(key);
+        for (size_t i = 0; i < target.counts.size(); i++) {
+            target.counts[i] += heatmap.counts[i];
+        }
+        target.total += heatmap.total;
+    }
+    sessionCount += other.sessionCount;
+}
+
+void HeatmapAccumulator::Clear() {
+    heatmaps.clear();
+    sessionCount = 0;
+    RefreshActiveLayers();
+}
+
+bool HeatmapAccumulator::Save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[HeatmapAccumulator] Failed to open heatmap file " << filename << std::endl;
+        return false;
+    }
+
+    uint32_t heatmapCount = 0;
+    for (const auto& [key, heatmap] : heatmaps) {
+        if (heatmap.total > 0) heatmapCount++;
+    }
+
+    HeatmapFileHeader header;
+    std::memcpy(header.magic, kHeatmapMagic, sizeof(header.magic));
+    header.version = kHeatmapVersion;
+    header.sessionCount = static_cast<uint32_t>(sessionCount);
+    header.heatmapCount = heatmapCount;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<SparseCell> sparse;
+    for (const auto& [key, heatmap] : heatmaps) {
+        if (heatmap.total == 0) {
+            continue;
+        }
+
+        sparse.clear();
+        for (size_t i = 0; i < heatmap.counts.size(); i++) {
+            if (heatmap.counts[i] > 0) {
+                sparse.push_back({ static_cast<uint32_t>(i), heatmap.counts[i] });
+            }
+        }
+        bool useSparse = sparse.size() * sizeof(SparseCell) < heatmap.counts.size() * sizeof(uint32_t);
+
+        HeatmapRecordHeader record;
+        record.layer = static_cast<uint8_t>(key.layer);
+        record.encoding = useSparse ? kEncodingSparse : kEncodingDense;
+        record.nameLength = static_cast<uint16_t>(std::min<size_t>(key.mapName.size(), 0xFFFF));
+        record.width = static_cast<uint16_t>(key.width);
+        record.height = static_cast<uint16_t>(key.height);
+        record.cellCount = static_cast<uint32_t>(useSparse ? sparse.size() : heatmap.counts.size());
+        record.total = heatmap.total;
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        file.write(key.mapName.data(), record.nameLength);
+        if (useSparse) {
+            file.write(reinterpret_cast<const char*>(sparse.data()), sparse.size() * sizeof(SparseCell));
+        } else {
+            file.write(reinterpret_cast<const char*>(heatmap.counts.data()), heatmap.counts.size() * sizeof(uint32_t));
+        }
+    }
+
+    if (!file.good()) {
+        std::cerr << "[HeatmapAccumulator] Failed to write heatmap file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HeatmapAccumulator::Load(const std::string& filename, const std::string& archiveMapName) {
+    TrajectoryArchiveHeader archiveHeader;
+    if (TrajectoryArchive::ReadHeader(filename, archiveHeader)) {
+        return LoadArchive(filename, archiveHeader, archiveMapName);
+    }
+    return LoadHeatmapFile(filename);
+}
+
+bool HeatmapAccumulator::LoadArchive(const std::string& path, const TrajectoryArchiveHeader& header,
+                                     const std::string& archiveMapName) {
+    // Archives written before the frame size was recorded are assumed to be at the default geometry
+    DisplayGeometry geometry = header.frameWidth > 0 && header.frameHeight > 0
+        ? DisplayGeometry(header.frameWidth, header.frameHeight)
+        : DisplayGeometry();
+
+    std::string previousMap = mapName;
+    SetMapName(archiveMapName);
+    bool loaded = TrajectoryArchive::ForEach(path, [this, &geometry](const EnemyTrajectory& trajectory) {
+        AddTrajectory(trajectory, geometry);
+        return true;
+    });
+    SetMapName(previousMap);
+
+    if (loaded) {
+        sessionCount++;
+    }
+    return loaded;
+}
+
+bool HeatmapAccumulator::LoadHeatmapFile(const std::string& path) {
+    MappedFile mapped;
+    if (!mapped.Open(path) || mapped.Size() < sizeof(HeatmapFileHeader)) {
+        std::cerr << "[HeatmapAccumulator] Failed to open heatmap file " << path << std::endl;
+        return false;
+    }
+
+    HeatmapFileHeader header;
+    std::memcpy(&header, mapped.Data(), sizeof(header));
+    if (std::memcmp(header.magic, kHeatmapMagic, sizeof(header.magic)) != 0 || header.version != kHeatmapVersion) {
+        std::cerr << "[HeatmapAccumulator] Unsupported heatmap format: " << path << std::endl;
+        return false;
+    }
+
+    const uint8_t* data = mapped.Data();
+    size_t size = mapped.Size();
+    size_t offset = sizeof(header);
+
+    // Everything is checked before anything is added, so a bad file leaves this accumulator unchanged
+    HeatmapAccumulator loaded;
+    loaded.sessionCount = header.sessionCount;
+    for (uint32_t i = 0; i < header.heatmapCount; i++) {
+        if (offset + sizeof(HeatmapRecordHeader) > size) {
+            std::cerr << "[HeatmapAccumulator] Truncated heatmap file " << path << std::endl;
+            return false;
+        }
+        HeatmapRecordHeader record;
+        std::memcpy(&record, data + offset, sizeof(record));
+        offset += sizeof(record);
+
+        size_t cellBytes = record.encoding == kEncodingSparse ? sizeof(SparseCell) : sizeof(uint32_t);
+        size_t gridCells = static_cast<size_t>(record.width) * record.height;
+        bool valid = record.layer < kLayerCount && record.width > 0 && record.height > 0 &&
+                     (record.encoding == kEncodingSparse ? record.cellCount <= gridCells
+                                                         : record.encoding == kEncodingDense && record.cellCount == gridCells) &&
+                     offset + record.nameLength + record.cellCount * cellBytes <= size;
+        if (!valid) {
+            std::cerr << "[HeatmapAccumulator] Corrupt heatmap record in " << path << std::endl;
+            return false;
+        }
+
+        HeatmapKey key;
+        key.mapName.assign(reinterpret_cast<const char*>(data + offset), record.nameLength);
+        key.layer = static_cast<HeatmapLayer>(record.layer);
+        key.width = record.width;
+        key.height = record.height;
+        offset += record.nameLength;
+
+        Heatmap& heatmap = loaded.FindOrCreate(key);
+        if (record.encoding == kEncodingSparse) {
+            for (uint32_t c = 0; c < record.cellCount; c++) {
+                SparseCell cell;
+                std::memcpy(&cell, data + offset + c * sizeof(cell), sizeof(cell));
+                if (cell.cell >= gridCells) {
+                    std::cerr << "[HeatmapAccumulator] Corrupt heatmap record in " << path << std::endl;
+                    return false;
+                }
+                heatmap.counts[cell.cell] += cell.count;
+            }
+        } else {
+            std::memcpy(heatmap.counts.data(), data + offset, gridCells * sizeof(uint32_t));
+        }
+        heatmap.total += record.total;
+        offset += record.cellCount * cellBytes;
+    }
+
+    Merge(loaded);
+    return true;
+}
+
+bool HeatmapAccumulator::Build(const std::vector<HeatmapSource>& sources, int workerCount, HeatmapAccumulator& result) {
+    auto buildStart = std::chrono::steady_clock::now();
+
+    int threadCount = std::max(1, std::min(workerCount, static_cast<int>(sources.size())));
+    std::vector<HeatmapAccumulator> partials(threadCount);
+    std::atomic<size_t> nextSource(0);
+    std::atomic<size_t> failed(0);
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&, i]() {
+            HeatmapAccumulator& partial = partials[i];
+            partial.resolutions = result.resolutions;
+            partial.RefreshActiveLayers();
+            size_t index;
+            while ((index = nextSource++) < sources.size()) {
+                if (!partial.Load(sources[index].path, sources[index].mapName)) {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (const auto& partial : partials) {
+        result.Merge(partial);
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count();
+    std::cout << "[HeatmapAccumulator] Built heatmaps from " << sources.size() - failed << " of " << sources.size()
+              << " sessions on " << threadCount << " workers in " << elapsed << "s" << std::endl;
+    return failed < sources.size() || sources.empty();
+}
+
+const Heatmap* HeatmapAccumulator::Find(const std::string& map, HeatmapLayer layer, const cv::Size& gridSize) const {
+    auto it = heatmaps.find(HeatmapKey{ map, layer, gridSize.width, gridSize.height });
+    return it != heatmaps.end() ? &it->second : nullptr;
+}
+
+size_t HeatmapAccumulator::GetSessionCount() const {
+    return sessionCount;
+}
+
+size_t HeatmapAccumulator::GetHeatmapCount() const {
+    return heatmaps.size();
+}
+
+std::vector<std::string> HeatmapAccumulator::GetMapNames() const {
+    std::vector<std::string> names;
+    for (const auto& [key, heatmap] : heatmaps) {
+        if (heatmap.total > 0 && (names.empty() || names.back() != key.mapName)) {
+            names.push_back(key.mapName);
+        }
+    }
+    return names;
+}
+
+cv::Mat HeatmapAccumulator::Render(const std::string& map, HeatmapLayer layer, const cv::Size& gridSize,
+                                   const cv::Size& outputSize) const {
+    const Heatmap* heatmap = Find(map, layer, gridSize);
+    if (!heatmap || heatmap->total == 0) {
+        return cv::Mat();
+    }
+
+    // Log scale, otherwise a few spawn-area cells wash out everything else
+    uint32_t peak = *std::max_element(heatmap->counts.begin(), heatmap->counts.end());
+    double scale = 255.0 / std::log1p(static_cast<double>(peak));
+    cv::Mat intensity(heatmap->height, heatmap->width, CV_8UC1);
+    for (int y = 0; y < heatmap->height; y++) {
+        uint8_t* row = intensity.ptr<uint8_t>(y);
+        for (int x = 0; x < heatmap->width; x++) {
+            row[x] = static_cast<uint8_t>(std::log1p(static_cast<double>(heatmap->counts[y * heatmap->width + x])) * scale);
+        }
+    }
+
+    cv::Mat resized;
+    cv::resize(intensity, resized, outputSize, 0, 0, cv::INTER_LINEAR);
+    cv::Mat colored;
+    cv::applyColorMap(resized, colored, cv::COLORMAP_JET);
+    return colored;
+}
+
+void HeatmapAccumulator::PrintSummary() const {
+    std::cout << "\n=== HEATMAP SUMMARY ===" << std::endl;
+    std::cout << "Sessions: " << sessionCount << std::endl;
+
+    for (const auto& [key, heatmap] : heatmaps) {
+        if (heatmap.total == 0) {
+            continue;
+        }
+
+        size_t coveredCells = std::count_if(heatmap.counts.begin(), heatmap.counts.end(), [](uint32_t count) { return count > 0; });
+        std::cout << key.mapName << " " << HeatmapLayerToString(key.layer) << " " << key.width << "x" << key.height
+                  << ": " << heatmap.total << " samples, " << coveredCells << " cells covered" << std::endl;
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,310 @@
+#include "HudEventDetector.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+HudEventDetector::HudEventDetector() 
+    : matchThreshold(0.8), downscaleFactor(0.5), lastProcessMs(0.0),
+      averageProcessMs(0.0), processedFrames(0) {
+}
+
+HudEventDetector::~HudEventDetector() {
+    ClearEvents();
+}
+
+void HudEventDetector::LoadDefaultRegions() {
+    regions.clear();
+    
+    AddRegion("kill_feed", cv::Rect2f(0.75f, 0.05f, 0.24f, 0.20f), HudEventType::ENEMY_KILLED, 0.75);
+    AddRegion("death_banner", cv::Rect2f(0.30f, 0.35f, 0.40f, 0.15f), HudEventType::PLAYER_DIED, 5.0);
+    AddRegion("spectator_label", cv::Rect2f(0.35f, 0.85f, 0.30f, 0.10f), HudEventType::SPECTATING, 5.0);
+}
+
+void HudEventDetector::AddRegion(const std::string& name, const cv::Rect2f& area, HudEventType type, double cooldown) {
+    HudRegion region;
+    region.name = name;
+    region.area = area;
+    region.eventType = type;
+    region.cooldown = std::max(0.0, cooldown);
+    region.lastTriggered = -1e9;
+    region.scaledFor = 0.0;
+    
+    regions.push_back(region);
+    std::cout << "[HudEventDetector] Added region '" << name << "' for " << GetEventTypeString(type) << std::endl;
+}
+
+bool HudEventDetector::AddTemplate(const std::string& regionName, const cv::Mat& templateImage, int referenceHeight) {
+    HudRegion* region = FindRegion(regionName);
+    if (!region || templateImage.empty()) {
+        std::cerr << "[HudEventDetector] Cannot add template to region '" << regionName << "'" << std::endl;
+        return false;
+    }
+    
+    HudTemplate hudTemplate;
+    if (templateImage.channels() == 1) {
+        hudTemplate.image = templateImage.clone();
+    } else {
+        cv::cvtColor(templateImage, hudTemplate.image, cv::COLOR_BGR2GRAY);
+    }
+    hudTemplate.referenceHeight = std::max(1, referenceHeight);
+    
+    region->templates.push_back(hudTemplate);
+    region->scaledFor = 0.0;
+    return true;
+}
+
+bool HudEventDetector::LoadTemplate(const std::string& regionName, const std::string& filename, int referenceHeight) {
+    cv::Mat image = cv::imread(filename, cv::IMREAD_GRAYSCALE);
+    if (image.empty()) {
+        std::cerr << "[HudEventDetector] Failed to load template: " << filename << std::endl;
+        return false;
+    }
+    
+    return AddTemplate(regionName, image, referenceHeight);
+}
+
+bool HudEventDetector::HasTemplates() const {
+    for (const auto& region : regions) {
+        if (!region.templates.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HudRegion* HudEventDetector::FindRegion(const std::string& name) {
+    for (auto& region : regions) {
+        if (region.name == name) {
+            return &region;
+        }
+    }
+    return nullptr;
+}
+
+cv::Mat HudEventDetector::ExtractRegion(const cv::Mat& frame, const HudRegion& region) const {
+    cv::Rect pixelArea(static_cast<int>(region.area.x * frame.cols),
+                       static_cast<int>(region.area.y * frame.rows),
+                       static_cast<int>(region.area.width * frame.cols),
+                       static_cast<int>(region.area.height * frame.rows));
+    pixelArea &= cv::Rect(0, 0, frame.cols, frame.rows);
+    
+    if (pixelArea.empty()) {
+        return cv::Mat();
+    }
+    
+    cv::Mat crop = frame(pixelArea);
+    cv::Mat gray;
+    if (crop.channels() == 1) {
+        gray = crop;
+    } else {
+        cv::cvtColor(crop, gray, crop.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    }
+    
+    if (downscaleFactor >= 1.0) {
+        return gray;
+    }
+    
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(), downscaleFactor, downscaleFactor, cv::INTER_AREA);
+    return small;
+}
+
+void HudEventDetector::PrepareTemplates(HudRegion& region, int frameHeight) {
+    double target = frameHeight * downscaleFactor;
+    if (region.scaledFor == target) {
+        return;
+    }
+    
+    for (auto& hudTemplate : region.templates) {
+        double scale = target / hudTemplate.referenceHeight;
+        int width = std::max(4, static_cast<int>(hudTemplate.image.cols * scale));
+        int height = std::max(4, static_cast<int>(hudTemplate.image.rows * scale));
+        cv::resize(hudTemplate.image, hudTemplate.scaled, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    }
+    
+    region.scaledFor = target;
+}
+
+double HudEventDetector::MatchRegion(const cv::Mat& crop, const HudRegion& region) const {
+    double bestScore = -1.0;
+    
+    for (const auto& hudTemplate : region.templates) {
+        if (hudTemplate.scaled.cols > crop.cols || hudTemplate.scaled.rows > crop.rows) {
+            continue;
+        }
+        
+        cv::Mat result;
+        cv::matchTemplate(crop, hudTemplate.scaled, result, cv::TM_CCOEFF_NORMED);
+        
+        double maxScore = 0.0;
+        cv::minMaxLoc(result, nullptr, &maxScore);
+        bestScore = std::max(bestScore, maxScore);
+    }
+    
+    return bestScore;
+}
+
+std::vector<HudEvent> HudEventDetector::ProcessFrame(const cv::Mat& frame, double timestamp) {
+    std::vector<HudEvent> newEvents;
+    
+    if (frame.empty()) {
+        return newEvents;
+    }
+    
+    auto processStart = std::chrono::high_resolution_clock::now();
+    
+    for (auto& region : regions) {
+        if (region.templates.empty() || timestamp - region.lastTriggered < region.cooldown) {
+            continue;
+        }
+        
+        cv::Mat crop = ExtractRegion(frame, region);
+        if (crop.empty()) {
+            continue;
+        }
+        
+        PrepareTemplates(region, frame.rows);
+        double score = MatchRegion(crop, region);
+        
+        if (score >= matchThreshold) {
+            HudEvent event;
+            event.timestamp = timestamp;
+            event.type = region.eventType;
+            event.regionName = region.name;
+            event.matchScore = score;
+            
+            region.lastTriggered = timestamp;
+            events.push_back(event);
+            newEvents.push_back(event);
+            
+            std::cout << "[HudEventDetector] " << GetEventTypeString(event.type) << " at " << timestamp
+                      << "s (region: " << region.name << ", score: " << score << ")" << std::endl;
+        }
+    }
+    
+    lastProcessMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - processStart).count();
+    processedFrames++;
+    averageProcessMs += (lastProcessMs - averageProcessMs) / processedFrames;
+    
+    return newEvents;
+}
+
+bool HudEventDetector::MatchesEvent(const cv::Mat& frame, HudEventType type) {
+    if (frame.empty()) {
+        return false;
+    }
+    
+    for (auto& region : regions) {
+        if (region.eventType != type || region.templates.empty()) {
+            continue;
+        }
+        
+        cv::Mat crop = ExtractRegion(frame, region);
+        if (crop.empty()) {
+            continue;
+        }
+        
+        PrepareTemplates(region, frame.rows);
+        if (MatchRegion(crop, region) >= matchThreshold) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool HudEventDetector::MatchesDeath(const cv::Mat& frame) {
+    return MatchesEvent(frame, HudEventType::PLAYER_DIED) || MatchesEvent(frame, HudEventType::SPECTATING);
+}
+
+std::vector<HudRegion> HudEventDetector::GetRegions() const {
+    return regions;
+}
+
+std::vector<HudEvent> HudEventDetector::GetEvents() const {
+    return events;
+}
+
+std::vector<HudEvent> HudEventDetector::GetEventsInRange(double startTime, double endTime) const {
+    std::vector<HudEvent> rangeEvents;
+    
+    for (const auto& event : events) {
+        if (event.timestamp >= startTime && event.timestamp <= endTime) {
+            rangeEvents.push_back(event);
+        }
+    }
+    
+    return rangeEvents;
+}
+
+bool HudEventDetector::HasEventInRange(HudEventType type, double startTime, double endTime) const {
+    for (const auto& event : events) {
+        if (event.type == type && event.timestamp >= startTime && event.timestamp <= endTime) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HudEventDetector::HasDeathInRange(double startTime, double endTime) const {
+    for (const auto& event : events) {
+        if (IsDeathEvent(event.type) && event.timestamp >= startTime && event.timestamp <= endTime) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void HudEventDetector::ClearEvents() {
+    events.clear();
+    for (auto& region : regions) {
+        region.lastTriggered = -1e9;
+    }
+}
+
+void HudEventDetector::SetMatchThreshold(double threshold) {
+    matchThreshold = std::max(0.0, std::min(1.0, threshold));
+    std::cout << "[HudEventDetector] Match threshold set to " << matchThreshold << std::endl;
+}
+
+void HudEventDetector::SetDownscaleFactor(double factor) {
+    downscaleFactor = std::max(0.1, std::min(1.0, factor));
+    for (auto& region : regions) {
+        region.scaledFor = 0.0;
+    }
+    std::cout << "[HudEventDetector] Downscale factor set to " << downscaleFactor << std::endl;
+}
+
+double HudEventDetector::GetLastProcessTime() const {
+    return lastProcessMs;
+}
+
+double HudEventDetector::GetAverageProcessTime() const {
+    return averageProcessMs;
+}
+
+std::string HudEventDetector::GetEventTypeString(HudEventType type) const {
+    switch (type) {
+        case HudEventType::ENEMY_KILLED: return "ENEMY_KILLED";
+        case HudEventType::PLAYER_DIED: return "PLAYER_DIED";
+        case HudEventType::SPECTATING: return "SPECTATING";
+        default: return "UNKNOWN";
+    }
+}
+
+bool HudEventDetector::IsDeathEvent(HudEventType type) {
+    return type == HudEventType::PLAYER_DIED || type == HudEventType::SPECTATING;
+}
+
+void HudEventDetector::PrintEvents() const {
+    std::cout << "\n=== HUD EVENTS ===" << std::endl;
+    std::cout << "Total events: " << events.size() << std::endl;
+    std::cout << "Avg Process Time: " << averageProcessMs << "ms" << std::endl;
+    
+    for (const auto& event : events) {
+        std::cout << event.timestamp << "s: " << GetEventTypeString(event.type)
+                  << " (" << event.regionName << ", score " << event.matchScore << ")" << std::endl;
+    }
+    std::cout << std::endl;
+}
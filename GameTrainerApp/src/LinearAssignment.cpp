@@ -0,0 +1,113 @@
+#include "LinearAssignment.h"
+#include <limits>
+#include <algorithm>
+
+std::vector<int> LinearAssignment::Solve(const std::vector<double>& costs, int rows, int cols) {
+    std::vector<int> assignment;
+    Workspace workspace;
+    Solve(costs, rows, cols, assignment, workspace);
+    return assignment;
+}
+
+void LinearAssignment::Solve(const std::vector<double>& costs, int rows, int cols, std::vector<int>& assignment,
+                             Workspace& workspace) {
+    assignment.assign(rows, -1);
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    
+    // The augmenting step needs at least as many columns as rows
+    if (rows > cols) {
+        std::vector<double>& transposed = workspace.transposed;
+        transposed.resize(costs.size());
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) {
+                transposed[c * rows + r] = costs[r * cols + c];
+            }
+        }
+        
+        std::vector<int>& columnAssignment = workspace.transposedAssignment;
+        SolveWide(transposed.data(), cols, rows, columnAssignment, workspace);
+        for (int c = 0; c < cols; c++) {
+            if (columnAssignment[c] >= 0) {
+                assignment[columnAssignment[c]] = c;
+            }
+        }
+        return;
+    }
+    
+    SolveWide(costs.data(), rows, cols, assignment, workspace);
+}
+
+void LinearAssignment::SolveWide(const double* costs, int rows, int cols, std::vector<int>& assignment,
+                                 Workspace& workspace) {
+    assignment.assign(rows, -1);
+    
+    // Potentials u (rows) and v (columns) are 1-based, column 0 is a virtual root
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<double>& u = workspace.u;
+    std::vector<double>& v = workspace.v;
+    std::vector<int>& rowOfColumn = workspace.rowOfColumn;
+    std::vector<int>& previousColumn = workspace.previousColumn;
+    std::vector<double>& minSlack = workspace.minSlack;
+    std::vector<char>& visited = workspace.visited;
+    u.assign(rows + 1, 0.0);
+    v.assign(cols + 1, 0.0);
+    rowOfColumn.assign(cols + 1, 0);
+    previousColumn.assign(cols + 1, 0);
+    minSlack.resize(cols + 1);
+    visited.resize(cols + 1);
+    
+    for (int row = 1; row <= rows; row++) {
+        rowOfColumn[0] = row;
+        int column = 0;
+        std::fill(minSlack.begin(), minSlack.end(), infinity);
+        std::fill(visited.begin(), visited.end(), 0);
+        
+        // Grow a shortest path tree from the new row until it reaches a free column
+        do {
+            visited[column] = 1;
+            int currentRow = rowOfColumn[column];
+            double delta = infinity;
+            int nextColumn = 0;
+            
+            const double* rowCosts = costs + (currentRow - 1) * cols;
+            for (int c = 1; c <= cols; c++) {
+                if (visited[c]) continue;
+                
+                double slack = rowCosts[c - 1] - u[currentRow] - v[c];
+                if (slack < minSlack[c]) {
+                    minSlack[c] = slack;
+                    previousColumn[c] = column;
+                }
+                if (minSlack[c] < delta) {
+                    delta = minSlack[c];
+                    nextColumn = c;
+                }
+            }
+            
+            for (int c = 0; c <= cols; c++) {
+                if (visited[c]) {
+                    u[rowOfColumn[c]] += delta;
+                    v[c] -= delta;
+                } else {
+                    minSlack[c] -= delta;
+                }
+            }
+            column = nextColumn;
+        } while (rowOfColumn[column] != 0);
+        
+        // Flip the matching along the path back to the root
+        do {
+            int previous = previousColumn[column];
+            rowOfColumn[column] = rowOfColumn[previous];
+            column = previous;
+        } while (column != 0);
+    }
+    
+    for (int c = 1; c <= cols; c++) {
+        if (rowOfColumn[c] > 0) {
+            assignment[rowOfColumn[c] - 1] = c - 1;
+        }
+    }
+}
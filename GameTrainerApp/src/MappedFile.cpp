@@ -0,0 +1,140 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() 
+    : data(nullptr), size(0),
+#ifdef _WIN32
+      fileHandle(nullptr), mappingHandle(nullptr) {
+#else
+      fileDescriptor(-1) {
+#endif
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+    
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    fileHandle = file;
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        Close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    
+    if (size == 0) {
+        return true;
+    }
+    
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        Close();
+        return false;
+    }
+    
+    data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        Close();
+        return false;
+    }
+    
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+bool MappedFile::IsOpen() const {
+    return fileHandle != nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+    
+    fileDescriptor = open(filename.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        Close();
+        return false;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+    
+    if (size == 0) {
+        return true;
+    }
+    
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    data = static_cast<const uint8_t*>(mapping);
+    
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+    data = nullptr;
+    size = 0;
+    fileDescriptor = -1;
+}
+
+bool MappedFile::IsOpen() const {
+    return fileDescriptor >= 0;
+}
+
+#endif
+
+const uint8_t* MappedFile::Data() const {
+    return data;
+}
+
+size_t MappedFile::Size() const {
+    return size;
+}
@@ -0,0 +1,103 @@
+#include "MotionFilter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+cv::Matx22d Invert(const cv::Matx22d& m) {
+    double determinant = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+    if (std::abs(determinant) < 1e-12) {
+        return cv::Matx22d::zeros();
+    }
+    return cv::Matx22d(m(1, 1), -m(0, 1), -m(1, 0), m(0, 0)) * (1.0 / determinant);
+}
+
+cv::Matx22d PositionBlock(const cv::Matx44d& covariance) {
+    return cv::Matx22d(covariance(0, 0), covariance(0, 1), covariance(1, 0), covariance(1, 1));
+}
+}
+
+MotionFilter::MotionFilter() 
+    : accelerationNoise(800.0), measurementNoise(4.0), initialVelocityNoise(300.0) {
+}
+
+MotionFilter::~MotionFilter() {
+}
+
+void MotionFilter::SetNoise(double acceleration, double measurement, double initialVelocity) {
+    accelerationNoise = std::max(1.0, acceleration);
+    measurementNoise = std::max(0.1, measurement);
+    initialVelocityNoise = std::max(1.0, initialVelocity);
+}
+
+void MotionFilter::Initialize(MotionState& motion, const cv::Point2f& position, double timestamp) const {
+    motion.state = cv::Matx41d(position.x, position.y, 0.0, 0.0);
+    motion.covariance = cv::Matx44d::zeros();
+    motion.covariance(0, 0) = measurementNoise * measurementNoise;
+    motion.covariance(1, 1) = measurementNoise * measurementNoise;
+    motion.covariance(2, 2) = initialVelocityNoise * initialVelocityNoise;
+    motion.covariance(3, 3) = initialVelocityNoise * initialVelocityNoise;
+    motion.timestamp = timestamp;
+    motion.initialized = true;
+}
+
+void MotionFilter::Propagate(const MotionState& motion, double timestamp, cv::Matx41d& state, cv::Matx44d& covariance) const {
+    double dt = std::max(0.0, timestamp - motion.timestamp);
+    
+    cv::Matx44d transition = cv::Matx44d::eye();
+    transition(0, 2) = dt;
+    transition(1, 3) = dt;
+    
+    // Discrete white-noise acceleration, applied independently per axis
+    double q = accelerationNoise * accelerationNoise;
+    double dt2 = dt * dt;
+    cv::Matx44d processNoise = cv::Matx44d::zeros();
+    processNoise(0, 0) = processNoise(1, 1) = q * dt2 * dt2 / 4.0;
+    processNoise(0, 2) = processNoise(2, 0) = processNoise(1, 3) = processNoise(3, 1) = q * dt2 * dt / 2.0;
+    processNoise(2, 2) = processNoise(3, 3) = q * dt2;
+    
+    state = transition * motion.state;
+    covariance = transition * motion.covariance * transition.t() + processNoise;
+}
+
+MotionPrediction MotionFilter::Predict(const MotionState& motion, double timestamp) const {
+    cv::Matx41d state;
+    cv::Matx44d covariance;
+    Propagate(motion, timestamp, state, covariance);
+    
+    MotionPrediction prediction;
+    prediction.position = cv::Point2f(static_cast<float>(state(0)), static_cast<float>(state(1)));
+    prediction.velocity = cv::Point2f(static_cast<float>(state(2)), static_cast<float>(state(3)));
+    prediction.covariance = PositionBlock(covariance) + cv::Matx22d::eye() * (measurementNoise * measurementNoise);
+    prediction.timestamp = timestamp;
+    return prediction;
+}
+
+void MotionFilter::Update(MotionState& motion, const cv::Point2f& measurement, double timestamp) const {
+    if (!motion.initialized) {
+        Initialize(motion, measurement, timestamp);
+        return;
+    }
+    
+    cv::Matx41d state;
+    cv::Matx44d covariance;
+    Propagate(motion, timestamp, state, covariance);
+    
+    // H selects the position, so H P H^T and P H^T are sub-blocks of P
+    cv::Matx22d innovationCovariance = PositionBlock(covariance) + cv::Matx22d::eye() * (measurementNoise * measurementNoise);
+    cv::Matx<double, 4, 2> crossCovariance;
+    for (int r = 0; r < 4; r++) {
+        crossCovariance(r, 0) = covariance(r, 0);
+        crossCovariance(r, 1) = covariance(r, 1);
+    }
+    cv::Matx<double, 4, 2> gain = crossCovariance * Invert(innovationCovariance);
+    
+    cv::Matx21d innovation(measurement.x - state(0), measurement.y - state(1));
+    motion.state = state + gain * innovation;
+    motion.covariance = covariance - gain * crossCovariance.t();
+    motion.timestamp = timestamp;
+}
+
+double MotionFilter::MahalanobisSquared(const MotionPrediction& prediction, const cv::Point2f& measurement) {
+    cv::Matx21d offset(measurement.x - prediction.position.x, measurement.y - prediction.position.y);
+    return (offset.t() * Invert(prediction.covariance) * offset)(0, 0);
+}
@@ -0,0 +1,536 @@
+#include "OfflineAnalyzer.h"
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+#include <filesystem>
+
+namespace {
+const float kSamePositionPixels = 2.0f;
+
+int64_t FrameKey(double timestamp) {
+    return static_cast<int64_t>(std::llround(timestamp * 1e6));
+}
+}
+
+OfflineAnalyzer::OfflineAnalyzer() 
+    : workerCount(std::max(1u, std::thread::hardware_concurrency())), segmentDuration(60.0),
+      overlapDuration(5.0), keyframeInterval(0), trackingDistance(100.0 / DisplayGeometry::kReferenceHeight),
+      singleSegment(false), mapName("unknown") {
+}
+
+OfflineAnalyzer::~OfflineAnalyzer() {
+}
+
+bool OfflineAnalyzer::Analyze(const std::string& videoPath, OfflineAnalysisResult& result) {
+    cv::VideoCapture probe(videoPath);
+    if (!probe.isOpened()) {
+        std::cerr << "[OfflineAnalyzer] Failed to open video: " << videoPath << std::endl;
+        return false;
+    }
+    
+    int frameCount = static_cast<int>(probe.get(cv::CAP_PROP_FRAME_COUNT));
+    double fps = probe.get(cv::CAP_PROP_FPS);
+    DisplayGeometry geometry(static_cast<int>(probe.get(cv::CAP_PROP_FRAME_WIDTH)),
+                             static_cast<int>(probe.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    probe.release();
+    
+    if (frameCount <= 0 || fps <= 0.0) {
+        std::cerr << "[OfflineAnalyzer] Video has no frame count or frame rate: " << videoPath << std::endl;
+        return false;
+    }
+    
+    // Without a timestamp index, frame times fall back to constant fps
+    if (frameTimestamps.Load(FrameTimestampIndex::IndexFilenameFor(videoPath))) {
+        std::cout << "[OfflineAnalyzer] Using capture timestamps for " << frameTimestamps.GetFrameCount()
+                  << " frames (max drift from " << fps << " fps: " << frameTimestamps.GetMaxDrift(fps) << "s)" << std::endl;
+    }
+    
+    auto analysisStart = std::chrono::steady_clock::now();
+    
+    std::vector<AnalysisSegment> segments = PlanSegments(frameCount, fps);
+    std::vector<SegmentResult> segmentResults(segments.size());
+    std::atomic<size_t> nextSegment(0);
+    
+    int threadCount = std::min(workerCount, static_cast<int>(segments.size()));
+    
+    // Workers left over when there are fewer segments than workers run detection inside each segment
+    int detectionWorkers = workerCount / threadCount;
+    std::cout << "[OfflineAnalyzer] Analyzing " << videoPath << ": " << frameCount << " frames in "
+              << segments.size() << " segments on " << threadCount << " workers";
+    if (detectionWorkers > 1) {
+        std::cout << " (" << detectionWorkers << " detection workers each)";
+    }
+    std::cout << std::endl;
+    
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&]() {
+            size_t index;
+            while ((index = nextSegment++) < segments.size()) {
+                segmentResults[index] = AnalyzeSegment(videoPath, segments[index], fps, detectionWorkers);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    result = OfflineAnalysisResult();
+    result.segmentCount = static_cast<int>(segments.size());
+    result.framesAnalyzed = 0;
+    result.framesDecoded = 0;
+    result.seekFallbacks = 0;
+    result.startTime = frameTimestamps.TimeOfFrame(0, fps);
+    result.videoDuration = frameTimestamps.IsLoaded()
+        ? frameTimestamps.GetEndTime() - frameTimestamps.GetStartTime() + 1.0 / fps
+        : frameCount / fps;
+    
+    for (const auto& segmentResult : segmentResults) {
+        if (!segmentResult.succeeded) {
+            std::cerr << "[OfflineAnalyzer] Segment " << segmentResult.segment.index << " failed" << std::endl;
+            return false;
+        }
+        result.framesAnalyzed += segmentResult.segment.endFrame - segmentResult.segment.startFrame;
+        result.framesDecoded += segmentResult.framesDecoded;
+        result.seekFallbacks += segmentResult.seekFellBack ? 1 : 0;
+    }
+    
+    StitchCombatIntervals(segmentResults, result);
+    StitchTrajectories(segmentResults, fps, geometry.LengthToPixels(trackingDistance), result);
+    
+    // Built from each segment's own positions, so overlap frames count once.
+    // The sequential reference pass of Compare leaves the file alone.
+    if (!singleSegment) {
+        HeatmapAccumulator heatmaps;
+        heatmaps.SetMapName(mapName);
+        heatmaps.BeginSession();
+        for (const auto& segmentResult : segmentResults) {
+            for (const auto& position : segmentResult.positions) {
+                if (position.isVisible) {
+                    heatmaps.AddPosition(HeatmapLayer::ENEMY_PRESENCE, geometry.Normalize(position.position));
+                }
+            }
+        }
+        
+        std::string heatmapPath = std::filesystem::path(videoPath).replace_extension(".gthm").string();
+        if (heatmaps.Save(heatmapPath)) {
+            std::cout << "[OfflineAnalyzer] Session heatmap for " << heatmaps.GetMapName() << " saved to " << heatmapPath << std::endl;
+        }
+    }
+    
+    result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - analysisStart).count();
+    return true;
+}
+
+std::vector<AnalysisSegment> OfflineAnalyzer::PlanSegments(int frameCount, double fps) const {
+    // Boundaries are placed on multiples of the keyframe interval so each seek lands on a keyframe
+    int gop = keyframeInterval > 0 ? keyframeInterval : std::max(1, static_cast<int>(std::round(fps * 2.0)));
+    int segmentFrames = std::max(gop, static_cast<int>(std::round(segmentDuration * fps / gop)) * gop);
+    int overlapFrames = static_cast<int>(std::ceil(overlapDuration * fps / gop)) * gop;
+    
+    if (singleSegment) {
+        segmentFrames = frameCount;
+    }
+    
+    std::vector<AnalysisSegment> segments;
+    for (int start = 0; start < frameCount; start += segmentFrames) {
+        AnalysisSegment segment;
+        segment.index = static_cast<int>(segments.size());
+        segment.startFrame = start;
+        segment.endFrame = std::min(frameCount, start + segmentFrames);
+        segment.warmupStartFrame = std::max(0, start - overlapFrames);
+        segments.push_back(segment);
+    }
+    
+    return segments;
+}
+
+SegmentResult OfflineAnalyzer::AnalyzeSegment(const std::string& videoPath, const AnalysisSegment& segment, double fps, int detectionWorkers) const {
+    SegmentResult result;
+    result.segment = segment;
+    result.framesDecoded = 0;
+    result.seekFellBack = false;
+    result.succeeded = false;
+    
+    cv::VideoCapture capture(videoPath);
+    if (!capture.isOpened()) {
+        return result;
+    }
+    
+    // Segment starts are placed on the assumed keyframe interval. When the
+    // backend lands somewhere else, decode up to the frame instead.
+    if (segment.warmupStartFrame > 0) {
+        capture.set(cv::CAP_PROP_POS_FRAMES, segment.warmupStartFrame);
+        int landedFrame = static_cast<int>(capture.get(cv::CAP_PROP_POS_FRAMES));
+        if (landedFrame != segment.warmupStartFrame) {
+            std::cerr << "[OfflineAnalyzer] Segment " << segment.index << " seek to frame " << segment.warmupStartFrame
+                      << " landed on " << landedFrame << ", decoding from the start" << std::endl;
+            capture.release();
+            capture.open(videoPath);
+            for (int i = 0; i < segment.warmupStartFrame; ++i) {
+                if (!capture.grab()) {
+                    return result;
+                }
+            }
+            result.seekFellBack = true;
+        }
+    }
+    
+    DisplayGeometry geometry(static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                             static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    
+    CombatAnalyzer combatAnalyzer;
+    if (!combatAnalyzer.Initialize()) {
+        return result;
+    }
+    combatAnalyzer.SetDisplayGeometry(geometry);
+    // Pipelined frames are decoded straight into pooled buffers, so the
+    // detection workers hold them without a copy
+    std::shared_ptr<FramePool> framePool;
+    if (detectionWorkers > 1) {
+        framePool = std::make_shared<FramePool>(detectionWorkers * 2 + 2, cv::Size(geometry.width, geometry.height));
+        combatAnalyzer.SetFramePool(framePool);
+        combatAnalyzer.EnablePipelining(detectionWorkers, detectionWorkers * 2);
+    }
+    
+    // Finished trajectories go to a scratch archive, so a long segment does not
+    // hold every trajectory in memory. Positions are collected once it ends.
+    PositionTracker& positionTracker = combatAnalyzer.GetPositionTracker();
+    positionTracker.SetIndexRetention(0.0);
+    std::string archivePath = std::filesystem::path(videoPath).replace_extension().string() +
+                              "_segment" + std::to_string(segment.index) + ".gtta";
+    positionTracker.OpenArchive(archivePath, false);
+    
+    double ownedStart = frameTimestamps.TimeOfFrame(segment.startFrame, fps);
+    
+    auto closeInterval = [&](CombatInterval interval) {
+        if (interval.endTime < ownedStart) {
+            return;
+        }
+        interval.continuesFromPrevious = interval.startTime < ownedStart;
+        result.combatIntervals.push_back(interval);
+    };
+    
+    CombatInterval current = CombatInterval();
+    bool wasActive = false;
+    
+    // States arrive in frame order, a few frames behind the decoder when pipelined
+    combatAnalyzer.SetStateCallback([&](const CombatState& state, double timestamp) {
+        if (state.isActive && !wasActive) {
+            current = CombatInterval();
+            current.startTime = state.startTime;
+        }
+        
+        if (state.isActive) {
+            current.endTime = timestamp;
+            current.peakIntensity = std::max(current.peakIntensity, state.combatIntensity);
+            current.maxEnemies = std::max(current.maxEnemies, state.enemyCount);
+        } else if (wasActive) {
+            current.endTime = timestamp;
+            closeInterval(current);
+        }
+        
+        wasActive = state.isActive;
+    });
+    
+    cv::Mat frame;
+    for (int frameIndex = segment.warmupStartFrame; frameIndex < segment.endFrame; ++frameIndex) {
+        if (framePool) {
+            frame = framePool->Acquire();
+        }
+        if (!capture.read(frame)) {
+            break;
+        }
+        result.framesDecoded++;
+        combatAnalyzer.SubmitFrame(frame, frameTimestamps.TimeOfFrame(frameIndex, fps));
+    }
+    combatAnalyzer.FlushPipeline();
+    combatAnalyzer.SetStateCallback(nullptr);
+    
+    if (wasActive) {
+        current.openEnded = true;
+        closeInterval(current);
+    }
+    
+    result.trajectories = positionTracker.GetAllTrajectories();
+    positionTracker.GetPositionIndex().QueryTimeRange(ownedStart, frameTimestamps.TimeOfFrame(segment.endFrame, fps), result.positions);
+    positionTracker.Reset();
+    std::error_code error;
+    std::filesystem::remove(archivePath, error);
+    result.succeeded = true;
+    return result;
+}
+
+void OfflineAnalyzer::StitchCombatIntervals(const std::vector<SegmentResult>& segments, OfflineAnalysisResult& result) const {
+    for (const auto& segment : segments) {
+        for (const auto& interval : segment.combatIntervals) {
+            if (interval.continuesFromPrevious && !result.combatIntervals.empty() &&
+                result.combatIntervals.back().openEnded) {
+                CombatInterval& previous = result.combatIntervals.back();
+                previous.endTime = interval.endTime;
+                previous.peakIntensity = std::max(previous.peakIntensity, interval.peakIntensity);
+                previous.maxEnemies = std::max(previous.maxEnemies, interval.maxEnemies);
+                previous.openEnded = interval.openEnded;
+                continue;
+            }
+            
+            CombatInterval owned = interval;
+            owned.continuesFromPrevious = false;
+            result.combatIntervals.push_back(owned);
+        }
+    }
+}
+
+void OfflineAnalyzer::StitchTrajectories(const std::vector<SegmentResult>& segments, double fps, double matchDistance, OfflineAnalysisResult& result) const {
+    double sameFrameTolerance = 0.5 / fps;
+    int nextGlobalId = 1;
+    std::vector<size_t> previousSegmentTracks;
+    
+    for (const auto& segment : segments) {
+        double ownedStart = frameTimestamps.TimeOfFrame(segment.segment.startFrame, fps);
+        std::vector<size_t> currentSegmentTracks;
+        std::vector<bool> candidateUsed(previousSegmentTracks.size(), false);
+        std::unordered_map<int, int> globalTrackIds;
+        
+        for (const auto& trajectory : segment.trajectories) {
+            // Match against the previous segment's tracks on positions both saw inside the overlap window
+            int bestCandidate = -1;
+            int bestMatches = 0;
+            
+            for (size_t c = 0; c < previousSegmentTracks.size(); ++c) {
+                if (candidateUsed[c]) continue;
+                const EnemyTrajectory& candidate = result.trajectories[previousSegmentTracks[c]];
+                
+                int matches = 0;
+                const TrajectoryHistory& history = trajectory.history;
+                const TrajectoryHistory& candidateHistory = candidate.history;
+                for (size_t i = 0; i < history.Size(); i++) {
+                    if (history.Timestamp(i) >= ownedStart) break;
+                    for (size_t j = 0; j < candidateHistory.Size(); j++) {
+                        if (std::abs(candidateHistory.Timestamp(j) - history.Timestamp(i)) < sameFrameTolerance &&
+                            cv::norm(candidateHistory.Position(j) - history.Position(i)) < matchDistance) {
+                            matches++;
+                            break;
+                        }
+                    }
+                }
+                
+                if (matches > bestMatches) {
+                    bestMatches = matches;
+                    bestCandidate = static_cast<int>(c);
+                }
+            }
+            
+            if (bestCandidate >= 0) {
+                candidateUsed[bestCandidate] = true;
+                size_t mergedIndex = previousSegmentTracks[bestCandidate];
+                EnemyTrajectory& merged = result.trajectories[mergedIndex];
+                
+                // Stitched tracks span the whole recording rather than the live window
+                const TrajectoryHistory& history = trajectory.history;
+                merged.history.SetMaxCapacity(merged.history.Size() + history.Size());
+                for (size_t i = 0; i < history.Size(); i++) {
+                    double timestamp = history.Timestamp(i);
+                    if (timestamp >= ownedStart && timestamp > merged.lastSeen) {
+                        merged.history.Push(history.Position(i), timestamp, history.Confidence(i), history.IsVisible(i));
+                        merged.lastSeen = timestamp;
+                    }
+                }
+                merged.isActive = trajectory.isActive;
+                merged.predictedNextPosition = trajectory.predictedNextPosition;
+                merged.movementSpeed = trajectory.movementSpeed;
+                merged.movementPattern = trajectory.movementPattern;
+                globalTrackIds[trajectory.trackId] = merged.trackId;
+                currentSegmentTracks.push_back(mergedIndex);
+                continue;
+            }
+            
+            // Unmatched tracks that ended inside the overlap belong to the previous segment
+            if (trajectory.lastSeen < ownedStart) {
+                continue;
+            }
+            
+            EnemyTrajectory owned = trajectory;
+            owned.trackId = nextGlobalId++;
+            owned.handle = TrackHandle();
+            owned.history.ExpireBefore(ownedStart);
+            if (!owned.history.Empty()) {
+                owned.firstSeen = owned.history.Timestamp(0);
+            }
+            
+            globalTrackIds[trajectory.trackId] = owned.trackId;
+            result.trajectories.push_back(owned);
+            currentSegmentTracks.push_back(result.trajectories.size() - 1);
+        }
+        
+        for (IndexedPosition position : segment.positions) {
+            auto globalId = globalTrackIds.find(position.trackId);
+            if (globalId == globalTrackIds.end()) continue;
+            position.trackId = globalId->second;
+            result.positionIndex.Insert(position);
+        }
+        
+        previousSegmentTracks = currentSegmentTracks;
+    }
+}
+
+bool OfflineAnalyzer::Compare(const std::string& videoPath, OfflineComparison& comparison) {
+    comparison = OfflineComparison();
+    
+    if (!Analyze(videoPath, comparison.segmented)) {
+        return false;
+    }
+    
+    int segmentedWorkers = workerCount;
+    workerCount = 1;
+    singleSegment = true;
+    bool analyzed = Analyze(videoPath, comparison.sequential);
+    workerCount = segmentedWorkers;
+    singleSegment = false;
+    if (!analyzed) {
+        return false;
+    }
+    
+    // Intervals pair up in order when they overlap
+    const auto& segmentedIntervals = comparison.segmented.combatIntervals;
+    const auto& sequentialIntervals = comparison.sequential.combatIntervals;
+    size_t s = 0;
+    for (const auto& reference : sequentialIntervals) {
+        while (s < segmentedIntervals.size() && segmentedIntervals[s].endTime < reference.startTime) {
+            comparison.segmentedOnlyIntervals++;
+            s++;
+        }
+        if (s < segmentedIntervals.size() && segmentedIntervals[s].startTime <= reference.endTime) {
+            comparison.matchedIntervals++;
+            comparison.maxBoundaryError = std::max(comparison.maxBoundaryError,
+                std::max(std::abs(segmentedIntervals[s].startTime - reference.startTime),
+                         std::abs(segmentedIntervals[s].endTime - reference.endTime)));
+            s++;
+        } else {
+            comparison.sequentialOnlyIntervals++;
+        }
+    }
+    comparison.segmentedOnlyIntervals += static_cast<int>(segmentedIntervals.size() - s);
+    
+    double start = comparison.sequential.startTime;
+    double end = start + comparison.sequential.videoDuration;
+    std::vector<IndexedPosition> sequentialPositions;
+    std::vector<IndexedPosition> segmentedPositions;
+    comparison.sequential.positionIndex.QueryTimeRange(start, end, sequentialPositions);
+    comparison.segmented.positionIndex.QueryTimeRange(start, end, segmentedPositions);
+    
+    std::unordered_map<int64_t, std::vector<const IndexedPosition*>> segmentedByFrame;
+    for (const auto& position : segmentedPositions) {
+        segmentedByFrame[FrameKey(position.timestamp)].push_back(&position);
+    }
+    
+    // How often each sequential track's positions landed on each segmented track
+    std::map<std::pair<int, int>, size_t> trackPairs;
+    comparison.sequentialPositions = sequentialPositions.size();
+    for (const auto& position : sequentialPositions) {
+        auto frame = segmentedByFrame.find(FrameKey(position.timestamp));
+        if (frame == segmentedByFrame.end()) continue;
+        
+        for (const IndexedPosition* candidate : frame->second) {
+            if (cv::norm(candidate->position - position.position) <= kSamePositionPixels) {
+                comparison.matchedPositions++;
+                trackPairs[std::make_pair(position.trackId, candidate->trackId)]++;
+                break;
+            }
+        }
+    }
+    
+    std::unordered_map<int, int> segmentedPerSequential;
+    std::unordered_map<int, int> sequentialPerSegmented;
+    for (const auto& pair : trackPairs) {
+        segmentedPerSequential[pair.first.first]++;
+        sequentialPerSegmented[pair.first.second]++;
+    }
+    for (const auto& count : segmentedPerSequential) {
+        comparison.fragmentedTracks += count.second > 1 ? 1 : 0;
+    }
+    for (const auto& count : sequentialPerSegmented) {
+        comparison.mergedTracks += count.second > 1 ? 1 : 0;
+    }
+    
+    return true;
+}
+
+void OfflineAnalyzer::SetWorkerCount(int workers) {
+    workerCount = std::max(1, workers);
+    std::cout << "[OfflineAnalyzer] Worker count set to " << workerCount << std::endl;
+}
+
+void OfflineAnalyzer::SetSegmentDuration(double seconds) {
+    segmentDuration = std::max(5.0, seconds);
+    std::cout << "[OfflineAnalyzer] Segment duration set to " << segmentDuration << " seconds" << std::endl;
+}
+
+void OfflineAnalyzer::SetOverlapDuration(double seconds) {
+    overlapDuration = std::max(0.0, seconds);
+    std::cout << "[OfflineAnalyzer] Overlap duration set to " << overlapDuration << " seconds" << std::endl;
+}
+
+void OfflineAnalyzer::SetMapName(const std::string& name) {
+    mapName = name.empty() ? "unknown" : name;
+    std::cout << "[OfflineAnalyzer] Map name set to " << mapName << std::endl;
+}
+
+void OfflineAnalyzer::SetKeyframeInterval(int frames) {
+    keyframeInterval = std::max(0, frames);
+    std::cout << "[OfflineAnalyzer] Keyframe interval set to "
+              << (keyframeInterval > 0 ? std::to_string(keyframeInterval) + " frames" : "auto") << std::endl;
+}
+
+void OfflineAnalyzer::PrintResult(const OfflineAnalysisResult& result) const {
+    std::cout << "\n=== OFFLINE ANALYSIS ===" << std::endl;
+    std::cout << "Video Duration: " << result.videoDuration << "s" << std::endl;
+    std::cout << "Segments: " << result.segmentCount << std::endl;
+    std::cout << "Frames Analyzed: " << result.framesAnalyzed << " (" << result.framesDecoded << " decoded)" << std::endl;
+    std::cout << "Elapsed: " << result.elapsedSeconds << "s";
+    if (result.elapsedSeconds > 0.0) {
+        std::cout << " (" << (result.videoDuration / result.elapsedSeconds) << "x realtime)";
+    }
+    std::cout << std::endl;
+    std::cout << "Combat Intervals: " << result.combatIntervals.size() << std::endl;
+    
+    for (const auto& interval : result.combatIntervals) {
+        std::cout << "  " << interval.startTime << "s - " << interval.endTime << "s"
+                  << " (peak intensity " << interval.peakIntensity << ", max enemies " << interval.maxEnemies << ")" << std::endl;
+    }
+    
+    std::cout << "Trajectories: " << result.trajectories.size() << std::endl;
+    std::cout << "Indexed Positions: " << result.positionIndex.Size() << std::endl;
+    if (result.seekFallbacks > 0) {
+        std::cout << "Seek Fallbacks: " << result.seekFallbacks << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void OfflineAnalyzer::PrintComparison(const OfflineComparison& comparison) const {
+    std::cout << "\n=== SEGMENTED VS SEQUENTIAL ===" << std::endl;
+    std::cout << "Segments: " << comparison.segmented.segmentCount << " (" << comparison.segmented.seekFallbacks
+              << " seek fallbacks)" << std::endl;
+    std::cout << "Elapsed: " << comparison.segmented.elapsedSeconds << "s segmented, "
+              << comparison.sequential.elapsedSeconds << "s sequential" << std::endl;
+    std::cout << "Combat Intervals: " << comparison.segmented.combatIntervals.size() << " segmented, "
+              << comparison.sequential.combatIntervals.size() << " sequential" << std::endl;
+    std::cout << "  Matched: " << comparison.matchedIntervals << " (max boundary error " << comparison.maxBoundaryError << "s)" << std::endl;
+    std::cout << "  Segmented Only: " << comparison.segmentedOnlyIntervals << std::endl;
+    std::cout << "  Sequential Only: " << comparison.sequentialOnlyIntervals << std::endl;
+    std::cout << "Trajectories: " << comparison.segmented.trajectories.size() << " segmented, "
+              << comparison.sequential.trajectories.size() << " sequential" << std::endl;
+    std::cout << "  Positions Matched: " << comparison.matchedPositions << "/" << comparison.sequentialPositions;
+    if (comparison.sequentialPositions > 0) {
+        std::cout << " (" << (100.0 * comparison.matchedPositions / comparison.sequentialPositions) << "%)";
+    }
+    std::cout << std::endl;
+    std::cout << "  Fragmented Tracks: " << comparison.fragmentedTracks << std::endl;
+    std::cout << "  Merged Tracks: " << comparison.mergedTracks << std::endl;
+    std::cout << std::endl;
+}
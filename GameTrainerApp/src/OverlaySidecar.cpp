@@ -0,0 +1,320 @@
+#include "OverlaySidecar.h"
+#include "RecordFile.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const char kOverlayMagic[4] = { 'G', 'T', 'O', 'V' };
+const uint32_t kOverlayVersion = 1;
+const uint8_t kFlagCombatActive = 0x01;
+
+const uint8_t kTypeUnknown = 0;
+const uint8_t kTypePlayer = 1;
+const uint8_t kTypeBot = 2;
+
+uint16_t ToFixed(float normalized) {
+    return static_cast<uint16_t>(std::max(0.0f, std::min(1.0f, normalized)) * 65535.0f + 0.5f);
+}
+
+float FromFixed(uint16_t value) {
+    return value / 65535.0f;
+}
+
+uint8_t EncodeEnemyType(const std::string& enemyType) {
+    if (enemyType == "player") return kTypePlayer;
+    if (enemyType == "bot") return kTypeBot;
+    return kTypeUnknown;
+}
+
+std::string DecodeEnemyType(uint8_t enemyType) {
+    switch (enemyType) {
+        case kTypePlayer: return "player";
+        case kTypeBot: return "bot";
+        default: return "unknown";
+    }
+}
+}
+
+OverlaySidecar::OverlaySidecar() 
+    : recordCount(0) {
+}
+
+OverlaySidecar::~OverlaySidecar() {
+    Close();
+}
+
+bool OverlaySidecar::Open(const std::string& path) {
+    Close();
+    
+    filename = path;
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[OverlaySidecar] Failed to open overlay sidecar " << filename << std::endl;
+        return false;
+    }
+    
+    OverlaySidecarHeader header;
+    std::memcpy(header.magic, kOverlayMagic, sizeof(header.magic));
+    header.version = kOverlayVersion;
+    header.reserved = 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    recordCount = 0;
+    return file.good();
+}
+
+bool OverlaySidecar::Append(const OverlayFrame& overlay) {
+    if (!IsOpen()) {
+        return false;
+    }
+    
+    size_t detectionCount = std::min<size_t>(overlay.detections.size(), UINT16_MAX);
+    size_t trajectoryCount = std::min<size_t>(overlay.trajectory.size(), UINT16_MAX);
+    
+    OverlayRecordHeader record;
+    record.timestamp = overlay.timestamp;
+    record.frameNumber = overlay.frameNumber;
+    record.flags = overlay.combatActive ? kFlagCombatActive : 0;
+    record.combatIntensity = static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, overlay.combatIntensity)) * 255.0f);
+    record.detectionCount = static_cast<uint16_t>(detectionCount);
+    record.trajectoryCount = static_cast<uint16_t>(trajectoryCount);
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    
+    for (size_t i = 0; i < detectionCount; i++) {
+        const OverlayDetection& detection = overlay.detections[i];
+        
+        OverlayDetectionRecord detectionRecord;
+        detectionRecord.x = ToFixed(detection.box.x);
+        detectionRecord.y = ToFixed(detection.box.y);
+        detectionRecord.width = ToFixed(detection.box.width);
+        detectionRecord.height = ToFixed(detection.box.height);
+        detectionRecord.confidence = static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, detection.confidence)) * 255.0f);
+        detectionRecord.enemyType = EncodeEnemyType(detection.enemyType);
+        file.write(reinterpret_cast<const char*>(&detectionRecord), sizeof(detectionRecord));
+    }
+    
+    for (size_t i = 0; i < trajectoryCount; i++) {
+        OverlayPointRecord point;
+        point.x = ToFixed(overlay.trajectory[i].x);
+        point.y = ToFixed(overlay.trajectory[i].y);
+        file.write(reinterpret_cast<const char*>(&point), sizeof(point));
+    }
+    
+    if (!file.good()) {
+        std::cerr << "[OverlaySidecar] Failed to append frame " << overlay.frameNumber << std::endl;
+        return false;
+    }
+    
+    recordCount++;
+    return true;
+}
+
+void OverlaySidecar::Close() {
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+bool OverlaySidecar::IsOpen() const {
+    return file.is_open();
+}
+
+size_t OverlaySidecar::GetRecordCount() const {
+    return recordCount;
+}
+
+bool OverlaySidecar::Load(const std::string& path, std::vector<OverlayFrame>& frames) {
+    MappedFile mapped;
+    if (!mapped.Open(path) || mapped.Size() < sizeof(OverlaySidecarHeader)) {
+        return false;
+    }
+    
+    RecordReader reader(mapped);
+    OverlaySidecarHeader header;
+    if (!reader.ReadHeader(header, kOverlayMagic, kOverlayVersion)) {
+        std::cerr << "[OverlaySidecar] Unsupported overlay sidecar format: " << path << std::endl;
+        return false;
+    }
+    
+    OverlayRecordHeader record;
+    while (reader.Peek(record)) {
+        size_t payload = record.detectionCount * sizeof(OverlayDetectionRecord) +
+                         record.trajectoryCount * sizeof(OverlayPointRecord);
+        if (!reader.Fits(sizeof(record) + payload)) {
+            break;
+        }
+        reader.Skip(sizeof(record));
+        
+        OverlayFrame overlay;
+        overlay.timestamp = record.timestamp;
+        overlay.frameNumber = record.frameNumber;
+        overlay.combatActive = (record.flags & kFlagCombatActive) != 0;
+        overlay.combatIntensity = record.combatIntensity / 255.0f;
+        
+        overlay.detections.reserve(record.detectionCount);
+        for (uint16_t i = 0; i < record.detectionCount; i++) {
+            OverlayDetectionRecord detectionRecord;
+            reader.Read(detectionRecord);
+            
+            OverlayDetection detection;
+            detection.box = cv::Rect2f(FromFixed(detectionRecord.x), FromFixed(detectionRecord.y),
+                                       FromFixed(detectionRecord.width), FromFixed(detectionRecord.height));
+            detection.confidence = detectionRecord.confidence / 255.0f;
+            detection.enemyType = DecodeEnemyType(detectionRecord.enemyType);
+            overlay.detections.push_back(detection);
+        }
+        
+        overlay.trajectory.reserve(record.trajectoryCount);
+        for (uint16_t i = 0; i < record.trajectoryCount; i++) {
+            OverlayPointRecord point;
+            reader.Read(point);
+            overlay.trajectory.emplace_back(FromFixed(point.x), FromFixed(point.y));
+        }
+        
+        frames.push_back(std::move(overlay));
+    }
+    
+    return true;
+}
+
+const OverlayFrame* OverlaySidecar::FindFrame(const std::vector<OverlayFrame>& frames, double timestamp) {
+    if (frames.empty()) {
+        return nullptr;
+    }
+    
+    auto it = std::lower_bound(frames.begin(), frames.end(), timestamp,
+                               [](const OverlayFrame& overlay, double value) { return overlay.timestamp < value; });
+    
+    if (it == frames.end()) {
+        return &frames.back();
+    }
+    if (it != frames.begin() && timestamp - (it - 1)->timestamp < it->timestamp - timestamp) {
+        --it;
+    }
+    return &(*it);
+}
+
+std::string OverlaySidecar::SidecarFilenameFor(const std::string& videoFilename) {
+    return RecordReader::ReplaceExtension(videoFilename, ".overlay");
+}
+
+OverlayFrame OverlaySidecar::FromDetections(double timestamp, const std::vector<EnemyDetection>& detections, cv::Size frameSize) {
+    OverlayFrame overlay;
+    overlay.timestamp = timestamp;
+    overlay.frameNumber = 0;
+    overlay.combatActive = false;
+    overlay.combatIntensity = 0.0f;
+    
+    float width = static_cast<float>(std::max(1, frameSize.width));
+    float height = static_cast<float>(std::max(1, frameSize.height));
+    
+    for (const auto& detection : detections) {
+        OverlayDetection overlayDetection;
+        overlayDetection.box = cv::Rect2f(detection.boundingBox.x / width, detection.boundingBox.y / height,
+                                          detection.boundingBox.width / width, detection.boundingBox.height / height);
+        overlayDetection.confidence = static_cast<float>(detection.confidence);
+        overlayDetection.enemyType = detection.enemyType;
+        overlay.detections.push_back(overlayDetection);
+    }
+    
+    return overlay;
+}
+
+OverlayFrame OverlaySidecar::FromPositions(double timestamp, const std::vector<cv::Point2f>& positions, cv::Size frameSize) {
+    OverlayFrame overlay;
+    overlay.timestamp = timestamp;
+    overlay.frameNumber = 0;
+    overlay.combatActive = false;
+    overlay.combatIntensity = 0.0f;
+    
+    float width = static_cast<float>(std::max(1, frameSize.width));
+    float height = static_cast<float>(std::max(1, frameSize.height));
+    
+    for (const auto& pos : positions) {
+        OverlayDetection overlayDetection;
+        overlayDetection.box = cv::Rect2f(pos.x / width, pos.y / height, 0.0f, 0.0f);
+        overlayDetection.confidence = 1.0f;
+        overlayDetection.enemyType = "unknown";
+        overlay.detections.push_back(overlayDetection);
+    }
+    
+    return overlay;
+}
+
+bool OverlaySidecar::IsEmpty(const OverlayFrame& overlay) {
+    return overlay.detections.empty() && overlay.trajectory.empty() && !overlay.combatActive;
+}
+
+void OverlaySidecar::Render(cv::Mat& frame, const OverlayFrame& overlay) {
+    float width = static_cast<float>(frame.cols);
+    float height = static_cast<float>(frame.rows);
+    cv::Scalar green(0, 255, 0);
+    
+    for (const auto& detection : overlay.detections) {
+        cv::Point2f topLeft(detection.box.x * width, detection.box.y * height);
+        
+        if (detection.box.width <= 0.0f || detection.box.height <= 0.0f) {
+            cv::circle(frame, topLeft, 5, green, -1);
+            cv::circle(frame, topLeft, 15, green, 2);
+            continue;
+        }
+        
+        cv::Rect box(static_cast<int>(topLeft.x), static_cast<int>(topLeft.y),
+                     static_cast<int>(detection.box.width * width), static_cast<int>(detection.box.height * height));
+        cv::rectangle(frame, box, green, 2);
+        
+        std::string confidenceText = std::to_string(detection.confidence).substr(0, 4);
+        cv::putText(frame, confidenceText, cv::Point(box.x, box.y - 10), cv::FONT_HERSHEY_SIMPLEX, 0.5, green, 1);
+        cv::putText(frame, detection.enemyType, cv::Point(box.x, box.y + box.height + 20), cv::FONT_HERSHEY_SIMPLEX, 0.5, green, 1);
+    }
+    
+    for (size_t i = 1; i < overlay.trajectory.size(); i++) {
+        cv::Point2f from(overlay.trajectory[i - 1].x * width, overlay.trajectory[i - 1].y * height);
+        cv::Point2f to(overlay.trajectory[i].x * width, overlay.trajectory[i].y * height);
+        cv::line(frame, from, to, cv::Scalar(255, 200, 0), 2);
+    }
+    
+    if (overlay.combatActive) {
+        std::string stateText = "COMBAT " + std::to_string(static_cast<int>(overlay.combatIntensity * 100)) + "%";
+        cv::putText(frame, stateText, cv::Point(20, 40), cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 0, 255), 2);
+    }
+}
+
+bool OverlaySidecar::RenderVideo(const std::string& videoFilename, const std::string& outputFilename) {
+    std::vector<OverlayFrame> frames;
+    if (!Load(SidecarFilenameFor(videoFilename), frames)) {
+        std::cerr << "[OverlaySidecar] No overlay sidecar for " << videoFilename << std::endl;
+        return false;
+    }
+    
+    cv::VideoCapture capture(videoFilename);
+    if (!capture.isOpened()) {
+        std::cerr << "[OverlaySidecar] Failed to open video: " << videoFilename << std::endl;
+        return false;
+    }
+    
+    double fps = capture.get(cv::CAP_PROP_FPS);
+    cv::Size frameSize(static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                       static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+    
+    cv::VideoWriter writer(outputFilename, cv::VideoWriter::fourcc('M', 'P', '4', 'V'), fps > 0 ? fps : 30.0, frameSize);
+    if (!writer.isOpened()) {
+        std::cerr << "[OverlaySidecar] Failed to open output video: " << outputFilename << std::endl;
+        return false;
+    }
+    
+    // Records are written once per encoded frame, so frame numbers line up
+    cv::Mat frame;
+    size_t frameNumber = 0;
+    while (capture.read(frame)) {
+        if (frameNumber < frames.size()) {
+            Render(frame, frames[frameNumber]);
+        }
+        writer.write(frame);
+        frameNumber++;
+    }
+    
+    std::cout << "[OverlaySidecar] Rendered " << frameNumber << " frames with overlays to " << outputFilename << std::endl;
+    return true;
+}
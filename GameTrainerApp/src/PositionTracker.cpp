@@ -4,10 +4,56 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace {
+const double kMaxPredictionSeconds = 0.5;
+const double kDefaultFrameInterval = 1.0 / 30.0;
+const double kFrameIntervalSmoothing = 0.1;
+const double kHistorySeconds = 10.0;
+
+// Kalman noise in pixels at DisplayGeometry::kReferenceHeight
+const double kAccelerationNoise = 3000.0;     // Strafing reverses direction within a few frames
+const double kMeasurementNoise = 4.0;
+const double kInitialVelocityNoise = 300.0;
+const double kGateChiSquare = 13.82;       // 99.9% for two degrees of freedom
+
+int64_t CellKey(int64_t cellX, int64_t cellY) {
+    return (cellX << 32) ^ (cellY & 0xFFFFFFFFll);
+}
+
+int TrackIdFromName(const std::string& enemyId) {
+    size_t separator = enemyId.find_last_of('_');
+    return separator != std::string::npos ? std::atoi(enemyId.c_str() + separator + 1) : 0;
+}
+}
+
+std::string MotionModelToString(MotionModel model) {
+    switch (model) {
+        case MotionModel::TWO_POINT: return "TWO_POINT";
+        case MotionModel::KALMAN: return "KALMAN";
+        default: return "UNKNOWN";
+    }
+}
+
+std::string AssociationMethodToString(AssociationMethod method) {
+    switch (method) {
+        case AssociationMethod::GREEDY: return "GREEDY";
+        case AssociationMethod::GLOBAL: return "GLOBAL";
+        default: return "UNKNOWN";
+    }
+}
 
 PositionTracker::PositionTracker() 
-    : nextEnemyId(1), maxTrackingDistance(100.0), trajectoryTimeout(5.0),
-      minPositionsForTrajectory(3), deathAnalysisRadius(200.0), visibilityThreshold(0.5) {
+    : trajectoryCount(0), nextEnemyId(1), lastUpdateTime(-1.0), frameInterval(kDefaultFrameInterval), maxTrackingDistance(100.0), trajectoryTimeout(5.0),
+      minPositionsForTrajectory(3), deathAnalysisRadius(200.0), visibilityThreshold(0.5),
+      useSpatialGrid(true), gridCellSize(0.0), associationStats(), updateTotalMs(0.0), innovationTotal(0.0),
+      innovationCount(0), velocityJitterTotal(0.0), velocityJitterCount(0), associationMethod(AssociationMethod::GLOBAL),
+      motionModel(MotionModel::KALMAN), indexRetention(120.0), finishedRetention(30.0),
+      discardedCount(0) {
+    heatmaps.BeginSession();
 }
 
 PositionTracker::~PositionTracker() {
@@ -35,50 +81,560 @@ void PositionTracker::SetMinPositionsForTrajectory(int minPositions) {
     std::cout << "[PositionTracker] Min positions for trajectory set to " << minPositionsForTrajectory << std::endl;
 }
 
+void PositionTracker::SetDisplayGeometry(const DisplayGeometry& geometry) {
+    displayGeometry = geometry;
+    std::cout << "[PositionTracker] Display geometry set to " << displayGeometry.width << "x" << displayGeometry.height << std::endl;
+}
+
+double PositionTracker::ScaledDistance(double referencePixels) const {
+    return referencePixels * displayGeometry.GetReferenceScale();
+}
+
+void PositionTracker::SetUseSpatialGrid(bool enabled) {
+    useSpatialGrid = enabled;
+    RebuildGrid();
+    std::cout << "[PositionTracker] Spatial grid " << (enabled ? "enabled" : "disabled") << std::endl;
+}
+
+void PositionTracker::SetAssociationMethod(AssociationMethod method) {
+    associationMethod = method;
+    std::cout << "[PositionTracker] Association method set to " << AssociationMethodToString(method) << std::endl;
+}
+
+AssociationMethod PositionTracker::GetAssociationMethod() const {
+    return associationMethod;
+}
+
+void PositionTracker::SetMotionModel(MotionModel model) {
+    motionModel = model;
+    
+    // Filters are only kept up to date while in use, restart them from the latest position
+    for (auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        EnemyTrajectory& trajectory = slot.trajectory;
+        if (!trajectory.history.Empty()) {
+            motionFilter.Initialize(trajectory.motion, trajectory.history.Back(), trajectory.lastSeen);
+            trajectory.prediction.timestamp = -1.0;
+        }
+    }
+    std::cout << "[PositionTracker] Motion model set to " << MotionModelToString(model) << std::endl;
+}
+
+bool PositionTracker::OpenArchive(const std::string& filename, bool compressed) {
+    if (!archive.Open(filename, compressed, displayGeometry.width, displayGeometry.height)) {
+        return false;
+    }
+    std::cout << "[PositionTracker] Archiving finished trajectories to " << filename
+              << (compressed ? " (compressed)" : "") << std::endl;
+    return true;
+}
+
+void PositionTracker::CloseArchive() {
+    if (!archive.IsOpen()) {
+        return;
+    }
+    
+    for (uint32_t index = 0; index < trackSlots.size(); index++) {
+        if (!trackSlots[index].occupied) continue;
+        if (!archive.Append(trackSlots[index].trajectory)) {
+            break;
+        }
+        FreeSlot(index);
+    }
+    archive.Close();
+}
+
+void PositionTracker::SetFinishedRetention(double seconds) {
+    finishedRetention = std::max(0.0, seconds);
+    std::cout << "[PositionTracker] Finished trajectory retention set to " << finishedRetention << " seconds" << std::endl;
+}
+
+void PositionTracker::SetIndexRetention(double seconds) {
+    indexRetention = std::max(0.0, seconds);
+    std::cout << "[PositionTracker] Position index retention set to " << indexRetention << " seconds"
+              << (indexRetention > 0.0 ? "" : " (whole session)") << std::endl;
+}
+
+size_t PositionTracker::GetArchivedCount() const {
+    return archive.GetRecordCount();
+}
+
+size_t PositionTracker::GetDiscardedCount() const {
+    return discardedCount;
+}
+
+size_t PositionTracker::GetTrajectoryCount() const {
+    return trajectoryCount;
+}
+
+void PositionTracker::SetMapName(const std::string& mapName) {
+    heatmaps.SetMapName(mapName);
+    std::cout << "[PositionTracker] Map set to " << heatmaps.GetMapName() << std::endl;
+}
+
+const HeatmapAccumulator& PositionTracker::GetHeatmaps() const {
+    return heatmaps;
+}
+
+bool PositionTracker::SaveHeatmaps(const std::string& filename) const {
+    if (!heatmaps.Save(filename)) {
+        return false;
+    }
+    std::cout << "[PositionTracker] Heatmaps saved to " << filename << std::endl;
+    return true;
+}
+
+MotionModel PositionTracker::GetMotionModel() const {
+    return motionModel;
+}
+
+int64_t PositionTracker::GridKey(const cv::Point2f& position) const {
+    int64_t cellX = static_cast<int64_t>(std::floor(position.x / gridCellSize));
+    int64_t cellY = static_cast<int64_t>(std::floor(position.y / gridCellSize));
+    return CellKey(cellX, cellY);
+}
+
+void PositionTracker::IndexTrajectory(EnemyTrajectory& trajectory, const cv::Point2f& position) {
+    if (!useSpatialGrid) {
+        return;
+    }
+    
+    int64_t key = GridKey(position);
+    TrackSlot& slot = trackSlots[trajectory.handle.slot];
+    if (slot.inGrid) {
+        if (slot.gridCell == key) {
+            return;
+        }
+        RemoveFromGrid(trajectory);
+    }
+    
+    trajectoryGrid[key].push_back(&trajectory);
+    slot.inGrid = true;
+    slot.gridCell = key;
+}
+
+void PositionTracker::RemoveFromGrid(const EnemyTrajectory& trajectory) {
+    TrackSlot& slot = trackSlots[trajectory.handle.slot];
+    if (!slot.inGrid) {
+        return;
+    }
+    
+    // Emptied cells are kept so the next trajectory to arrive reuses their storage
+    std::vector<EnemyTrajectory*>* entries = trajectoryGrid.Find(slot.gridCell);
+    if (entries) {
+        auto it = std::find(entries->begin(), entries->end(), &trajectory);
+        if (it != entries->end()) {
+            *it = entries->back();
+            entries->pop_back();
+        }
+    }
+    slot.inGrid = false;
+}
+
+void PositionTracker::RebuildGrid() {
+    trajectoryGrid.Clear();
+    for (auto& slot : trackSlots) {
+        slot.inGrid = false;
+    }
+    gridCellSize = ScaledDistance(maxTrackingDistance);
+    motionFilter.SetNoise(ScaledDistance(kAccelerationNoise), ScaledDistance(kMeasurementNoise),
+                          ScaledDistance(kInitialVelocityNoise));
+    
+    for (auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        EnemyTrajectory& trajectory = slot.trajectory;
+        if (trajectory.isActive && !trajectory.history.Empty()) {
+            IndexTrajectory(trajectory, trajectory.history.Back());
+        }
+    }
+}
+
+size_t PositionTracker::IndexPredictions(double timestamp) {
+    // Move every active trajectory to the cell of where it should be now, so
+    // detections are compared against predictions rather than stale positions
+    size_t activeCount = 0;
+    for (auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        EnemyTrajectory& trajectory = slot.trajectory;
+        if (!trajectory.isActive || trajectory.history.Empty()) continue;
+        activeCount++;
+        
+        trajectory.prediction = PredictMotion(trajectory, timestamp);
+        IndexTrajectory(trajectory, trajectory.prediction.position);
+    }
+    
+    return activeCount;
+}
+
+MotionPrediction PositionTracker::PredictMotion(const EnemyTrajectory& trajectory, double timestamp) const {
+    if (motionModel == MotionModel::KALMAN && trajectory.motion.initialized) {
+        return motionFilter.Predict(trajectory.motion, timestamp);
+    }
+    
+    MotionPrediction prediction;
+    prediction.timestamp = timestamp;
+    prediction.velocity = trajectory.velocity;
+    prediction.covariance = cv::Matx22d::zeros();
+    if (trajectory.history.Empty()) {
+        prediction.position = cv::Point2f(0, 0);
+        return prediction;
+    }
+    
+    // Constant velocity is only trusted over short gaps
+    double elapsed = std::min(std::max(0.0, timestamp - trajectory.lastSeen), kMaxPredictionSeconds);
+    prediction.position = trajectory.history.Back() + trajectory.velocity * elapsed;
+    return prediction;
+}
+
+const MotionPrediction& PositionTracker::PredictionFor(EnemyTrajectory& trajectory, double timestamp) {
+    if (trajectory.prediction.timestamp != timestamp) {
+        trajectory.prediction = PredictMotion(trajectory, timestamp);
+    }
+    return trajectory.prediction;
+}
+
+void PositionTracker::ApplyMotionEstimate(EnemyTrajectory& trajectory) {
+    MotionPrediction next = motionFilter.Predict(trajectory.motion, trajectory.lastSeen + frameInterval);
+    trajectory.velocity = next.velocity;
+    trajectory.movementSpeed = cv::norm(next.velocity);
+    trajectory.predictedNextPosition = next.position;
+}
+
+void PositionTracker::GatherCandidates(const cv::Point2f& position, double timestamp,
+                                       std::vector<std::pair<EnemyTrajectory*, double>>& candidates) {
+    double gate = ScaledDistance(maxTrackingDistance);
+    std::vector<EnemyTrajectory*> expired;
+    
+    auto consider = [&](EnemyTrajectory& trajectory) {
+        if (!trajectory.isActive || trajectory.history.Empty()) return;
+        
+        if (timestamp - trajectory.lastSeen > trajectoryTimeout) {
+            expired.push_back(&trajectory);
+            return;
+        }
+        
+        associationStats.candidatesExamined++;
+        const MotionPrediction& prediction = PredictionFor(trajectory, timestamp);
+        double distance = cv::norm(position - prediction.position);
+        if (distance >= gate) return;
+        
+        // The filter's uncertainty narrows the gate for settled tracks
+        if (motionModel == MotionModel::KALMAN && trajectory.motion.initialized &&
+            MotionFilter::MahalanobisSquared(prediction, position) > kGateChiSquare) {
+            return;
+        }
+        candidates.emplace_back(&trajectory, distance);
+    };
+    
+    if (useSpatialGrid && gridCellSize > 0.0) {
+        int64_t cellX = static_cast<int64_t>(std::floor(position.x / gridCellSize));
+        int64_t cellY = static_cast<int64_t>(std::floor(position.y / gridCellSize));
+        
+        for (int64_t dy = -1; dy <= 1; dy++) {
+            for (int64_t dx = -1; dx <= 1; dx++) {
+                const std::vector<EnemyTrajectory*>* cell = trajectoryGrid.Find(CellKey(cellX + dx, cellY + dy));
+                if (!cell) continue;
+                
+                for (EnemyTrajectory* trajectory : *cell) {
+                    consider(*trajectory);
+                }
+            }
+        }
+    } else {
+        for (auto& slot : trackSlots) {
+            if (!slot.occupied) continue;
+            EnemyTrajectory& trajectory = slot.trajectory;
+            consider(trajectory);
+        }
+    }
+    
+    for (EnemyTrajectory* trajectory : expired) {
+        trajectory->isActive = false;
+        RemoveFromGrid(*trajectory);
+    }
+}
+
+void PositionTracker::AssociateGlobal(const std::vector<EnemyDetection>& detections, double timestamp,
+                                      std::vector<EnemyTrajectory*>& matches) {
+    size_t detectionCount = detections.size();
+    matches.assign(detectionCount, nullptr);
+    
+    // Gated edges between detections and the trajectories predicted near them,
+    // stored back to back with edgeOffsets marking where each detection starts
+    edges.clear();
+    edgeOffsets.assign(1, 0);
+    candidateTracks.clear();
+    slotTrackIndex.resize(trackSlots.size(), -1);
+    for (size_t d = 0; d < detectionCount; d++) {
+        size_t first = edges.size();
+        GatherCandidates(detections[d].center, timestamp, edges);
+        edgeOffsets.push_back(edges.size());
+        for (size_t e = first; e < edges.size(); e++) {
+            int& trackIndex = slotTrackIndex[edges[e].first->handle.slot];
+            if (trackIndex < 0) {
+                trackIndex = static_cast<int>(candidateTracks.size());
+                candidateTracks.push_back(edges[e].first);
+            }
+        }
+    }
+    auto trackIndexOf = [this](size_t edge) {
+        return slotTrackIndex[edges[edge].first->handle.slot];
+    };
+    
+    // Split into independent groups so each solve stays small in crowded scenes.
+    // Nodes 0..D-1 are detections, D.. are trajectories.
+    unionParent.resize(detectionCount + candidateTracks.size());
+    for (size_t i = 0; i < unionParent.size(); i++) {
+        unionParent[i] = static_cast<int>(i);
+    }
+    auto findRoot = [this](int node) {
+        while (unionParent[node] != node) {
+            unionParent[node] = unionParent[unionParent[node]];
+            node = unionParent[node];
+        }
+        return node;
+    };
+    
+    for (size_t d = 0; d < detectionCount; d++) {
+        for (size_t e = edgeOffsets[d]; e < edgeOffsets[d + 1]; e++) {
+            int a = findRoot(static_cast<int>(d));
+            int b = findRoot(static_cast<int>(detectionCount) + trackIndexOf(e));
+            if (a != b) {
+                unionParent[a] = b;
+            }
+        }
+    }
+    
+    // Sorting by root groups each component, detections first since their nodes are lower
+    componentOrder.clear();
+    for (size_t d = 0; d < detectionCount; d++) {
+        if (edgeOffsets[d + 1] > edgeOffsets[d]) {
+            componentOrder.emplace_back(findRoot(static_cast<int>(d)), static_cast<int>(d));
+        }
+    }
+    for (size_t t = 0; t < candidateTracks.size(); t++) {
+        int node = static_cast<int>(detectionCount + t);
+        componentOrder.emplace_back(findRoot(node), node);
+    }
+    std::sort(componentOrder.begin(), componentOrder.end());
+    
+    // Leaving a detection unmatched costs as much as the gate, so any pairing
+    // inside the gate is preferred over starting a new trajectory
+    double gate = ScaledDistance(maxTrackingDistance);
+    trackColumn.resize(candidateTracks.size());
+    for (size_t begin = 0; begin < componentOrder.size();) {
+        size_t split = begin;
+        size_t end = begin;
+        while (end < componentOrder.size() && componentOrder[end].first == componentOrder[begin].first) {
+            if (componentOrder[end].second < static_cast<int>(detectionCount)) split = end + 1;
+            end++;
+        }
+        size_t rowCount = split - begin;
+        size_t colCount = end - split;
+        size_t first = begin;
+        auto row = [this, first](size_t r) { return componentOrder[first + r].second; };
+        auto col = [this, split, detectionCount](size_t c) {
+            return componentOrder[split + c].second - static_cast<int>(detectionCount);
+        };
+        begin = end;
+        
+        associationStats.componentsSolved++;
+        associationStats.largestComponent = std::max(associationStats.largestComponent, rowCount + colCount);
+        
+        if (rowCount == 1 && colCount == 1) {
+            matches[row(0)] = candidateTracks[col(0)];
+            continue;
+        }
+        
+        for (size_t c = 0; c < colCount; c++) {
+            trackColumn[col(c)] = static_cast<int>(c);
+        }
+        
+        assignmentCosts.assign(rowCount * colCount, gate);
+        for (size_t r = 0; r < rowCount; r++) {
+            for (size_t e = edgeOffsets[row(r)]; e < edgeOffsets[row(r) + 1]; e++) {
+                assignmentCosts[r * colCount + trackColumn[trackIndexOf(e)]] = edges[e].second;
+            }
+        }
+        
+        LinearAssignment::Solve(assignmentCosts, static_cast<int>(rowCount), static_cast<int>(colCount), assignment,
+                                assignmentWorkspace);
+        for (size_t r = 0; r < rowCount; r++) {
+            int c = assignment[r];
+            if (c >= 0 && assignmentCosts[r * colCount + c] < gate) {
+                matches[row(r)] = candidateTracks[col(c)];
+            }
+        }
+    }
+    
+    for (EnemyTrajectory* trajectory : candidateTracks) {
+        slotTrackIndex[trajectory->handle.slot] = -1;
+    }
+}
+
+PositionTracker::TrackSlot& PositionTracker::AllocateSlot() {
+    uint32_t index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(trackSlots.size());
+        trackSlots.emplace_back();
+        trackSlots.back().generation = 0;
+    }
+    
+    TrackSlot& slot = trackSlots[index];
+    slot.occupied = true;
+    slot.inGrid = false;
+    slot.gridCell = 0;
+    slot.trajectory.handle.slot = index;
+    slot.trajectory.handle.generation = slot.generation;
+    trajectoryCount++;
+    return slot;
+}
+
+void PositionTracker::FreeSlot(uint32_t index) {
+    TrackSlot& slot = trackSlots[index];
+    RemoveFromGrid(slot.trajectory);
+    
+    // History storage stays with the slot for the next trajectory
+    slot.trajectory.history.Clear();
+    slot.occupied = false;
+    slot.generation++;
+    freeSlots.push_back(index);
+    trajectoryCount--;
+}
+
+std::string PositionTracker::EnemyName(int trackId) {
+    return "enemy_" + std::to_string(trackId);
+}
+
+EnemyTrajectory& PositionTracker::StartTrajectory(const EnemyPosition& position) {
+    EnemyTrajectory& trajectory = AllocateSlot().trajectory;
+    trajectory.trackId = position.trackId;
+    trajectory.history.Clear();
+    trajectory.history.Push(position.position, position.timestamp, static_cast<float>(position.confidence), position.isVisible);
+    RecordPosition(position);
+    trajectory.firstSeen = position.timestamp;
+    trajectory.lastSeen = position.timestamp;
+    trajectory.isActive = true;
+    trajectory.predictedNextPosition = position.position;
+    trajectory.velocity = cv::Point2f(0, 0);
+    trajectory.movementSpeed = 0.0;
+    trajectory.movementPattern = "stationary";
+    motionFilter.Initialize(trajectory.motion, position.position, position.timestamp);
+    trajectory.prediction = motionFilter.Predict(trajectory.motion, position.timestamp);
+    
+    IndexTrajectory(trajectory, position.position);
+    return trajectory;
+}
+
+void PositionTracker::IndexPosition(const EnemyPosition& position) {
+    IndexedPosition indexed;
+    indexed.position = position.position;
+    indexed.timestamp = position.timestamp;
+    indexed.confidence = static_cast<float>(position.confidence);
+    indexed.trackId = position.trackId;
+    indexed.isVisible = position.isVisible;
+    positionIndex.Insert(indexed);
+}
+
+void PositionTracker::RecordPosition(const EnemyPosition& position) {
+    IndexPosition(position);
+    if (position.isVisible) {
+        heatmaps.AddPosition(HeatmapLayer::ENEMY_PRESENCE, displayGeometry.Normalize(position.position));
+    }
+}
+
 void PositionTracker::UpdateEnemyPositions(const std::vector<EnemyDetection>& detections, double timestamp) {
+    auto updateStart = std::chrono::steady_clock::now();
+    
+    // Tracking distance or display geometry changed since the grid was built
+    if (gridCellSize != ScaledDistance(maxTrackingDistance)) {
+        RebuildGrid();
+    }
+    
+    if (lastUpdateTime >= 0.0 && timestamp > lastUpdateTime) {
+        frameInterval += (timestamp - lastUpdateTime - frameInterval) * kFrameIntervalSmoothing;
+    }
+    lastUpdateTime = timestamp;
+    
     CleanupOldTrajectories(timestamp);
+    size_t activeCount = IndexPredictions(timestamp);
+    
+    if (associationMethod == AssociationMethod::GLOBAL) {
+        AssociateGlobal(detections, timestamp, frameMatches);
+    }
+    
+    updatedTrajectories.clear();
+    lastAssignedHandles.assign(detections.size(), TrackHandle());
     
-    for (const auto& detection : detections) {
+    for (size_t d = 0; d < detections.size(); d++) {
         EnemyPosition position;
-        position.position = detection.center;
+        position.position = detections[d].center;
         position.timestamp = timestamp;
-        position.confidence = detection.confidence;
+        position.confidence = detections[d].confidence;
         position.isVisible = true;
         
-        EnemyTrajectory* trajectory = FindEnemyTrajectory(position.position, timestamp);
+        EnemyTrajectory* trajectory = associationMethod == AssociationMethod::GLOBAL
+            ? frameMatches[d]
+            : FindEnemyTrajectory(position.position, timestamp);
         
         if (trajectory) {
-            position.enemyId = trajectory->enemyId;
+            position.trackId = trajectory->trackId;
+            innovationTotal += cv::norm(position.position - PredictionFor(*trajectory, timestamp).position);
+            innovationCount++;
             UpdateTrajectory(*trajectory, position);
+            IndexTrajectory(*trajectory, position.position);
+            updatedTrajectories.push_back(trajectory);
         } else {
-            position.enemyId = AssignEnemyId(position.position, timestamp);
-            
-            EnemyTrajectory newTrajectory;
-            newTrajectory.enemyId = position.enemyId;
-            newTrajectory.positions.push_back(position);
-            newTrajectory.firstSeen = timestamp;
-            newTrajectory.lastSeen = timestamp;
-            newTrajectory.isActive = true;
-            newTrajectory.movementSpeed = 0.0;
-            newTrajectory.movementPattern = "stationary";
-            
-            enemyTrajectories[position.enemyId] = newTrajectory;
+            position.trackId = AssignEnemyId(position.position, timestamp);
+            trajectory = &StartTrajectory(position);
+            associationStats.unmatchedDetections++;
         }
+        lastAssignedHandles[d] = trajectory->handle;
     }
     
-    for (auto& [enemyId, trajectory] : enemyTrajectories) {
-        if (trajectory.isActive && trajectory.positions.size() >= minPositionsForTrajectory) {
-            CalculateMovementSpeed(trajectory);
-            trajectory.movementPattern = AnalyzeMovementPattern(trajectory);
-            PredictNextPosition(trajectory);
+    // Trajectories without a new position this frame have nothing to recompute
+    std::sort(updatedTrajectories.begin(), updatedTrajectories.end());
+    updatedTrajectories.erase(std::unique(updatedTrajectories.begin(), updatedTrajectories.end()), updatedTrajectories.end());
+    associationStats.unmatchedTracks += activeCount - std::min(activeCount, updatedTrajectories.size());
+    for (EnemyTrajectory* trajectory : updatedTrajectories) {
+        if (!trajectory->isActive) continue;
+        
+        bool established = trajectory->history.Size() >= minPositionsForTrajectory;
+        cv::Point2f previousVelocity = trajectory->velocity;
+        
+        // The filter already carries velocity, so no history rescan is needed
+        if (motionModel == MotionModel::KALMAN) {
+            ApplyMotionEstimate(*trajectory);
+        } else if (established) {
+            CalculateMovementSpeed(*trajectory);
+            PredictNextPosition(*trajectory);
+        }
+        
+        if (established) {
+            trajectory->movementPattern = AnalyzeMovementPattern(*trajectory);
+            if (trajectory->history.Size() > minPositionsForTrajectory) {
+                velocityJitterTotal += cv::norm(trajectory->velocity - previousVelocity);
+                velocityJitterCount++;
+            }
         }
     }
+    
+    double updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - updateStart).count();
+    associationStats.framesProcessed++;
+    associationStats.detectionsProcessed += detections.size();
+    associationStats.peakUpdateMs = std::max(associationStats.peakUpdateMs, updateMs);
+    updateTotalMs += updateMs;
 }
 
 std::vector<EnemyTrajectory> PositionTracker::GetActiveTrajectories() const {
     std::vector<EnemyTrajectory> activeTrajectories;
     
-    for (const auto& [enemyId, trajectory] : enemyTrajectories) {
+    for (const auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        const EnemyTrajectory& trajectory = slot.trajectory;
         if (trajectory.isActive) {
             activeTrajectories.push_back(trajectory);
         }
@@ -89,56 +645,74 @@ std::vector<EnemyTrajectory> PositionTracker::GetActiveTrajectories() const {
 
 std::vector<EnemyTrajectory> PositionTracker::GetAllTrajectories() const {
     std::vector<EnemyTrajectory> allTrajectories;
+    allTrajectories.reserve(archive.GetRecordCount() + trajectoryCount);
     
-    for (const auto& [enemyId, trajectory] : enemyTrajectories) {
+    ForEachTrajectory([&allTrajectories](const EnemyTrajectory& trajectory) {
         allTrajectories.push_back(trajectory);
-    }
+    });
     
     return allTrajectories;
 }
 
+void PositionTracker::ForEachTrajectory(const std::function<void(const EnemyTrajectory&)>& visit) const {
+    // Archived trajectories are streamed from disk one at a time rather than held in memory
+    if (archive.GetRecordCount() > 0) {
+        TrajectoryArchive::ForEach(archive.GetFilename(), [&visit](const EnemyTrajectory& trajectory) {
+            visit(trajectory);
+            return true;
+        });
+    }
+    
+    for (const auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        const EnemyTrajectory& trajectory = slot.trajectory;
+        visit(trajectory);
+    }
+}
+
+const std::vector<TrackHandle>& PositionTracker::GetLastAssignedHandles() const {
+    return lastAssignedHandles;
+}
+
+const EnemyTrajectory* PositionTracker::GetTrajectory(TrackHandle handle) const {
+    if (handle.slot >= trackSlots.size()) {
+        return nullptr;
+    }
+    
+    const TrackSlot& slot = trackSlots[handle.slot];
+    return slot.occupied && slot.generation == handle.generation ? &slot.trajectory : nullptr;
+}
+
 EnemyTrajectory* PositionTracker::FindEnemyTrajectory(const cv::Point2f& position, double timestamp) {
-    EnemyTrajectory* closestTrajectory = nullptr;
-    double closestDistance = maxTrackingDistance;
+    candidateScratch.clear();
+    GatherCandidates(position, timestamp, candidateScratch);
     
-    for (auto& [enemyId, trajectory] : enemyTrajectories) {
-        if (!trajectory.isActive) continue;
-        
-        if (timestamp - trajectory.lastSeen > trajectoryTimeout) {
-            trajectory.isActive = false;
-            continue;
-        }
-        
-        for (const auto& pos : trajectory.positions) {
-            double distance = cv::norm(position - pos.position);
-            if (distance < closestDistance) {
-                closestDistance = distance;
-                closestTrajectory = &trajectory;
-            }
+    EnemyTrajectory* closestTrajectory = nullptr;
+    double closestDistance = ScaledDistance(maxTrackingDistance);
+    for (const auto& [trajectory, distance] : candidateScratch) {
+        if (distance < closestDistance) {
+            closestDistance = distance;
+            closestTrajectory = trajectory;
         }
     }
     
     return closestTrajectory;
 }
 
-std::string PositionTracker::AssignEnemyId(const cv::Point2f& position, double timestamp) {
-    std::ostringstream oss;
-    oss << "enemy_" << nextEnemyId++;
-    return oss.str();
+int PositionTracker::AssignEnemyId(const cv::Point2f& position, double timestamp) {
+    return nextEnemyId++;
 }
 
 void PositionTracker::UpdateTrajectory(EnemyTrajectory& trajectory, const EnemyPosition& position) {
-    trajectory.positions.push_back(position);
+    trajectory.history.Push(position.position, position.timestamp, static_cast<float>(position.confidence), position.isVisible);
+    RecordPosition(position);
     trajectory.lastSeen = position.timestamp;
+    if (motionModel == MotionModel::KALMAN) {
+        motionFilter.Update(trajectory.motion, position.position, position.timestamp);
+    }
     
-    double cutoffTime = position.timestamp - 10.0;
-    trajectory.positions.erase(
-        std::remove_if(trajectory.positions.begin(), trajectory.positions.end(),
-                      [cutoffTime](const EnemyPosition& pos) {
-                          return pos.timestamp < cutoffTime;
-                      }),
-        trajectory.positions.end()
-    );
+    // Samples arrive in time order, so expiry only ever advances the head
+    trajectory.history.ExpireBefore(position.timestamp - kHistorySeconds);
 }
 
 void PositionTracker::AnalyzeDeath(const cv::Point2f& deathPosition, double timestamp) {
@@ -150,7 +724,7 @@ void PositionTracker::AnalyzeDeath(const cv::Point2f& deathPosition, double time
     analysis.enemyWeapon = "unknown";
     analysis.enemyWasVisible = false;
     
-    analysis.nearbyEnemies = GetEnemiesNearPosition(deathPosition, deathAnalysisRadius, timestamp);
+    analysis.nearbyEnemies = GetEnemiesNearPosition(deathPosition, ScaledDistance(deathAnalysisRadius), timestamp);
     
     if (!analysis.nearbyEnemies.empty()) {
         double minDistance = std::numeric_limits<double>::max();
@@ -164,18 +738,20 @@ void PositionTracker::AnalyzeDeath(const cv::Point2f& deathPosition, double time
             }
         }
         
+        analysis.enemyPosition = closestEnemy.position;
         analysis.enemyDistance = minDistance;
         analysis.enemyWasVisible = closestEnemy.isVisible;
         
-        if (analysis.enemyWasVisible && analysis.enemyDistance < 100.0) {
+        if (analysis.enemyWasVisible && analysis.enemyDistance < ScaledDistance(100.0)) {
             analysis.deathCause = "enemy_shot";
             analysis.enemyWeapon = "unknown";
-        } else if (analysis.enemyDistance < 200.0) {
+        } else if (analysis.enemyDistance < ScaledDistance(200.0)) {
             analysis.deathCause = "enemy_shot_unseen";
         }
     }
     
     deathAnalyses.push_back(analysis);
+    heatmaps.AddDeath(analysis, displayGeometry);
     
     std::cout << "[PositionTracker] Death analyzed at " << timestamp << "s" << std::endl;
     std::cout << "[PositionTracker] Cause: " << analysis.deathCause << std::endl;
@@ -197,140 +773,197 @@ DeathAnalysis* PositionTracker::FindDeathAnalysis(double timestamp) {
 }
 
 void PositionTracker::CalculateMovementSpeed(EnemyTrajectory& trajectory) {
-    if (trajectory.positions.size() < 2) {
-        trajectory.movementSpeed = 0.0;
-        return;
-    }
-    
-    double totalDistance = 0.0;
-    double totalTime = 0.0;
-    
-    for (size_t i = 1; i < trajectory.positions.size(); ++i) {
-        const auto& prev = trajectory.positions[i - 1];
-        const auto& curr = trajectory.positions[i];
-        
-        double distance = cv::norm(curr.position - prev.position);
-        double timeDiff = curr.timestamp - prev.timestamp;
-        
-        if (timeDiff > 0) {
-            totalDistance += distance;
-            totalTime += timeDiff;
-        }
-    }
-    
-    trajectory.movementSpeed = totalTime > 0 ? totalDistance / totalTime : 0.0;
+    // Path length and duration are maintained by the history as samples come and go
+    double totalTime = trajectory.history.PathDuration();
+    trajectory.movementSpeed = totalTime > 0 ? trajectory.history.PathLength() / totalTime : 0.0;
 }
 
 void PositionTracker::PredictNextPosition(EnemyTrajectory& trajectory) {
-    if (trajectory.positions.size() < 2) {
-        trajectory.predictedNextPosition = trajectory.positions.empty() ? 
-            cv::Point2f(0, 0) : trajectory.positions.back().position;
+    const TrajectoryHistory& history = trajectory.history;
+    if (history.Size() < 2) {
+        trajectory.predictedNextPosition = history.Empty() ? 
+            cv::Point2f(0, 0) : history.Back();
+        trajectory.velocity = cv::Point2f(0, 0);
         return;
     }
     
-    const auto& lastPos = trajectory.positions.back();
-    const auto& secondLastPos = trajectory.positions[trajectory.positions.size() - 2];
-    
-    cv::Point2f velocity = lastPos.position - secondLastPos.position;
-    double timeDiff = lastPos.timestamp - secondLastPos.timestamp;
+    size_t last = history.Size() - 1;
+    cv::Point2f lastPosition = history.Position(last);
+    cv::Point2f velocity = lastPosition - history.Position(last - 1);
+    double timeDiff = history.Timestamp(last) - history.Timestamp(last - 1);
     
     if (timeDiff > 0) {
         velocity *= (1.0 / timeDiff);
-        trajectory.predictedNextPosition = lastPos.position + velocity * 0.1; 
+        trajectory.velocity = velocity;
+        trajectory.predictedNextPosition = lastPosition + velocity * frameInterval;
     } else {
-        trajectory.predictedNextPosition = lastPos.position;
+        trajectory.predictedNextPosition = lastPosition;
     }
 }
 
 std::string PositionTracker::AnalyzeMovementPattern(const EnemyTrajectory& trajectory) {
-    if (trajectory.positions.size() < minPositionsForTrajectory) {
+    if (trajectory.history.Size() < minPositionsForTrajectory) {
         return "insufficient_data";
     }
     
-    double totalVariance = 0.0;
-    cv::Point2f avgPosition(0, 0);
-    
-    for (const auto& pos : trajectory.positions) {
-        avgPosition += pos.position;
-    }
-    avgPosition *= (1.0 / trajectory.positions.size());
-    
-    for (const auto& pos : trajectory.positions) {
-        cv::Point2f diff = pos.position - avgPosition;
-        totalVariance += cv::norm(diff);
-    }
-    totalVariance /= trajectory.positions.size();
+    double totalVariance = trajectory.history.MeanDistanceFrom(trajectory.history.Centroid());
     
-    if (trajectory.movementSpeed < 5.0) {
+    if (trajectory.movementSpeed < ScaledDistance(5.0)) {
         return "stationary";
-    } else if (totalVariance < 20.0) {
+    } else if (totalVariance < ScaledDistance(20.0)) {
         return "moving_straight";
-    } else if (totalVariance > 50.0) {
+    } else if (totalVariance > ScaledDistance(50.0)) {
         return "erratic";
     } else {
         return "moving";
     }
 }
 
-bool PositionTracker::WasEnemyVisibleAtTime(const std::string& enemyId, double timestamp) {
-    auto it = enemyTrajectories.find(enemyId);
-    if (it == enemyTrajectories.end()) {
-        return false;
-    }
-    
-    const auto& trajectory = it->second;
-    
-    for (const auto& pos : trajectory.positions) {
-        if (std::abs(pos.timestamp - timestamp) < 0.5 && pos.isVisible) {
-            return true;
-        }
-    }
-    
-    return false;
+bool PositionTracker::WasEnemyVisibleAtTime(int trackId, double timestamp) {
+    // Archived trajectories are no longer in memory but their positions are still indexed
+    return positionIndex.WasVisible(trackId, timestamp, 0.5);
 }
 
 std::vector<EnemyPosition> PositionTracker::GetEnemiesNearPosition(const cv::Point2f& position, double radius, double timestamp) {
-    std::vector<EnemyPosition> nearbyEnemies;
+    std::vector<IndexedPosition> matches;
+    positionIndex.QueryRadius(position, radius, timestamp, 1.0, matches);
     
-    for (const auto& [enemyId, trajectory] : enemyTrajectories) {
-        for (const auto& pos : trajectory.positions) {
-            if (std::abs(pos.timestamp - timestamp) < 1.0) {
-                double distance = cv::norm(position - pos.position);
-                if (distance <= radius) {
-                    nearbyEnemies.push_back(pos);
-                }
-            }
-        }
+    std::vector<EnemyPosition> nearbyEnemies;
+    nearbyEnemies.reserve(matches.size());
+    for (const auto& match : matches) {
+        EnemyPosition pos;
+        pos.position = match.position;
+        pos.timestamp = match.timestamp;
+        pos.confidence = match.confidence;
+        pos.trackId = match.trackId;
+        pos.isVisible = match.isVisible;
+        nearbyEnemies.push_back(pos);
     }
     
     return nearbyEnemies;
 }
 
+const SpatioTemporalIndex& PositionTracker::GetPositionIndex() const {
+    return positionIndex;
+}
+
 void PositionTracker::CleanupOldTrajectories(double currentTimestamp) {
-    for (auto& [enemyId, trajectory] : enemyTrajectories) {
-        if (currentTimestamp - trajectory.lastSeen > trajectoryTimeout) {
+    for (auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        EnemyTrajectory& trajectory = slot.trajectory;
+        if (trajectory.isActive && currentTimestamp - trajectory.lastSeen > trajectoryTimeout) {
             trajectory.isActive = false;
+            RemoveFromGrid(trajectory);
+        }
+    }
+    
+    // A full match of positions runs to tens of megabytes, and death analysis
+    // only looks back a few seconds
+    if (indexRetention > 0.0) {
+        positionIndex.ExpireBefore(currentTimestamp - indexRetention);
+    }
+    
+    // Past the retention window a finished trajectory is only needed for reports,
+    // and without a session archive there is nowhere to report from
+    for (uint32_t index = 0; index < trackSlots.size(); index++) {
+        const TrackSlot& slot = trackSlots[index];
+        if (!slot.occupied || slot.trajectory.isActive ||
+            currentTimestamp - slot.trajectory.lastSeen <= trajectoryTimeout + finishedRetention) {
+            continue;
+        }
+        
+        if (archive.IsOpen()) {
+            // Kept in memory if the write fails so nothing is lost
+            if (!archive.Append(slot.trajectory)) {
+                break;
+            }
+        } else {
+            discardedCount++;
         }
+        FreeSlot(index);
     }
 }
 
 void PositionTracker::Reset() {
-    enemyTrajectories.clear();
+    trajectoryGrid.Clear();
+    lastAssignedHandles.clear();
+    positionIndex.Clear();
+    
+    // The previous session's archive stays on disk, but its trajectories are
+    // no longer this tracker's
+    archive.Reset();
+    trackSlots.clear();
+    freeSlots.clear();
+    slotTrackIndex.clear();
+    trajectoryCount = 0;
+    discardedCount = 0;
     deathAnalyses.clear();
+    heatmaps.Clear();
+    heatmaps.BeginSession();
     nextEnemyId = 1;
+    lastUpdateTime = -1.0;
+    frameInterval = kDefaultFrameInterval;
+}
+
+AssociationStats PositionTracker::GetAssociationStats() const {
+    AssociationStats stats = associationStats;
+    stats.averageUpdateMs = stats.framesProcessed > 0 ? updateTotalMs / stats.framesProcessed : 0.0;
+    stats.candidatesPerDetection = stats.detectionsProcessed > 0
+        ? static_cast<double>(stats.candidatesExamined) / stats.detectionsProcessed
+        : 0.0;
+    stats.averageInnovation = innovationCount > 0 ? innovationTotal / innovationCount : 0.0;
+    stats.velocityJitter = velocityJitterCount > 0 ? velocityJitterTotal / velocityJitterCount : 0.0;
+    return stats;
+}
+
+void PositionTracker::ResetAssociationStats() {
+    associationStats = AssociationStats();
+    updateTotalMs = 0.0;
+    innovationTotal = 0.0;
+    innovationCount = 0;
+    velocityJitterTotal = 0.0;
+    velocityJitterCount = 0;
+}
+
+void PositionTracker::PrintAssociationStats() const {
+    AssociationStats stats = GetAssociationStats();
+    
+    std::cout << "\n=== ASSOCIATION STATS ===" << std::endl;
+    size_t occupiedCells = 0;
+    trajectoryGrid.ForEach([&occupiedCells](int64_t, const std::vector<EnemyTrajectory*>& entries) {
+        if (!entries.empty()) occupiedCells++;
+    });
+    
+    std::cout << "Spatial Grid: " << (useSpatialGrid ? "YES" : "NO") << " (" << occupiedCells
+              << " occupied cells of " << gridCellSize << " px)" << std::endl;
+    std::cout << "Method: " << AssociationMethodToString(associationMethod) << std::endl;
+    std::cout << "Motion Model: " << MotionModelToString(motionModel) << std::endl;
+    std::cout << "Frames: " << stats.framesProcessed << std::endl;
+    std::cout << "Detections: " << stats.detectionsProcessed << std::endl;
+    std::cout << "Candidates per Detection: " << stats.candidatesPerDetection << std::endl;
+    std::cout << "Unmatched Detections: " << stats.unmatchedDetections << std::endl;
+    std::cout << "Unmatched Tracks: " << stats.unmatchedTracks << std::endl;
+    std::cout << "Assignment Groups: " << stats.componentsSolved << " (largest " << stats.largestComponent << ")" << std::endl;
+    std::cout << "Average Innovation: " << stats.averageInnovation << " px" << std::endl;
+    std::cout << "Velocity Jitter: " << stats.velocityJitter << " px/s" << std::endl;
+    std::cout << "Average Update: " << stats.averageUpdateMs << " ms" << std::endl;
+    std::cout << "Peak Update: " << stats.peakUpdateMs << " ms" << std::endl;
+    std::cout << std::endl;
 }
 
 void PositionTracker::PrintTrajectoryInfo() const {
     std::cout << "\n=== ENEMY TRAJECTORIES ===" << std::endl;
-    std::cout << "Total trajectories: " << enemyTrajectories.size() << std::endl;
+    std::cout << "Total trajectories: " << trajectoryCount << std::endl;
     
     int activeCount = 0;
-    for (const auto& [enemyId, trajectory] : enemyTrajectories) {
+    for (const auto& slot : trackSlots) {
+        if (!slot.occupied) continue;
+        const EnemyTrajectory& trajectory = slot.trajectory;
         if (trajectory.isActive) activeCount++;
         
-        std::cout << "Enemy " << enemyId << ":" << std::endl;
+        std::cout << "Enemy " << EnemyName(trajectory.trackId) << ":" << std::endl;
         std::cout << "  Active: " << (trajectory.isActive ? "YES" : "NO") << std::endl;
-        std::cout << "  Positions: " << trajectory.positions.size() << std::endl;
+        std::cout << "  Positions: " << trajectory.history.Size() << std::endl;
         std::cout << "  Movement Speed: " << trajectory.movementSpeed << " pixels/s" << std::endl;
         std::cout << "  Pattern: " << trajectory.movementPattern << std::endl;
         std::cout << "  First Seen: " << trajectory.firstSeen << "s" << std::endl;
@@ -338,6 +971,10 @@ void PositionTracker::PrintTrajectoryInfo() const {
     }
     
     std::cout << "Active trajectories: " << activeCount << std::endl;
+    if (archive.GetRecordCount() > 0) {
+        std::cout << "Archived trajectories: " << archive.GetRecordCount() << " (" << archive.GetBytesWritten() / 1024
+                  << " KB in " << archive.GetFilename() << ")" << std::endl;
+    }
     std::cout << std::endl;
 }
 
@@ -367,16 +1004,18 @@ void PositionTracker::SaveTrajectoryData(const std::string& filename) {
     
     file << "enemy_id,timestamp,x,y,confidence,is_visible\n";
     
-    for (const auto& [enemyId, trajectory] : enemyTrajectories) {
-        for (const auto& pos : trajectory.positions) {
-            file << enemyId << ","
-                 << pos.timestamp << ","
-                 << pos.position.x << ","
-                 << pos.position.y << ","
-                 << pos.confidence << ","
-                 << (pos.isVisible ? "true" : "false") << "\n";
+    ForEachTrajectory([&file](const EnemyTrajectory& trajectory) {
+        const TrajectoryHistory& history = trajectory.history;
+        for (size_t i = 0; i < history.Size(); ++i) {
+            cv::Point2f position = history.Position(i);
+            file << EnemyName(trajectory.trackId) << ","
+                 << history.Timestamp(i) << ","
+                 << position.x << ","
+                 << position.y << ","
+                 << history.Confidence(i) << ","
+                 << (history.IsVisible(i) ? "true" : "false") << "\n";
         }
-    }
+    });
     
     file.close();
     std::cout << "[PositionTracker] Saved trajectory data to " << filename << std::endl;
@@ -389,6 +1028,8 @@ void PositionTracker::LoadTrajectoryData(const std::string& filename) {
         return;
     }
     
+    // Names only appear in the file; trajectories are keyed by slot once loaded
+    std::unordered_map<std::string, uint32_t> loadedSlots;
     std::string line;
     std::getline(file, line);
     
@@ -404,23 +1045,36 @@ void PositionTracker::LoadTrajectoryData(const std::string& filename) {
             std::getline(iss, visibleStr)) {
             
             EnemyPosition pos;
-            pos.enemyId = enemyId;
             pos.timestamp = std::stod(timestampStr);
             pos.position.x = std::stof(xStr);
             pos.position.y = std::stof(yStr);
             pos.confidence = std::stod(confidenceStr);
             pos.isVisible = (visibleStr == "true");
             
-            if (enemyTrajectories.find(enemyId) == enemyTrajectories.end()) {
-                EnemyTrajectory trajectory;
-                trajectory.enemyId = enemyId;
+            auto loaded = loadedSlots.find(enemyId);
+            if (loaded == loadedSlots.end()) {
+                EnemyTrajectory& trajectory = AllocateSlot().trajectory;
+                trajectory.trackId = TrackIdFromName(enemyId);
+                if (trajectory.trackId <= 0) {
+                    trajectory.trackId = nextEnemyId;
+                }
+                // Live tracks must not reuse a loaded ID, the index would merge them
+                nextEnemyId = std::max(nextEnemyId, trajectory.trackId + 1);
                 trajectory.firstSeen = pos.timestamp;
                 trajectory.lastSeen = pos.timestamp;
                 trajectory.isActive = false;
-                enemyTrajectories[enemyId] = trajectory;
+                trajectory.motion.initialized = false;
+                trajectory.prediction.timestamp = -1.0;
+                loaded = loadedSlots.emplace(enemyId, trajectory.handle.slot).first;
             }
             
-            enemyTrajectories[enemyId].positions.push_back(pos);
+            EnemyTrajectory& trajectory = trackSlots[loaded->second].trajectory;
+            pos.trackId = trajectory.trackId;
+            trajectory.firstSeen = std::min(trajectory.firstSeen, pos.timestamp);
+            trajectory.lastSeen = std::max(trajectory.lastSeen, pos.timestamp);
+            // Queryable again, but already counted in the heatmap of the session that saved them
+            trajectory.history.Push(pos.position, pos.timestamp, static_cast<float>(pos.confidence), pos.isVisible);
+            IndexPosition(pos);
         }
     }
     
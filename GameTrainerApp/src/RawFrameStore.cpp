@@ -0,0 +1,452 @@
+#include "RawFrameStore.h"
+#include "RecordFile.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <cerrno>
+#endif
+
+namespace {
+const char kRawFrameMagic[4] = { 'G', 'T', 'R', 'W' };
+const char kRawIndexMagic[4] = { 'G', 'T', 'R', 'I' };
+const uint32_t kRawFrameVersion = 1;
+const uint64_t kIoAlignment = 4096;             // Covers 512e and 4Kn sectors for unbuffered I/O
+const size_t kTargetWriteBytes = 32 * 1024 * 1024;
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + kIoAlignment - 1) / kIoAlignment * kIoAlignment;
+}
+
+uint8_t* AllocateAligned(size_t bytes) {
+#ifdef _WIN32
+    return static_cast<uint8_t*>(_aligned_malloc(bytes, kIoAlignment));
+#else
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, kIoAlignment, bytes) != 0) {
+        return nullptr;
+    }
+    return static_cast<uint8_t*>(buffer);
+#endif
+}
+
+void FreeAligned(uint8_t* buffer) {
+#ifdef _WIN32
+    _aligned_free(buffer);
+#else
+    std::free(buffer);
+#endif
+}
+}
+
+RawFrameWriter::RawFrameWriter() 
+    :
+#ifdef _WIN32
+      fileHandle(nullptr),
+#else
+      fileDescriptor(-1),
+#endif
+      header(), stagingBuffer(nullptr), stagingSlots(0), stagedFrames(0), writeOffset(0), stats() {
+}
+
+RawFrameWriter::~RawFrameWriter() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool RawFrameWriter::OpenFile(const std::string& path, bool direct) {
+    DWORD flags = direct ? (FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN) : FILE_ATTRIBUTE_NORMAL;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    fileHandle = file;
+    return true;
+}
+
+bool RawFrameWriter::WriteAt(const uint8_t* buffer, size_t bytes, uint64_t offset) {
+    while (bytes > 0) {
+        OVERLAPPED position = OVERLAPPED();
+        position.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(fileHandle, buffer, chunk, &written, &position) || written == 0) {
+            return false;
+        }
+        buffer += written;
+        bytes -= written;
+        offset += written;
+    }
+    return true;
+}
+
+bool RawFrameWriter::Preallocate(uint64_t bytes) {
+    FILE_ALLOCATION_INFO allocation;
+    allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(bytes);
+    return SetFileInformationByHandle(fileHandle, FileAllocationInfo, &allocation, sizeof(allocation)) != 0;
+}
+
+void RawFrameWriter::TruncateTo(uint64_t bytes) {
+    FILE_END_OF_FILE_INFO endOfFile;
+    endOfFile.EndOfFile.QuadPart = static_cast<LONGLONG>(bytes);
+    SetFileInformationByHandle(fileHandle, FileEndOfFileInfo, &endOfFile, sizeof(endOfFile));
+}
+
+void RawFrameWriter::CloseFile() {
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+}
+
+bool RawFrameWriter::IsOpen() const {
+    return fileHandle != nullptr;
+}
+
+double RawFrameWriter::ThreadCpuSeconds() {
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    ULARGE_INTEGER kernelTime, userTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+    return (kernelTime.QuadPart + userTime.QuadPart) * 1e-7;
+}
+
+#else
+
+bool RawFrameWriter::OpenFile(const std::string& path, bool direct) {
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (direct) {
+        flags |= O_DIRECT;
+    }
+#else
+    if (direct) {
+        return false;
+    }
+#endif
+    fileDescriptor = open(path.c_str(), flags, 0644);
+    return fileDescriptor >= 0;
+}
+
+bool RawFrameWriter::WriteAt(const uint8_t* buffer, size_t bytes, uint64_t offset) {
+    while (bytes > 0) {
+        ssize_t written = pwrite(fileDescriptor, buffer, bytes, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        buffer += written;
+        bytes -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool RawFrameWriter::Preallocate(uint64_t bytes) {
+#ifdef __linux__
+    return posix_fallocate(fileDescriptor, 0, static_cast<off_t>(bytes)) == 0;
+#else
+    (void)bytes;
+    return false;
+#endif
+}
+
+void RawFrameWriter::TruncateTo(uint64_t bytes) {
+    if (ftruncate(fileDescriptor, static_cast<off_t>(bytes)) != 0) {
+        std::cerr << "[RawFrameWriter] Failed to trim preallocated space" << std::endl;
+    }
+}
+
+void RawFrameWriter::CloseFile() {
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+    fileDescriptor = -1;
+}
+
+bool RawFrameWriter::IsOpen() const {
+    return fileDescriptor >= 0;
+}
+
+double RawFrameWriter::ThreadCpuSeconds() {
+    timespec cpuTime;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime) != 0) {
+        return 0.0;
+    }
+    return cpuTime.tv_sec + cpuTime.tv_nsec * 1e-9;
+}
+
+#endif
+
+bool RawFrameWriter::Open(const std::string& path, cv::Size frameSize, int type, size_t preallocateFrames, bool directIo) {
+    Close();
+    writeOffset = 0;
+    
+    std::memcpy(header.magic, kRawFrameMagic, sizeof(header.magic));
+    header.version = kRawFrameVersion;
+    header.width = static_cast<uint32_t>(frameSize.width);
+    header.height = static_cast<uint32_t>(frameSize.height);
+    header.type = static_cast<uint32_t>(type);
+    header.rowBytes = static_cast<uint32_t>(frameSize.width * CV_ELEM_SIZE(type));
+    header.frameBytes = static_cast<uint64_t>(header.rowBytes) * header.height;
+    header.slotBytes = AlignUp(header.frameBytes);
+    header.dataOffset = AlignUp(sizeof(RawFrameHeader));
+    
+    // Unbuffered I/O is not supported everywhere (tmpfs, some network shares)
+    stats = RawFrameWriterStats();
+    stats.directIo = directIo && OpenFile(path, true);
+    if (!stats.directIo && !OpenFile(path, false)) {
+        std::cerr << "[RawFrameWriter] Failed to create " << path << std::endl;
+        return false;
+    }
+    
+    // Large writes amortize the per-call cost and keep the device queue full
+    stagingSlots = std::max<size_t>(1, kTargetWriteBytes / header.slotBytes);
+    stagingBuffer = AllocateAligned(stagingSlots * header.slotBytes);
+    if (!stagingBuffer) {
+        std::cerr << "[RawFrameWriter] Failed to allocate staging buffer" << std::endl;
+        CloseFile();
+        return false;
+    }
+    stagedFrames = 0;
+    stagedRecords.clear();
+    stagedRecords.reserve(stagingSlots);
+    
+    if (preallocateFrames > 0 && Preallocate(header.dataOffset + preallocateFrames * header.slotBytes)) {
+        stats.preallocatedFrames = preallocateFrames;
+    }
+    
+    std::memset(stagingBuffer, 0, header.dataOffset);
+    std::memcpy(stagingBuffer, &header, sizeof(header));
+    if (!WriteAt(stagingBuffer, header.dataOffset, 0)) {
+        std::cerr << "[RawFrameWriter] Failed to write header to " << path << std::endl;
+        Close();
+        return false;
+    }
+    writeOffset = header.dataOffset;
+    
+    indexFile.open(IndexFilenameFor(path), std::ios::binary | std::ios::trunc);
+    if (!indexFile.is_open()) {
+        std::cerr << "[RawFrameWriter] Failed to create frame index for " << path << std::endl;
+        Close();
+        return false;
+    }
+    
+    RawFrameIndexHeader indexHeader;
+    std::memcpy(indexHeader.magic, kRawIndexMagic, sizeof(indexHeader.magic));
+    indexHeader.version = kRawFrameVersion;
+    indexHeader.recordSize = sizeof(RawFrameIndexRecord);
+    indexHeader.reserved = 0;
+    indexFile.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+    
+    std::cout << "[RawFrameWriter] Writing " << frameSize.width << "x" << frameSize.height << " frames to " << path
+              << " (" << (stats.directIo ? "direct" : "buffered") << " I/O, "
+              << stagingSlots * header.slotBytes / (1024 * 1024) << " MB writes)" << std::endl;
+    return true;
+}
+
+bool RawFrameWriter::Append(const cv::Mat& frame, double timestamp) {
+    if (!IsOpen()) {
+        return false;
+    }
+    
+    if (frame.cols != static_cast<int>(header.width) || frame.rows != static_cast<int>(header.height) ||
+        frame.type() != static_cast<int>(header.type)) {
+        std::cerr << "[RawFrameWriter] Frame does not match the container format" << std::endl;
+        return false;
+    }
+    
+    uint8_t* slot = stagingBuffer + stagedFrames * header.slotBytes;
+    if (frame.isContinuous()) {
+        std::memcpy(slot, frame.data, header.frameBytes);
+    } else {
+        for (int y = 0; y < frame.rows; y++) {
+            std::memcpy(slot + static_cast<size_t>(y) * header.rowBytes, frame.ptr(y), header.rowBytes);
+        }
+    }
+    
+    RawFrameIndexRecord record;
+    record.offset = writeOffset + stagedFrames * header.slotBytes;
+    record.timestamp = timestamp;
+    record.frameNumber = static_cast<uint32_t>(stats.framesWritten + stagedFrames);
+    record.reserved = 0;
+    stagedRecords.push_back(record);
+    stagedFrames++;
+    
+    if (stagedFrames == stagingSlots) {
+        return Flush();
+    }
+    return true;
+}
+
+bool RawFrameWriter::Flush() {
+    if (stagedFrames == 0) {
+        return true;
+    }
+    
+    size_t bytes = stagedFrames * header.slotBytes;
+    auto writeStart = std::chrono::steady_clock::now();
+    bool written = WriteAt(stagingBuffer, bytes, writeOffset);
+    stats.writeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+    
+    if (!written) {
+        std::cerr << "[RawFrameWriter] Write failed, dropping " << stagedFrames << " frames" << std::endl;
+        stagedFrames = 0;
+        stagedRecords.clear();
+        return false;
+    }
+    
+    // Index only what has reached the file, so a crash never points past the data
+    indexFile.write(reinterpret_cast<const char*>(stagedRecords.data()),
+                    stagedRecords.size() * sizeof(RawFrameIndexRecord));
+    
+    writeOffset += bytes;
+    stats.framesWritten += stagedFrames;
+    stats.bytesWritten += bytes;
+    stats.writeCalls++;
+    stagedFrames = 0;
+    stagedRecords.clear();
+    return true;
+}
+
+void RawFrameWriter::Close() {
+    if (IsOpen()) {
+        Flush();
+        TruncateTo(writeOffset);
+        CloseFile();
+        
+        std::cout << "[RawFrameWriter] Closed after " << stats.framesWritten << " frames, "
+                  << GetStats().throughputGBps << " GB/s sustained" << std::endl;
+    }
+    if (indexFile.is_open()) {
+        indexFile.close();
+    }
+    if (stagingBuffer) {
+        FreeAligned(stagingBuffer);
+        stagingBuffer = nullptr;
+    }
+    stagedFrames = 0;
+    stagedRecords.clear();
+}
+
+size_t RawFrameWriter::GetStagedFrameCount() const {
+    return stagedFrames;
+}
+
+RawFrameWriterStats RawFrameWriter::GetStats() const {
+    RawFrameWriterStats current = stats;
+    current.throughputGBps = current.writeSeconds > 0.0 ? current.bytesWritten / current.writeSeconds / 1e9 : 0.0;
+    return current;
+}
+
+std::string RawFrameWriter::IndexFilenameFor(const std::string& rawFilename) {
+    return RecordReader::ReplaceExtension(rawFilename, ".gtidx");
+}
+
+RawFrameReader::RawFrameReader() 
+    : header() {
+}
+
+RawFrameReader::~RawFrameReader() {
+    Close();
+}
+
+bool RawFrameReader::Open(const std::string& path) {
+    Close();
+    
+    if (!data.Open(path) || data.Size() < sizeof(RawFrameHeader)) {
+        std::cerr << "[RawFrameReader] Failed to map " << path << std::endl;
+        Close();
+        return false;
+    }
+    
+    if (!RecordReader(data).ReadHeader(header, kRawFrameMagic, kRawFrameVersion) || header.slotBytes < header.frameBytes) {
+        std::cerr << "[RawFrameReader] Unsupported raw frame format: " << path << std::endl;
+        Close();
+        return false;
+    }
+    
+    MappedFile index;
+    std::string indexPath = RawFrameWriter::IndexFilenameFor(path);
+    if (!index.Open(indexPath) || index.Size() < sizeof(RawFrameIndexHeader)) {
+        std::cerr << "[RawFrameReader] Missing frame index " << indexPath << std::endl;
+        Close();
+        return false;
+    }
+    
+    RecordReader reader(index);
+    RawFrameIndexHeader indexHeader;
+    if (!reader.ReadHeader(indexHeader, kRawIndexMagic, kRawFrameVersion, sizeof(RawFrameIndexRecord))) {
+        std::cerr << "[RawFrameReader] Unsupported frame index format: " << indexPath << std::endl;
+        Close();
+        return false;
+    }
+    
+    // A record pointing past the data is as good as torn
+    records.reserve(reader.Remaining() / sizeof(RawFrameIndexRecord));
+    RawFrameIndexRecord record;
+    for (size_t i = 0; reader.Read(record); ++i) {
+        if (record.frameNumber != i || record.offset + header.frameBytes > data.Size()) {
+            break;
+        }
+        records.push_back(record);
+    }
+    
+    std::cout << "[RawFrameReader] Mapped " << records.size() << " frames of " << header.width << "x" << header.height
+              << " from " << path << std::endl;
+    return true;
+}
+
+void RawFrameReader::Close() {
+    data.Close();
+    records.clear();
+    header = RawFrameHeader();
+}
+
+bool RawFrameReader::IsOpen() const {
+    return data.IsOpen();
+}
+
+size_t RawFrameReader::GetFrameCount() const {
+    return records.size();
+}
+
+cv::Size RawFrameReader::GetFrameSize() const {
+    return cv::Size(static_cast<int>(header.width), static_cast<int>(header.height));
+}
+
+double RawFrameReader::GetTimestamp(size_t index) const {
+    return index < records.size() ? records[index].timestamp : 0.0;
+}
+
+cv::Mat RawFrameReader::GetFrame(size_t index) const {
+    if (index >= records.size()) {
+        return cv::Mat();
+    }
+    
+    // The mapping is read-only, callers must clone before drawing on the frame
+    uint8_t* pixels = const_cast<uint8_t*>(data.Data() + records[index].offset);
+    return cv::Mat(static_cast<int>(header.height), static_cast<int>(header.width), static_cast<int>(header.type),
+                   pixels, header.rowBytes);
+}
@@ -0,0 +1,37 @@
+#include "RecordFile.h"
+
+RecordReader::RecordReader(const MappedFile& file)
+    : data(file.Data()), size(file.Size()), offset(0) {
+}
+
+bool RecordReader::Fits(size_t bytes) const {
+    return bytes <= size - offset;
+}
+
+void RecordReader::Skip(size_t bytes) {
+    offset += Fits(bytes) ? bytes : size - offset;
+}
+
+size_t RecordReader::Remaining() const {
+    return size - offset;
+}
+
+const uint8_t* RecordReader::Current() const {
+    return data + offset;
+}
+
+uint64_t RecordReader::CompleteSize(uint64_t fileSize, size_t headerSize, size_t recordSize) {
+    if (fileSize < headerSize) {
+        return 0;
+    }
+    return headerSize + (fileSize - headerSize) / recordSize * recordSize;
+}
+
+std::string RecordReader::ReplaceExtension(const std::string& filename, const std::string& extension) {
+    size_t dot = filename.rfind('.');
+    size_t slash = filename.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return filename + extension;
+    }
+    return filename.substr(0, dot) + extension;
+}
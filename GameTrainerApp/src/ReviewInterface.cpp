@@ -1,9 +1,13 @@
 #include "ReviewInterface.h"
+#include "ClipIndex.h"
+#include "VideoRecorder.h"
 #include <iostream>
 #include <iomanip>
+#include <chrono>
+#include <filesystem>
 
 ReviewInterface::ReviewInterface() 
-    : currentClipIndex(-1), currentPlaybackTime(0.0), isPlaying(false) {
+    : currentClipIndex(-1), currentPlaybackTime(0.0), isPlaying(false), clipDirectory("./recordings/") {
 }
 
 ReviewInterface::~ReviewInterface() {
@@ -19,6 +23,10 @@ void ReviewInterface::LoadClips(const std::string& sessionId) {
     
     clips.clear();
     
+    if (LoadClipIndex(sessionId)) {
+        return;
+    }
+    
     GameplayClip clip1;
     clip1.clipId = sessionId + "_death_001";
     clip1.filename = "death_clip_001.mp4";
@@ -89,6 +97,50 @@ void ReviewInterface::LoadClips(const std::string& sessionId) {
     std::cout << "[ReviewInterface] Loaded " << clips.size() << " clips for session: " << sessionId << std::endl;
 }
 
+void ReviewInterface::SetClipDirectory(const std::string& path) {
+    clipDirectory = path;
+    if (!clipDirectory.empty() && clipDirectory.back() != '/') {
+        clipDirectory += "/";
+    }
+    std::cout << "[ReviewInterface] Clip directory set to " << clipDirectory << std::endl;
+}
+
+bool ReviewInterface::LoadClipIndex(const std::string& sessionId) {
+    auto loadStart = std::chrono::high_resolution_clock::now();
+    
+    std::vector<ClipIndexEntry> entries;
+    if (!ClipIndex::Load(sessionId + "_clips", entries) || entries.empty()) {
+        return false;
+    }
+    
+    clips.reserve(clips.size() + entries.size());
+    
+    for (const auto& entry : entries) {
+        GameplayClip clip;
+        clip.clipId = entry.clipId;
+        clip.filename = clipDirectory + entry.filename;
+        clip.duration = entry.endTime - entry.startTime;
+        clip.timestamp = entry.startTime;
+        
+        if (entry.playerDied) {
+            clip.description = "Death - " + entry.triggerReason;
+        } else if (entry.enemyKilled) {
+            clip.description = "Kill - " + entry.triggerReason;
+        } else {
+            clip.description = "Engagement - " + entry.triggerReason;
+        }
+        
+        clips.push_back(clip);
+    }
+    
+    double loadMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - loadStart).count();
+    
+    std::cout << "[ReviewInterface] Loaded " << entries.size() << " clips from index for session: " << sessionId
+              << " in " << loadMs << "ms" << std::endl;
+    return true;
+}
+
 void ReviewInterface::AddClip(const GameplayClip& clip) {
     clips.push_back(clip);
 }
@@ -107,7 +159,19 @@ void ReviewInterface::PlayClip(int clipIndex) {
     currentPlaybackTime = 0.0;
     isPlaying = true;
     
-    const GameplayClip& clip = clips[currentClipIndex];
+    GameplayClip& clip = clips[currentClipIndex];
+    
+    // Review only needs the proxy, so prefer it over the master when one was recorded
+    if (clip.proxyFilename.empty()) {
+        std::string proxy = VideoRecorder::ProxyFilenameFor(clip.filename);
+        if (std::filesystem::exists(proxy)) {
+            clip.proxyFilename = proxy;
+        }
+    }
+    
+    // Exact time to frame mapping when the recorder wrote capture timestamps
+    clipTimestamps.Load(FrameTimestampIndex::IndexFilenameFor(clip.filename));
+    
     concentrationTracker.StartReview(clip.clipId);
     gameplayAnalyzer.StartAnalysis(clip.clipId);
     
@@ -118,7 +182,11 @@ void ReviewInterface::PlayClip(int clipIndex) {
     std::cout << "\n=== PLAYING CLIP " << (clipIndex + 1) << " ===" << std::endl;
     std::cout << "Description: " << clip.description << std::endl;
     std::cout << "Duration: " << clip.duration << " seconds" << std::endl;
-    std::cout << "File: " << clip.filename << std::endl;
+    if (!clip.proxyFilename.empty()) {
+        std::cout << "File: " << clip.proxyFilename << " (proxy of " << clip.filename << ")" << std::endl;
+    } else {
+        std::cout << "File: " << clip.filename << std::endl;
+    }
     std::cout << "Shots in clip: " << clip.shots.size() << std::endl;
     std::cout << "\nControls:" << std::endl;
     std::cout << "  1 = Mark Low Focus at current time" << std::endl;
@@ -142,7 +210,13 @@ void ReviewInterface::PauseClip() {
 void ReviewInterface::SeekToTime(double timestamp) {
     if (currentClipIndex >= 0 && currentClipIndex < clips.size()) {
         currentPlaybackTime = timestamp;
-        std::cout << "[ReviewInterface] Seeked to " << timestamp << "s" << std::endl;
+        
+        if (clipTimestamps.IsLoaded()) {
+            int frame = clipTimestamps.FrameAtTime(clips[currentClipIndex].timestamp + timestamp);
+            std::cout << "[ReviewInterface] Seeked to " << timestamp << "s (frame " << frame << ")" << std::endl;
+        } else {
+            std::cout << "[ReviewInterface] Seeked to " << timestamp << "s" << std::endl;
+        }
     }
 }
 
@@ -0,0 +1,188 @@
+#include "SpatioTemporalIndex.h"
+#include "PositionTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const uint32_t kNoEntry = UINT32_MAX;
+
+int64_t CellKey(int64_t cellX, int64_t cellY) {
+    return (cellX << 32) ^ (cellY & 0xFFFFFFFFll);
+}
+}
+
+SpatioTemporalIndex::SpatioTemporalIndex(double bucketSeconds, double cellSize)
+    : bucketSeconds(std::max(0.01, bucketSeconds)), cellSize(std::max(1.0, cellSize)), entryCount(0),
+      lastBucketSize(0) {
+}
+
+int64_t SpatioTemporalIndex::BucketKey(double timestamp) const {
+    return static_cast<int64_t>(std::floor(timestamp / bucketSeconds));
+}
+
+int64_t SpatioTemporalIndex::CellCoordinate(float value) const {
+    return static_cast<int64_t>(std::floor(value / cellSize));
+}
+
+void SpatioTemporalIndex::Insert(const IndexedPosition& position) {
+    Bucket& bucket = buckets[BucketKey(position.timestamp)];
+    if (bucket.entries.empty()) {
+        // Consecutive buckets hold about the same number of positions, so size
+        // for the bucket filled just before this one
+        bucket.entries.reserve(lastBucketSize);
+        bucket.nextInCell.reserve(lastBucketSize);
+        bucket.nextInTrack.reserve(lastBucketSize);
+    }
+    
+    uint32_t entry = static_cast<uint32_t>(bucket.entries.size());
+    bucket.entries.push_back(position);
+    
+    int64_t cellKey = CellKey(CellCoordinate(position.position.x), CellCoordinate(position.position.y));
+    uint32_t* cellHead = bucket.cells.Find(cellKey);
+    bucket.nextInCell.push_back(cellHead ? *cellHead : kNoEntry);
+    if (cellHead) {
+        *cellHead = entry;
+    } else {
+        bucket.cells[cellKey] = entry;
+    }
+    
+    uint32_t* trackHead = bucket.tracks.Find(position.trackId);
+    bucket.nextInTrack.push_back(trackHead ? *trackHead : kNoEntry);
+    if (trackHead) {
+        *trackHead = entry;
+    } else {
+        bucket.tracks[position.trackId] = entry;
+    }
+    
+    lastBucketSize = bucket.entries.size();
+    entryCount++;
+}
+
+void SpatioTemporalIndex::InsertHistory(int trackId, const TrajectoryHistory& history) {
+    for (size_t i = 0; i < history.Size(); i++) {
+        IndexedPosition position;
+        position.position = history.Position(i);
+        position.timestamp = history.Timestamp(i);
+        position.confidence = history.Confidence(i);
+        position.trackId = trackId;
+        position.isVisible = history.IsVisible(i);
+        Insert(position);
+    }
+}
+
+bool SpatioTemporalIndex::InsertArchive(const std::string& path) {
+    return TrajectoryArchive::ForEach(path, [this](const EnemyTrajectory& trajectory) {
+        InsertHistory(trajectory.trackId, trajectory.history);
+        return true;
+    });
+}
+
+void SpatioTemporalIndex::ExpireBefore(double timestamp) {
+    // Only whole buckets are dropped, so a few older positions may survive
+    auto end = buckets.lower_bound(BucketKey(timestamp));
+    for (auto it = buckets.begin(); it != end; ++it) {
+        entryCount -= it->second.entries.size();
+    }
+    buckets.erase(buckets.begin(), end);
+}
+
+void SpatioTemporalIndex::Clear() {
+    buckets.clear();
+    entryCount = 0;
+    lastBucketSize = 0;
+}
+
+size_t SpatioTemporalIndex::QueryRadius(const cv::Point2f& center, double radius, double timestamp, double window,
+                                        std::vector<IndexedPosition>& results) const {
+    size_t found = 0;
+    double radiusSquared = radius * radius;
+    int64_t minCellX = CellCoordinate(static_cast<float>(center.x - radius));
+    int64_t maxCellX = CellCoordinate(static_cast<float>(center.x + radius));
+    int64_t minCellY = CellCoordinate(static_cast<float>(center.y - radius));
+    int64_t maxCellY = CellCoordinate(static_cast<float>(center.y + radius));
+    size_t cellsSpanned = static_cast<size_t>((maxCellX - minCellX + 1) * (maxCellY - minCellY + 1));
+
+    auto test = [&](const IndexedPosition& entry) {
+        if (std::abs(entry.timestamp - timestamp) >= window) return;
+        double dx = entry.position.x - center.x;
+        double dy = entry.position.y - center.y;
+        if (dx * dx + dy * dy <= radiusSquared) {
+            results.push_back(entry);
+            found++;
+        }
+    };
+
+    auto end = buckets.upper_bound(BucketKey(timestamp + window));
+    for (auto it = buckets.lower_bound(BucketKey(timestamp - window)); it != end; ++it) {
+        const Bucket& bucket = it->second;
+
+        // A radius wider than the occupied area is cheaper to answer by scanning
+        if (cellsSpanned >= bucket.cells.Size()) {
+            for (const auto& entry : bucket.entries) {
+                test(entry);
+            }
+            continue;
+        }
+
+        for (int64_t cellY = minCellY; cellY <= maxCellY; cellY++) {
+            for (int64_t cellX = minCellX; cellX <= maxCellX; cellX++) {
+                const uint32_t* cellHead = bucket.cells.Find(CellKey(cellX, cellY));
+                for (uint32_t entry = cellHead ? *cellHead : kNoEntry; entry != kNoEntry; entry = bucket.nextInCell[entry]) {
+                    test(bucket.entries[entry]);
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+size_t SpatioTemporalIndex::QueryTimeRange(double start, double end, std::vector<IndexedPosition>& results) const {
+    size_t found = 0;
+    auto last = buckets.upper_bound(BucketKey(end));
+    for (auto it = buckets.lower_bound(BucketKey(start)); it != last; ++it) {
+        for (const auto& entry : it->second.entries) {
+            if (entry.timestamp >= start && entry.timestamp < end) {
+                results.push_back(entry);
+                found++;
+            }
+        }
+    }
+    return found;
+}
+
+bool SpatioTemporalIndex::WasVisible(int trackId, double timestamp, double window) const {
+    auto end = buckets.upper_bound(BucketKey(timestamp + window));
+    for (auto it = buckets.lower_bound(BucketKey(timestamp - window)); it != end; ++it) {
+        const Bucket& bucket = it->second;
+        const uint32_t* trackHead = bucket.tracks.Find(trackId);
+        for (uint32_t entry = trackHead ? *trackHead : kNoEntry; entry != kNoEntry; entry = bucket.nextInTrack[entry]) {
+            const IndexedPosition& position = bucket.entries[entry];
+            if (position.isVisible && std::abs(position.timestamp - timestamp) < window) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t SpatioTemporalIndex::Size() const {
+    return entryCount;
+}
+
+size_t SpatioTemporalIndex::BucketCount() const {
+    return buckets.size();
+}
+
+size_t SpatioTemporalIndex::MemoryBytes() const {
+    // Approximate: the map node overhead depends on the standard library
+    size_t bytes = sizeof(SpatioTemporalIndex);
+    for (const auto& [key, bucket] : buckets) {
+        bytes += sizeof(key) + sizeof(Bucket) + 3 * sizeof(void*);
+        bytes += bucket.entries.capacity() * sizeof(IndexedPosition);
+        bytes += (bucket.nextInCell.capacity() + bucket.nextInTrack.capacity()) * sizeof(uint32_t);
+        bytes += bucket.cells.Capacity() * (sizeof(int64_t) + sizeof(uint32_t) + 1);
+        bytes += bucket.tracks.Capacity() * (sizeof(int) + sizeof(uint32_t) + 1);
+    }
+    return bytes;
+}
@@ -0,0 +1,627 @@
+#include "SyntheticChecks.h"
+#include "CombatAnalyzer.h"
+#include "HudEventDetector.h"
+#include "VideoRecorder.h"
+#include "FrameTimestampIndex.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+const char* const kOutputDirectory = "./recordings/synthetic_checks/";
+const int kHudReferenceHeight = 720;
+const double kHudFrameSpacing = 10.0;      // Longer than any region cooldown
+const cv::Size kClipFrameSize(320, 180);
+const double kClipFps = 30.0;
+const double kClipSaveTimeout = 10.0;
+const double kIntensityTolerance = 0.01;    // Rendered boxes round to whole pixels
+const int kInvarianceFrames = 6;
+const int kAlignmentTicks = 300;
+const int kAlignmentEvents = 200;
+const double kAlignmentJitter = 0.4;        // Fraction of a frame interval either way
+const double kAlignmentDropRate = 0.08;
+const int kFrameIdBits = 12;
+const int kBackpressureFrames = 90;
+const size_t kBackpressureQueue = 8;
+const double kBackpressureThrottleMs = 15.0;   // Several capture intervals of the replayed source
+
+struct SceneEnemy {
+    cv::Point2f center;     // Normalized
+    cv::Size2f size;        // Normalized to frame height
+};
+
+// On the crosshair, spread around it, and out past the proximity radius
+const std::vector<std::vector<SceneEnemy>> kIntensityScenes = {
+    { { cv::Point2f(0.5f, 0.5f), cv::Size2f(0.08f, 0.16f) } },
+    { { cv::Point2f(0.42f, 0.46f), cv::Size2f(0.06f, 0.12f) }, { cv::Point2f(0.66f, 0.6f), cv::Size2f(0.04f, 0.09f) } },
+    { { cv::Point2f(0.05f, 0.1f), cv::Size2f(0.04f, 0.08f) }, { cv::Point2f(0.9f, 0.85f), cv::Size2f(0.04f, 0.08f) },
+      { cv::Point2f(0.55f, 0.3f), cv::Size2f(0.05f, 0.1f) } }
+};
+
+struct ResolutionOutcome {
+    size_t detections = 0;
+    size_t tracks = 0;
+    double intensity = 0.0;
+    bool combatActive = false;
+    bool nearCrosshair = false;
+};
+
+// Enemy i is marked by its red channel and a zero green channel, which the
+// background never has; blue alternates in four bands so the body has contrast
+int SceneMarker(size_t enemyIndex) {
+    return 160 + 30 * static_cast<int>(enemyIndex);
+}
+
+void DrawScene(cv::Mat& frame, const DisplayGeometry& geometry, const std::vector<SceneEnemy>& scene) {
+    for (size_t i = 0; i < scene.size(); ++i) {
+        cv::Point2f center = geometry.ToPixels(scene[i].center);
+        int width = static_cast<int>(geometry.LengthToPixels(scene[i].size.width));
+        int height = static_cast<int>(geometry.LengthToPixels(scene[i].size.height));
+        cv::Rect body(static_cast<int>(center.x) - width / 2, static_cast<int>(center.y) - height / 2, width, height);
+        
+        for (int band = 0; band < 4; ++band) {
+            int top = body.y + body.height * band / 4;
+            int bottom = body.y + body.height * (band + 1) / 4;
+            cv::rectangle(frame, cv::Rect(body.x, top, body.width, bottom - top),
+                          cv::Scalar(band % 2 ? 255 : 0, 0, SceneMarker(i)), cv::FILLED);
+        }
+    }
+}
+
+// Stands in for a trained model: finds each marked body, then scores and
+// classifies it with the detector's own per-region rules
+std::vector<EnemyDetection> FindSceneEnemies(const cv::Mat& frame, EnemyDetector& detector, size_t enemyCount) {
+    std::vector<EnemyDetection> detections;
+    for (size_t i = 0; i < enemyCount; ++i) {
+        cv::Mat mask;
+        cv::inRange(frame, cv::Scalar(0, 0, SceneMarker(i)), cv::Scalar(255, 0, SceneMarker(i)), mask);
+        cv::Mat points;
+        cv::findNonZero(mask, points);
+        if (points.empty()) continue;
+        
+        EnemyDetection detection;
+        detection.boundingBox = cv::boundingRect(points);
+        detection.center = cv::Point2f(detection.boundingBox.x + detection.boundingBox.width / 2.0f,
+                                       detection.boundingBox.y + detection.boundingBox.height / 2.0f);
+        detection.confidence = detector.CalculateDetectionConfidence(frame(detection.boundingBox));
+        detection.enemyType = detector.ClassifyEnemyType(frame(detection.boundingBox));
+        detection.timestamp = 0.0;
+        detections.push_back(detection);
+    }
+    return detections;
+}
+
+struct HudFixture {
+    std::string region;
+    HudEventType type;
+    std::string text;
+    cv::Size size;          // At the reference height
+    double fontScale;
+};
+
+const HudFixture kHudFixtures[] = {
+    { "kill_feed", HudEventType::ENEMY_KILLED, "KILLED", cv::Size(110, 24), 0.6 },
+    { "death_banner", HudEventType::PLAYER_DIED, "ELIMINATED", cv::Size(220, 40), 1.0 },
+    { "spectator_label", HudEventType::SPECTATING, "SPECTATING", cv::Size(190, 32), 0.8 }
+};
+
+cv::Mat MakeHudTemplate(const HudFixture& fixture) {
+    cv::Mat image(fixture.size, CV_8UC1, cv::Scalar(0));
+    cv::putText(image, fixture.text, cv::Point(4, fixture.size.height - 8), cv::FONT_HERSHEY_SIMPLEX,
+                fixture.fontScale, cv::Scalar(255), 2, cv::LINE_AA);
+    return image;
+}
+
+// Scales the template with the frame, as the game's HUD would, and centers it in its region
+bool FindRegionArea(const std::vector<HudRegion>& regions, const std::string& name, cv::Rect2f& area) {
+    for (const auto& region : regions) {
+        if (region.name == name) {
+            area = region.area;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Centered in the detector's region, so the fixtures follow the region table
+void DrawHudElement(cv::Mat& frame, const cv::Rect2f& area, const cv::Mat& hudTemplate) {
+    double scale = static_cast<double>(frame.rows) / kHudReferenceHeight;
+    cv::Mat scaled;
+    cv::resize(hudTemplate, scaled, cv::Size(static_cast<int>(hudTemplate.cols * scale), static_cast<int>(hudTemplate.rows * scale)),
+               0, 0, cv::INTER_AREA);
+    cv::Mat colored;
+    cv::cvtColor(scaled, colored, cv::COLOR_GRAY2BGR);
+    
+    int centerX = static_cast<int>((area.x + area.width / 2) * frame.cols);
+    int centerY = static_cast<int>((area.y + area.height / 2) * frame.rows);
+    cv::Mat target = frame(cv::Rect(centerX - colored.cols / 2, centerY - colored.rows / 2, colored.cols, colored.rows));
+    colored.copyTo(target);
+}
+
+// Capture tick number as a row of black and white blocks, coarse enough to survive MJPG
+void DrawFrameId(cv::Mat& frame, int id) {
+    int blockWidth = frame.cols / kFrameIdBits;
+    for (int bit = 0; bit < kFrameIdBits; ++bit) {
+        cv::Scalar color = (id >> bit) & 1 ? cv::Scalar(255, 255, 255) : cv::Scalar(0, 0, 0);
+        cv::rectangle(frame, cv::Rect(bit * blockWidth, 0, blockWidth, frame.rows / 4), color, cv::FILLED);
+    }
+}
+
+int ReadFrameId(const cv::Mat& frame) {
+    int blockWidth = frame.cols / kFrameIdBits;
+    int id = 0;
+    for (int bit = 0; bit < kFrameIdBits; ++bit) {
+        cv::Scalar mean = cv::mean(frame(cv::Rect(bit * blockWidth + blockWidth / 4, frame.rows / 16, blockWidth / 2, frame.rows / 8)));
+        if (mean[0] > 128.0) {
+            id |= 1 << bit;
+        }
+    }
+    return id;
+}
+}
+
+SyntheticChecks::SyntheticChecks() : seed(1234) {
+}
+
+SyntheticChecks::~SyntheticChecks() {
+}
+
+void SyntheticChecks::SetSeed(unsigned int value) {
+    seed = value;
+}
+
+cv::Mat SyntheticChecks::MakeBackground(const cv::Size& size, unsigned int frameSeed) const {
+    cv::Mat frame(size, CV_8UC3);
+    cv::RNG rng(seed ^ frameSeed);
+    rng.fill(frame, cv::RNG::UNIFORM, 20, 90);
+    return frame;
+}
+
+std::vector<SyntheticCheckResult> SyntheticChecks::Run() const {
+    std::vector<SyntheticCheckResult> results;
+    results.push_back(CheckHudEvents());
+    results.push_back(CheckClipBoundaries());
+    results.push_back(CheckTimestampAlignment());
+    results.push_back(CheckEncoderBackpressure());
+    results.push_back(CheckResolutionInvariance());
+    return results;
+}
+
+SyntheticCheckResult SyntheticChecks::CheckHudEvents() const {
+    SyntheticCheckResult result;
+    result.name = "HUD events";
+    result.passed = true;
+    
+    // Each case shows a subset of the fixtures: none, each alone, then kill and death together
+    const std::vector<std::vector<int>> cases = { {}, { 0 }, { 1 }, { 2 }, { 0, 1 } };
+    const cv::Size resolutions[] = { cv::Size(1280, 720), cv::Size(1920, 1080) };
+    
+    std::vector<cv::Mat> templates;
+    for (const auto& fixture : kHudFixtures) {
+        templates.push_back(MakeHudTemplate(fixture));
+    }
+    
+    std::ostringstream detail;
+    double totalMs = 0.0;
+    int frameCount = 0;
+    
+    for (const auto& resolution : resolutions) {
+        HudEventDetector detector;
+        detector.LoadDefaultRegions();
+        
+        // The combat analyzer's death rule has to agree with the events the detector emits.
+        // Initialize would read gauge regions from the working directory; with none the
+        // rule rests on the HUD events alone.
+        CombatAnalyzer analyzer;
+        analyzer.GetHudEventDetector().LoadDefaultRegions();
+        
+        std::vector<HudRegion> regions = detector.GetRegions();
+        std::vector<cv::Rect2f> areas(templates.size());
+        for (size_t i = 0; i < templates.size(); ++i) {
+            if (!FindRegionArea(regions, kHudFixtures[i].region, areas[i])) {
+                result.passed = false;
+                result.detail = "No HUD region named " + kHudFixtures[i].region;
+                return result;
+            }
+            detector.AddTemplate(kHudFixtures[i].region, templates[i], kHudReferenceHeight);
+            analyzer.GetHudEventDetector().AddTemplate(kHudFixtures[i].region, templates[i], kHudReferenceHeight);
+        }
+        
+        for (size_t c = 0; c < cases.size(); ++c) {
+            cv::Mat frame = MakeBackground(resolution, static_cast<unsigned int>(c));
+            for (int fixtureIndex : cases[c]) {
+                DrawHudElement(frame, areas[fixtureIndex], templates[fixtureIndex]);
+            }
+            
+            double timestamp = c * kHudFrameSpacing;
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<HudEvent> events = detector.ProcessFrame(frame, timestamp);
+            totalMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            frameCount++;
+            
+            bool expectedDeath = false;
+            bool matched = events.size() == cases[c].size();
+            for (int fixtureIndex : cases[c]) {
+                HudEventType type = kHudFixtures[fixtureIndex].type;
+                expectedDeath = expectedDeath || HudEventDetector::IsDeathEvent(type);
+                bool found = false;
+                for (const auto& event : events) {
+                    found = found || event.type == type;
+                }
+                matched = matched && found;
+            }
+            
+            bool detectedDeath = analyzer.DetectPlayerDeath(frame);
+            
+            if (result.passed && (!matched || detectedDeath != expectedDeath)) {
+                result.passed = false;
+                detail << resolution.height << "p case " << c << ": " << events.size() << " events for "
+                       << cases[c].size() << " HUD elements, death " << (detectedDeath ? "detected" : "not detected")
+                       << " (expected " << (expectedDeath ? "yes" : "no") << "); ";
+            }
+        }
+    }
+    
+    detail << std::fixed << std::setprecision(3) << (frameCount > 0 ? totalMs / frameCount : 0.0) << "ms/frame over "
+           << frameCount << " frames";
+    result.detail = detail.str();
+    return result;
+}
+
+SyntheticCheckResult SyntheticChecks::CheckClipBoundaries() const {
+    SyntheticCheckResult result;
+    result.name = "Clip boundaries";
+    result.passed = false;
+    
+    const double preRoll = 2.0;
+    const double postRoll = 1.0;
+    const int triggerFrame = 150;
+    const int stopFrame = 240;
+    const int lastFrame = 330;
+    
+    VideoRecorder recorder;
+    recorder.SetOutputPath(kOutputDirectory);
+    recorder.SetCodec(cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), cv::CAP_ANY, ".avi");
+    recorder.Initialize(kClipFrameSize.width, kClipFrameSize.height, kClipFps);
+    recorder.StartBuffering();
+    
+    CombatAnalyzer analyzer;
+    analyzer.SetClipPreRoll(preRoll);
+    analyzer.SetClipPostRoll(postRoll);
+    analyzer.SetVideoRecorder(&recorder);
+    analyzer.SetSessionId(std::string(kOutputDirectory) + "clip_boundaries");
+    
+    CombatClip clip;
+    for (int i = 0; i <= lastFrame; ++i) {
+        double timestamp = i / kClipFps;
+        recorder.AddFrame(MakeBackground(kClipFrameSize, static_cast<unsigned int>(i)), timestamp);
+        
+        if (i == triggerFrame) {
+            clip = analyzer.StartRecording("synthetic", timestamp);
+        } else if (i == stopFrame) {
+            analyzer.StopRecording(clip, timestamp);
+        }
+    }
+    analyzer.EndSession();
+    
+    auto waitStart = std::chrono::steady_clock::now();
+    while (recorder.GetSavedClipCount() == 0 &&
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count() < kClipSaveTimeout) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    // Frames are selected by timestamp with the same arithmetic the recorder uses
+    size_t expectedFrames = 0;
+    double expectedFirst = -1.0;
+    double expectedLast = -1.0;
+    for (int i = 0; i <= lastFrame; ++i) {
+        double timestamp = i / kClipFps;
+        if (timestamp >= clip.startTime && timestamp <= clip.endTime) {
+            expectedFrames++;
+            if (expectedFirst < 0.0) expectedFirst = timestamp;
+            expectedLast = timestamp;
+        }
+    }
+    
+    std::string clipPath = std::string(kOutputDirectory) + clip.filename;
+    FrameTimestampIndex clipTimestamps;
+    cv::VideoCapture capture(clipPath);
+    int videoFrames = capture.isOpened() ? static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT)) : -1;
+    
+    std::ostringstream detail;
+    double triggerTime = triggerFrame / kClipFps;
+    double stopTime = stopFrame / kClipFps;
+    
+    if (recorder.GetSavedClipCount() != 1) {
+        detail << "clip not saved within " << kClipSaveTimeout << "s";
+    } else if (clip.startTime != triggerTime - preRoll || clip.endTime != stopTime + postRoll) {
+        detail << "clip spans " << clip.startTime << "s - " << clip.endTime << "s, expected "
+               << (triggerTime - preRoll) << "s - " << (stopTime + postRoll) << "s";
+    } else if (!clipTimestamps.Load(FrameTimestampIndex::IndexFilenameFor(clipPath))) {
+        detail << "no timestamp index next to " << clipPath;
+    } else if (clipTimestamps.GetFrameCount() != expectedFrames || videoFrames != static_cast<int>(expectedFrames)) {
+        detail << clipTimestamps.GetFrameCount() << " indexed and " << videoFrames << " encoded frames, expected " << expectedFrames;
+    } else if (clipTimestamps.GetStartTime() != expectedFirst || clipTimestamps.GetEndTime() != expectedLast) {
+        detail << "frames span " << clipTimestamps.GetStartTime() << "s - " << clipTimestamps.GetEndTime()
+               << "s, expected " << expectedFirst << "s - " << expectedLast << "s";
+    } else {
+        result.passed = true;
+        detail << expectedFrames << " frames, " << expectedFirst << "s - " << expectedLast << "s";
+    }
+    
+    result.detail = detail.str();
+    return result;
+}
+
+SyntheticCheckResult SyntheticChecks::CheckTimestampAlignment() const {
+    SyntheticCheckResult result;
+    result.name = "Timestamp alignment";
+    result.passed = false;
+    
+    // Capture ticks land up to kAlignmentJitter of an interval off the nominal
+    // time, some are dropped outright, and one drop is a burst of five
+    cv::RNG rng(seed);
+    std::vector<double> tickTimes;
+    std::vector<int> writtenTicks;
+    for (int tick = 0; tick < kAlignmentTicks; ++tick) {
+        tickTimes.push_back((tick + rng.uniform(-kAlignmentJitter, kAlignmentJitter)) / kClipFps);
+        bool burst = tick >= kAlignmentTicks / 2 && tick < kAlignmentTicks / 2 + 5;
+        if (tick == 0 || (!burst && rng.uniform(0.0, 1.0) >= kAlignmentDropRate)) {
+            writtenTicks.push_back(tick);
+        }
+    }
+    
+    VideoRecorder recorder;
+    recorder.SetOutputPath(kOutputDirectory);
+    recorder.SetCodec(cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), cv::CAP_ANY, ".avi");
+    recorder.SetBackpressurePolicy(BackpressurePolicy::BLOCK);
+    recorder.Initialize(kClipFrameSize.width, kClipFrameSize.height, kClipFps);
+    
+    std::ostringstream detail;
+    if (!recorder.StartRecording("timestamp_alignment.avi")) {
+        detail << "could not start recording";
+        result.detail = detail.str();
+        return result;
+    }
+    for (int tick : writtenTicks) {
+        cv::Mat frame = MakeBackground(kClipFrameSize, static_cast<unsigned int>(tick));
+        DrawFrameId(frame, tick);
+        recorder.AddFrame(frame, tickTimes[tick]);
+    }
+    recorder.StopRecording();
+    
+    std::string videoPath = std::string(kOutputDirectory) + "timestamp_alignment.avi";
+    FrameTimestampIndex timestamps;
+    std::vector<int> decodedTicks;
+    cv::VideoCapture capture(videoPath);
+    cv::Mat decoded;
+    while (capture.read(decoded)) {
+        decodedTicks.push_back(ReadFrameId(decoded));
+    }
+    
+    if (!timestamps.Load(FrameTimestampIndex::IndexFilenameFor(videoPath))) {
+        detail << "no timestamp index next to " << videoPath;
+    } else if (timestamps.GetFrameCount() != writtenTicks.size() || decodedTicks.size() != writtenTicks.size()) {
+        detail << timestamps.GetFrameCount() << " indexed and " << decodedTicks.size() << " decoded frames, expected "
+               << writtenTicks.size();
+    } else {
+        // An input event should land on the last frame captured at or before it.
+        // Position errors are measured in written frames, via the tick each
+        // decoded frame carries, against both the index and constant-fps playback.
+        std::vector<int> positionOfTick(kAlignmentTicks, -1);
+        for (size_t i = 0; i < writtenTicks.size(); ++i) {
+            positionOfTick[writtenTicks[i]] = static_cast<int>(i);
+        }
+        
+        int maxIndexError = 0;
+        int maxConstantFpsError = 0;
+        double firstTime = tickTimes[writtenTicks.front()];
+        double lastTime = tickTimes[writtenTicks.back()];
+        for (int e = 0; e < kAlignmentEvents; ++e) {
+            double eventTime = rng.uniform(firstTime, lastTime);
+            
+            int expected = 0;
+            while (expected + 1 < static_cast<int>(writtenTicks.size()) && tickTimes[writtenTicks[expected + 1]] <= eventTime) {
+                expected++;
+            }
+            
+            int mappedTick = decodedTicks[timestamps.FrameAtTime(eventTime)];
+            int mapped = mappedTick < kAlignmentTicks ? positionOfTick[mappedTick] : -1;
+            if (mapped < 0) {
+                detail << "frame at " << eventTime << "s carries unknown tick " << mappedTick;
+                result.detail = detail.str();
+                return result;
+            }
+            
+            int constantFpsFrame = std::min(static_cast<int>((eventTime - firstTime) * kClipFps), static_cast<int>(writtenTicks.size()) - 1);
+            maxIndexError = std::max(maxIndexError, std::abs(mapped - expected));
+            maxConstantFpsError = std::max(maxConstantFpsError, std::abs(constantFpsFrame - expected));
+        }
+        
+        result.passed = maxIndexError <= 1;
+        detail << kAlignmentEvents << " events over " << writtenTicks.size() << "/" << kAlignmentTicks
+               << " frames, max error " << maxIndexError << " frames (constant fps " << maxConstantFpsError << ")";
+    }
+    
+    result.detail = detail.str();
+    return result;
+}
+
+SyntheticCheckResult SyntheticChecks::CheckEncoderBackpressure() const {
+    SyntheticCheckResult result;
+    result.name = "Encoder backpressure";
+    result.passed = true;
+    
+    const int mjpg = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    std::string sourcePath = std::string(kOutputDirectory) + "backpressure_source.avi";
+    std::ostringstream detail;
+    
+    // The source is written and read back through OpenCV's software codecs, as a recording would be replayed
+    {
+        cv::VideoWriter source(sourcePath, cv::CAP_ANY, mjpg, kClipFps, kClipFrameSize);
+        if (!source.isOpened()) {
+            result.passed = false;
+            result.detail = "could not write " + sourcePath;
+            return result;
+        }
+        for (int i = 0; i < kBackpressureFrames; ++i) {
+            source.write(MakeBackground(kClipFrameSize, static_cast<unsigned int>(i)));
+        }
+    }
+    
+    const BackpressurePolicy policies[] = { BackpressurePolicy::BLOCK, BackpressurePolicy::DROP_OLDEST,
+                                            BackpressurePolicy::DROP_NEWEST, BackpressurePolicy::DEGRADE_RESOLUTION };
+    for (BackpressurePolicy policy : policies) {
+        std::string name = BackpressurePolicyToString(policy);
+        
+        VideoRecorder recorder;
+        recorder.SetOutputPath(kOutputDirectory);
+        recorder.SetCodec(mjpg, cv::CAP_ANY, ".avi");
+        recorder.Initialize(kClipFrameSize.width, kClipFrameSize.height, kClipFps);
+        recorder.SetEncodeQueueCapacity(kBackpressureQueue);
+        recorder.SetBackpressurePolicy(policy);
+        recorder.SetEncoderThrottle(kBackpressureThrottleMs);
+        
+        std::string outputName = "backpressure_" + name + ".avi";
+        cv::VideoCapture capture(sourcePath);
+        if (!capture.isOpened() || !recorder.StartRecording(outputName)) {
+            result.passed = false;
+            detail << name << ": could not open source or output; ";
+            continue;
+        }
+        
+        cv::Mat frame;
+        int captured = 0;
+        double maxAddMs = 0.0;
+        while (capture.read(frame)) {
+            auto addStart = std::chrono::steady_clock::now();
+            recorder.AddFrame(frame, captured / kClipFps);
+            maxAddMs = std::max(maxAddMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - addStart).count());
+            captured++;
+        }
+        recorder.StopRecording();
+        EncoderStats stats = recorder.GetEncoderStats();
+        
+        int written = 0;
+        cv::VideoCapture output(std::string(kOutputDirectory) + outputName);
+        while (output.read(frame)) {
+            written++;
+        }
+        
+        // Every submitted frame ends up encoded or dropped, and the file holds exactly the encoded ones
+        bool accounted = captured == kBackpressureFrames && stats.framesSubmitted == static_cast<size_t>(captured) &&
+                         stats.framesEncoded + stats.framesDropped == stats.framesSubmitted &&
+                         written == static_cast<int>(stats.framesEncoded);
+        bool expected = false;
+        switch (policy) {
+            case BackpressurePolicy::BLOCK:
+                expected = stats.framesDropped == 0 && stats.framesDegraded == 0 && stats.blockedMs > 0.0;
+                break;
+            case BackpressurePolicy::DROP_OLDEST:
+            case BackpressurePolicy::DROP_NEWEST:
+                expected = stats.framesDropped > 0 && stats.framesDegraded == 0;
+                break;
+            case BackpressurePolicy::DEGRADE_RESOLUTION:
+                expected = stats.framesDegraded > 0;
+                break;
+        }
+        // Capture never waits on the encoder unless it was asked to
+        bool neverBlocked = policy == BackpressurePolicy::BLOCK ||
+                            (stats.blockedMs == 0.0 && maxAddMs < kBackpressureThrottleMs);
+        
+        if (!accounted || !expected || !neverBlocked) {
+            result.passed = false;
+        }
+        detail << name << " " << written << "/" << captured << " written, " << stats.framesDropped << " dropped, "
+               << stats.framesDegraded << " degraded, max add " << std::fixed << std::setprecision(1) << maxAddMs << "ms"
+               << (accounted && expected && neverBlocked ? "" : " (unexpected)") << "; ";
+    }
+    
+    result.detail = detail.str();
+    return result;
+}
+
+SyntheticCheckResult SyntheticChecks::CheckResolutionInvariance() const {
+    SyntheticCheckResult result;
+    result.name = "Resolution invariance";
+    result.passed = true;
+    
+    const cv::Size resolutions[] = { cv::Size(1280, 720), cv::Size(1920, 1080), cv::Size(2560, 1440) };
+    
+    std::ostringstream detail;
+    double maxDifference = 0.0;
+    
+    for (size_t s = 0; s < kIntensityScenes.size(); ++s) {
+        ResolutionOutcome reference;
+        
+        for (size_t r = 0; r < sizeof(resolutions) / sizeof(resolutions[0]); ++r) {
+            DisplayGeometry geometry(resolutions[r].width, resolutions[r].height);
+            
+            EnemyDetector detector;
+            detector.SetDisplayGeometry(geometry);
+            CombatAnalyzer analyzer;
+            analyzer.SetDisplayGeometry(geometry);
+            
+            // The scene holds still for a few frames, long enough to start tracks and combat
+            ResolutionOutcome outcome;
+            for (int frameIndex = 0; frameIndex < kInvarianceFrames; ++frameIndex) {
+                cv::Mat frame = MakeBackground(resolutions[r], static_cast<unsigned int>(frameIndex));
+                DrawScene(frame, geometry, kIntensityScenes[s]);
+                
+                std::vector<EnemyDetection> enemies = detector.FilterDetections(FindSceneEnemies(frame, detector, kIntensityScenes[s].size()));
+                CombatState state = analyzer.AnalyzeDetections(frame, enemies, frameIndex / kClipFps);
+                
+                outcome.detections = enemies.size();
+                outcome.combatActive = state.isActive;
+                outcome.nearCrosshair = detector.IsCombatActive(enemies);
+                outcome.intensity = analyzer.CalculateCombatIntensity(enemies);
+            }
+            outcome.tracks = analyzer.GetPositionTracker().GetActiveTrajectories().size();
+            
+            if (r == 0) {
+                reference = outcome;
+                detail << "scene " << s << " " << outcome.detections << " enemies, " << std::fixed << std::setprecision(4)
+                       << outcome.intensity << (outcome.combatActive ? " combat" : "") << "; ";
+                continue;
+            }
+            
+            double difference = std::abs(outcome.intensity - reference.intensity);
+            maxDifference = std::max(maxDifference, difference);
+            bool matches = difference <= kIntensityTolerance && outcome.detections == reference.detections &&
+                           outcome.combatActive == reference.combatActive && outcome.nearCrosshair == reference.nearCrosshair &&
+                           outcome.tracks == reference.tracks;
+            if (!matches && result.passed) {
+                result.passed = false;
+                detail << "scene " << s << " at " << resolutions[r].height << "p: " << outcome.detections << " enemies, "
+                       << outcome.tracks << " tracks, intensity " << outcome.intensity << ", combat "
+                       << (outcome.combatActive ? "on" : "off") << ", near crosshair " << (outcome.nearCrosshair ? "yes" : "no")
+                       << " against " << reference.detections << ", " << reference.tracks << ", " << reference.intensity << ", "
+                       << (reference.combatActive ? "on" : "off") << ", " << (reference.nearCrosshair ? "yes" : "no") << " at 720p; ";
+            }
+        }
+    }
+    
+    detail << "max difference " << std::scientific << std::setprecision(1) << maxDifference;
+    result.detail = detail.str();
+    return result;
+}
+
+void SyntheticChecks::PrintResults(const std::vector<SyntheticCheckResult>& results) {
+    std::cout << "\n=== SYNTHETIC CHECKS ===" << std::endl;
+    
+    int failed = 0;
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(24) << result.name << std::setw(6) << (result.passed ? "PASS" : "FAIL")
+                  << result.detail << std::endl;
+        if (!result.passed) {
+            failed++;
+        }
+    }
+    
+    std::cout << (results.size() - failed) << "/" << results.size() << " checks passed" << std::endl;
+    std::cout << std::endl;
+}
@@ -0,0 +1,669 @@
+#include "TrackingBenchmark.h"
+#include "AllocationCounter.h"
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+
+namespace {
+const double kMaxSpeed = 300.0;            // Pixels per second at 1080p
+const double kDetectionRate = 0.9;         // Chance an enemy is detected in a given frame
+const float kJitter = 2.0f;
+const float kLaneSpacing = 60.0f;
+const double kHistorySeconds = 10.0;
+const double kHistoryBenchmarkSeconds = 30.0;
+const double kMatchSeconds = 20.0 * 60.0;
+const int kMatchEnemies = 10;
+const int kIndexQueries = 1000;
+const char* const kWorkDirectory = "./recordings/tracking_benchmark/";
+const double kSessionSeconds = 10.0 * 60.0;
+const double kMinLifeSeconds = 3.0;
+const double kMaxLifeSeconds = 15.0;
+const double kMaxRespawnSeconds = 3.0;
+
+// Per-sample layout and update the tracker used before TrajectoryHistory
+struct LegacyPosition {
+    cv::Point2f position;
+    double timestamp;
+    double confidence;
+    std::string enemyId;
+    bool isVisible;
+};
+
+double LegacyUpdate(std::vector<LegacyPosition>& positions, const LegacyPosition& position) {
+    positions.push_back(position);
+    double cutoffTime = position.timestamp - kHistorySeconds;
+    positions.erase(std::remove_if(positions.begin(), positions.end(),
+                                   [cutoffTime](const LegacyPosition& pos) { return pos.timestamp < cutoffTime; }),
+                    positions.end());
+    
+    double totalDistance = 0.0;
+    double totalTime = 0.0;
+    for (size_t i = 1; i < positions.size(); ++i) {
+        double timeDiff = positions[i].timestamp - positions[i - 1].timestamp;
+        if (timeDiff > 0) {
+            totalDistance += cv::norm(positions[i].position - positions[i - 1].position);
+            totalTime += timeDiff;
+        }
+    }
+    
+    cv::Point2f avgPosition(0, 0);
+    for (const auto& pos : positions) {
+        avgPosition += pos.position;
+    }
+    avgPosition *= (1.0 / positions.size());
+    double totalVariance = 0.0;
+    for (const auto& pos : positions) {
+        totalVariance += cv::norm(pos.position - avgPosition);
+    }
+    
+    return (totalTime > 0 ? totalDistance / totalTime : 0.0) + totalVariance / positions.size();
+}
+
+double RingUpdate(TrajectoryHistory& history, const LegacyPosition& position) {
+    history.Push(position.position, position.timestamp, static_cast<float>(position.confidence), position.isVisible);
+    history.ExpireBefore(position.timestamp - kHistorySeconds);
+    
+    double totalTime = history.PathDuration();
+    double speed = totalTime > 0 ? history.PathLength() / totalTime : 0.0;
+    return speed + history.MeanDistanceFrom(history.Centroid());
+}
+}
+
+std::string TrackingScenarioToString(TrackingScenario scenario) {
+    switch (scenario) {
+        case TrackingScenario::RANDOM: return "RANDOM";
+        case TrackingScenario::CROSSING: return "CROSSING";
+        default: return "UNKNOWN";
+    }
+}
+
+TrackingBenchmark::TrackingBenchmark() 
+    : trackCounts({ 25, 100, 400, 1000 }), framesPerRun(600), fps(60.0), field(1920, 1080) {
+}
+
+TrackingBenchmark::~TrackingBenchmark() {
+}
+
+void TrackingBenchmark::SetTrackCounts(const std::vector<int>& counts) {
+    trackCounts = counts;
+}
+
+void TrackingBenchmark::SetFramesPerRun(int frames) {
+    framesPerRun = std::max(10, frames);
+    std::cout << "[TrackingBenchmark] Frames per run set to " << framesPerRun << std::endl;
+}
+
+TrackingScene TrackingBenchmark::GenerateScene(TrackingScenario scenario, int trackCount) const {
+    // Enemies bounce around the screen and are missed now and then, like a
+    // crowded lobby seen through a real detector
+    std::mt19937 rng(static_cast<unsigned>(trackCount) * 2 + static_cast<unsigned>(scenario));
+    std::uniform_real_distribution<float> xDist(0.0f, static_cast<float>(field.width));
+    std::uniform_real_distribution<float> yDist(0.0f, static_cast<float>(field.height));
+    std::uniform_real_distribution<float> speedDist(static_cast<float>(-kMaxSpeed), static_cast<float>(kMaxSpeed));
+    std::uniform_real_distribution<float> jitterDist(-kJitter, kJitter);
+    std::uniform_real_distribution<double> detectDist(0.0, 1.0);
+    
+    std::vector<cv::Point2f> positions(trackCount);
+    std::vector<cv::Point2f> velocities(trackCount);
+    int lanes = std::max(1, static_cast<int>(field.height / kLaneSpacing) - 1);
+    
+    for (int i = 0; i < trackCount; i++) {
+        if (scenario == TrackingScenario::CROSSING) {
+            // Partners share a lane and start at opposite edges heading for each other
+            int pair = i / 2;
+            float laneY = kLaneSpacing * (1 + pair % lanes);
+            float speed = static_cast<float>(kMaxSpeed * (0.6 + 0.4 * detectDist(rng)));
+            float startX = static_cast<float>(field.width) * (0.05f + 0.1f * (pair / lanes % 4));
+            
+            bool leftToRight = (i % 2 == 0);
+            positions[i] = cv::Point2f(leftToRight ? startX : field.width - startX, laneY + jitterDist(rng));
+            velocities[i] = cv::Point2f(leftToRight ? speed : -speed, 0.0f);
+        } else {
+            positions[i] = cv::Point2f(xDist(rng), yDist(rng));
+            velocities[i] = cv::Point2f(speedDist(rng), speedDist(rng));
+        }
+    }
+    
+    TrackingScene scene;
+    scene.detections.resize(framesPerRun);
+    scene.truthIds.resize(framesPerRun);
+    
+    for (int frame = 0; frame < framesPerRun; frame++) {
+        double timestamp = frame / fps;
+        
+        for (int i = 0; i < trackCount; i++) {
+            positions[i] += velocities[i] * static_cast<float>(1.0 / fps);
+            if (positions[i].x < 0 || positions[i].x >= field.width) velocities[i].x = -velocities[i].x;
+            if (positions[i].y < 0 || positions[i].y >= field.height) velocities[i].y = -velocities[i].y;
+            
+            if (detectDist(rng) > kDetectionRate) continue;
+            
+            EnemyDetection detection;
+            detection.center = positions[i] + cv::Point2f(jitterDist(rng), jitterDist(rng));
+            detection.boundingBox = cv::Rect(static_cast<int>(detection.center.x) - 20, static_cast<int>(detection.center.y) - 40, 40, 80);
+            detection.confidence = 0.9;
+            detection.enemyType = "enemy";
+            detection.timestamp = timestamp;
+            scene.detections[frame].push_back(detection);
+            scene.truthIds[frame].push_back(i);
+        }
+    }
+    
+    return scene;
+}
+
+TrackingBenchmarkResult TrackingBenchmark::RunOne(const TrackingScene& scene, TrackingScenario scenario, int trackCount,
+                                                  bool spatialGrid, AssociationMethod method, MotionModel motionModel) const {
+    PositionTracker tracker;
+    tracker.SetUseSpatialGrid(spatialGrid);
+    tracker.SetAssociationMethod(method);
+    tracker.SetMotionModel(motionModel);
+    
+    // An ID switch is any change in the tracker ID given to the same true enemy
+    std::vector<TrackHandle> lastIds(trackCount);
+    size_t idSwitches = 0;
+    size_t allocations = 0;
+    
+    for (size_t frame = 0; frame < scene.detections.size(); frame++) {
+        size_t allocationsBefore = AllocationCounter::Count();
+        tracker.UpdateEnemyPositions(scene.detections[frame], frame / fps);
+        allocations += AllocationCounter::Count() - allocationsBefore;
+        
+        const std::vector<TrackHandle>& assigned = tracker.GetLastAssignedHandles();
+        for (size_t d = 0; d < assigned.size(); d++) {
+            TrackHandle& lastId = lastIds[scene.truthIds[frame][d]];
+            if (lastId.IsValid() && lastId != assigned[d]) {
+                idSwitches++;
+            }
+            lastId = assigned[d];
+        }
+    }
+    
+    AssociationStats stats = tracker.GetAssociationStats();
+    TrackingBenchmarkResult result;
+    result.scenario = scenario;
+    result.trackCount = trackCount;
+    result.spatialGrid = spatialGrid;
+    result.method = method;
+    result.motionModel = motionModel;
+    result.frames = static_cast<int>(stats.framesProcessed);
+    result.averageUpdateMs = stats.averageUpdateMs;
+    result.peakUpdateMs = stats.peakUpdateMs;
+    result.framesPerSecond = stats.averageUpdateMs > 0.0 ? 1000.0 / stats.averageUpdateMs : 0.0;
+    result.allocationsPerFrame = scene.detections.empty() ? 0.0 : static_cast<double>(allocations) / scene.detections.size();
+    result.candidatesPerDetection = stats.candidatesPerDetection;
+    result.averageInnovation = stats.averageInnovation;
+    result.velocityJitter = stats.velocityJitter;
+    result.idSwitches = idSwitches;
+    result.trajectoriesCreated = tracker.GetAllTrajectories().size();
+    return result;
+}
+
+std::vector<TrackingBenchmarkResult> TrackingBenchmark::Run() {
+    std::vector<TrackingBenchmarkResult> results;
+    
+    struct Configuration {
+        bool spatialGrid;
+        AssociationMethod method;
+        MotionModel motionModel;
+    };
+    const Configuration configurations[] = {
+        { false, AssociationMethod::GREEDY, MotionModel::TWO_POINT },
+        { true, AssociationMethod::GLOBAL, MotionModel::TWO_POINT },
+        { true, AssociationMethod::GLOBAL, MotionModel::KALMAN }
+    };
+    
+    for (TrackingScenario scenario : { TrackingScenario::RANDOM, TrackingScenario::CROSSING }) {
+        for (int trackCount : trackCounts) {
+            TrackingScene scene = GenerateScene(scenario, trackCount);
+            
+            // Every configuration sees identical input
+            for (const auto& configuration : configurations) {
+                TrackingBenchmarkResult result = RunOne(scene, scenario, trackCount, configuration.spatialGrid,
+                                                        configuration.method, configuration.motionModel);
+                std::cout << "[TrackingBenchmark] " << TrackingScenarioToString(scenario) << " " << trackCount << " tracks, "
+                          << (configuration.spatialGrid ? "grid" : "linear") << " " << AssociationMethodToString(configuration.method)
+                          << " " << MotionModelToString(configuration.motionModel) << ": " << std::fixed << std::setprecision(3) << result.averageUpdateMs << " ms/frame, "
+                          << result.idSwitches << " ID switches" << std::endl;
+                results.push_back(result);
+            }
+        }
+    }
+    
+    return results;
+}
+
+std::vector<HistoryBenchmarkResult> TrackingBenchmark::RunHistory() const {
+    std::vector<HistoryBenchmarkResult> results;
+    const int trackCount = 100;
+    
+    for (double historyFps : { fps, 144.0 }) {
+        // Every track walks in a circle so the analysis sees realistic values
+        int frames = static_cast<int>(kHistoryBenchmarkSeconds * historyFps);
+        std::vector<LegacyPosition> samples(frames);
+        for (int frame = 0; frame < frames; frame++) {
+            double timestamp = frame / historyFps;
+            samples[frame].position = cv::Point2f(960.0f + 300.0f * static_cast<float>(std::cos(timestamp)),
+                                                   540.0f + 300.0f * static_cast<float>(std::sin(timestamp)));
+            samples[frame].timestamp = timestamp;
+            samples[frame].confidence = 0.9;
+            samples[frame].isVisible = true;
+        }
+        
+        std::vector<std::vector<LegacyPosition>> legacyTracks(trackCount);
+        std::vector<TrajectoryHistory> ringTracks(trackCount);
+        double sink = 0.0;
+        
+        auto legacyStart = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (int track = 0; track < trackCount; track++) {
+                LegacyPosition sample = samples[frame];
+                sample.enemyId = "enemy_" + std::to_string(track + 1);
+                sink += LegacyUpdate(legacyTracks[track], sample);
+            }
+        }
+        double legacyNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - legacyStart).count();
+        
+        auto ringStart = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            for (int track = 0; track < trackCount; track++) {
+                sink -= RingUpdate(ringTracks[track], samples[frame]);
+            }
+        }
+        double ringNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - ringStart).count();
+        
+        // Both paths compute the same quantities, so the sink should be near zero
+        if (std::abs(sink) > 1e-3 * frames * trackCount) {
+            std::cerr << "[TrackingBenchmark] History results diverged by " << sink << std::endl;
+        }
+        
+        double updates = static_cast<double>(frames) * trackCount;
+        const std::vector<LegacyPosition>& legacy = legacyTracks.front();
+        size_t legacyHeap = 0;
+        for (const auto& pos : legacy) {
+            if (pos.enemyId.capacity() > std::string().capacity()) legacyHeap += pos.enemyId.capacity() + 1;
+        }
+        
+        HistoryBenchmarkResult before;
+        before.storage = "vector";
+        before.trackCount = trackCount;
+        before.fps = historyFps;
+        before.nanosecondsPerUpdate = legacyNs / updates;
+        before.bytesPerTrack = static_cast<double>(sizeof(legacy) + legacy.capacity() * sizeof(LegacyPosition) + legacyHeap);
+        results.push_back(before);
+        
+        HistoryBenchmarkResult after;
+        after.storage = "ring";
+        after.trackCount = trackCount;
+        after.fps = historyFps;
+        after.nanosecondsPerUpdate = ringNs / updates;
+        after.bytesPerTrack = static_cast<double>(ringTracks.front().MemoryBytes());
+        results.push_back(after);
+        
+        std::cout << "[TrackingBenchmark] History at " << std::fixed << std::setprecision(0) << historyFps << " fps: "
+                  << std::setprecision(1)
+                  << before.nanosecondsPerUpdate << " ns vector, " << after.nanosecondsPerUpdate << " ns ring" << std::endl;
+    }
+    
+    return results;
+}
+
+std::vector<IndexBenchmarkResult> TrackingBenchmark::RunSpatialIndex() const {
+    // A full match of enemies wandering the screen, every position kept
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> xDist(0.0f, static_cast<float>(field.width));
+    std::uniform_real_distribution<float> yDist(0.0f, static_cast<float>(field.height));
+    std::uniform_real_distribution<float> stepDist(-4.0f, 4.0f);
+    std::uniform_real_distribution<double> timeDist(0.0, kMatchSeconds);
+    
+    int frames = static_cast<int>(kMatchSeconds * fps);
+    std::vector<IndexedPosition> positions;
+    positions.reserve(static_cast<size_t>(frames) * kMatchEnemies);
+    std::vector<cv::Point2f> walkers(kMatchEnemies);
+    for (auto& walker : walkers) {
+        walker = cv::Point2f(xDist(rng), yDist(rng));
+    }
+    for (int frame = 0; frame < frames; frame++) {
+        for (int enemy = 0; enemy < kMatchEnemies; enemy++) {
+            cv::Point2f& walker = walkers[enemy];
+            walker.x = std::min(std::max(walker.x + stepDist(rng), 0.0f), static_cast<float>(field.width - 1));
+            walker.y = std::min(std::max(walker.y + stepDist(rng), 0.0f), static_cast<float>(field.height - 1));
+            
+            IndexedPosition position;
+            position.position = walker;
+            position.timestamp = frame / fps;
+            position.confidence = 0.9f;
+            position.trackId = enemy + 1;
+            position.isVisible = frame % 7 != 0;
+            positions.push_back(position);
+        }
+    }
+    
+    SpatioTemporalIndex index;
+    auto buildStart = std::chrono::steady_clock::now();
+    for (const auto& position : positions) {
+        index.Insert(position);
+    }
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    std::cout << "[TrackingBenchmark] Indexed " << positions.size() << " positions in " << std::fixed << std::setprecision(1)
+              << buildMs << " ms (" << index.MemoryBytes() / (1024.0 * 1024.0) << " MB)" << std::endl;
+    
+    std::vector<double> queryTimes(kIndexQueries);
+    std::vector<cv::Point2f> queryPoints(kIndexQueries);
+    for (int q = 0; q < kIndexQueries; q++) {
+        queryTimes[q] = timeDist(rng);
+        queryPoints[q] = cv::Point2f(xDist(rng), yDist(rng));
+    }
+    const double radius = 200.0;
+    
+    std::vector<IndexBenchmarkResult> results;
+    auto record = [&](const std::string& query, double linearNs, double indexedNs, size_t linearMatches, size_t indexedMatches) {
+        if (linearMatches != indexedMatches) {
+            std::cerr << "[TrackingBenchmark] " << query << " returned " << indexedMatches << " matches, expected "
+                      << linearMatches << std::endl;
+        }
+        IndexBenchmarkResult result;
+        result.query = query;
+        result.positions = positions.size();
+        result.linearMicroseconds = linearNs / 1000.0 / kIndexQueries;
+        result.indexedMicroseconds = indexedNs / 1000.0 / kIndexQueries;
+        result.matches = indexedMatches;
+        results.push_back(result);
+    };
+    auto elapsedNs = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    // Radius at time, as death analysis asks it
+    size_t linearMatches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        for (const auto& position : positions) {
+            if (std::abs(position.timestamp - queryTimes[q]) < 1.0 && cv::norm(position.position - queryPoints[q]) <= radius) {
+                linearMatches++;
+            }
+        }
+    }
+    double linearNs = elapsedNs(start);
+    
+    std::vector<IndexedPosition> found;
+    size_t indexedMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        found.clear();
+        indexedMatches += index.QueryRadius(queryPoints[q], radius, queryTimes[q], 1.0, found);
+    }
+    record("radius", linearNs, elapsedNs(start), linearMatches, indexedMatches);
+    double radiusLinearNs = linearNs;
+    size_t radiusLinearMatches = linearMatches;
+    
+    // Visibility of one enemy around a moment
+    linearMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        int trackId = q % kMatchEnemies + 1;
+        for (const auto& position : positions) {
+            if (position.trackId == trackId && position.isVisible && std::abs(position.timestamp - queryTimes[q]) < 0.5) {
+                linearMatches++;
+                break;
+            }
+        }
+    }
+    linearNs = elapsedNs(start);
+    
+    indexedMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        if (index.WasVisible(q % kMatchEnemies + 1, queryTimes[q], 0.5)) {
+            indexedMatches++;
+        }
+    }
+    record("visible", linearNs, elapsedNs(start), linearMatches, indexedMatches);
+    
+    // Everything in the second after a moment, as a replay scrubber asks it
+    linearMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        for (const auto& position : positions) {
+            if (position.timestamp >= queryTimes[q] && position.timestamp < queryTimes[q] + 1.0) {
+                linearMatches++;
+            }
+        }
+    }
+    linearNs = elapsedNs(start);
+    
+    indexedMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        found.clear();
+        indexedMatches += index.QueryTimeRange(queryTimes[q], queryTimes[q] + 1.0, found);
+    }
+    record("range", linearNs, elapsedNs(start), linearMatches, indexedMatches);
+    
+    // The same match read back from a trajectory archive, as a past session is
+    // queried. Each enemy is archived as one trajectory per history window.
+    std::error_code error;
+    std::filesystem::create_directories(kWorkDirectory, error);
+    std::string archivePath = std::string(kWorkDirectory) + "spatial_index.gtta";
+    
+    TrajectoryArchive archive;
+    if (!archive.Open(archivePath, false, field.width, field.height)) {
+        return results;
+    }
+    int windowFrames = static_cast<int>(kHistorySeconds * fps);
+    for (int enemy = 0; enemy < kMatchEnemies; enemy++) {
+        for (int windowStart = 0; windowStart < frames; windowStart += windowFrames) {
+            EnemyTrajectory trajectory;
+            trajectory.trackId = enemy + 1;
+            trajectory.isActive = false;
+            trajectory.velocity = cv::Point2f(0, 0);
+            trajectory.movementSpeed = 0.0;
+            trajectory.movementPattern = "moving";
+            
+            int windowEnd = std::min(frames, windowStart + windowFrames);
+            for (int frame = windowStart; frame < windowEnd; frame++) {
+                const IndexedPosition& position = positions[static_cast<size_t>(frame) * kMatchEnemies + enemy];
+                trajectory.history.Push(position.position, position.timestamp, position.confidence, position.isVisible);
+            }
+            trajectory.firstSeen = trajectory.history.Timestamp(0);
+            trajectory.lastSeen = trajectory.history.BackTimestamp();
+            archive.Append(trajectory);
+        }
+    }
+    archive.Close();
+    
+    SpatioTemporalIndex archivedIndex;
+    auto loadStart = std::chrono::steady_clock::now();
+    archivedIndex.InsertArchive(archivePath);
+    double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+    std::cout << "[TrackingBenchmark] Indexed " << archivedIndex.Size() << " archived positions in " << std::fixed
+              << std::setprecision(1) << loadMs << " ms" << std::endl;
+    
+    indexedMatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < kIndexQueries; q++) {
+        found.clear();
+        indexedMatches += archivedIndex.QueryRadius(queryPoints[q], radius, queryTimes[q], 1.0, found);
+    }
+    record("archived", radiusLinearNs, elapsedNs(start), radiusLinearMatches, indexedMatches);
+    std::filesystem::remove(archivePath, error);
+    
+    return results;
+}
+
+std::vector<MemoryBenchmarkResult> TrackingBenchmark::RunBoundedMemory() const {
+    std::error_code error;
+    std::filesystem::create_directories(kWorkDirectory, error);
+    std::string archivePath = std::string(kWorkDirectory) + "bounded_session.gtta";
+    
+    std::vector<MemoryBenchmarkResult> results;
+    for (const std::string mode : { "unbounded", "discarded", "archived" }) {
+        // A long session where enemies live a few seconds, vanish, and respawn
+        // elsewhere, so finished trajectories pile up. Every run sees the same input.
+        bool archived = mode == "archived";
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> xDist(0.0f, static_cast<float>(field.width));
+        std::uniform_real_distribution<float> yDist(0.0f, static_cast<float>(field.height));
+        std::uniform_real_distribution<float> speedDist(static_cast<float>(-kMaxSpeed), static_cast<float>(kMaxSpeed));
+        std::uniform_real_distribution<float> jitterDist(-kJitter, kJitter);
+        std::uniform_real_distribution<double> lifeDist(kMinLifeSeconds, kMaxLifeSeconds);
+        std::uniform_real_distribution<double> respawnDist(0.0, kMaxRespawnSeconds);
+        std::uniform_real_distribution<double> detectDist(0.0, 1.0);
+        
+        std::vector<cv::Point2f> positions(kMatchEnemies);
+        std::vector<cv::Point2f> velocities(kMatchEnemies);
+        std::vector<double> spawnTimes(kMatchEnemies, 0.0);
+        std::vector<double> despawnTimes(kMatchEnemies);
+        for (int enemy = 0; enemy < kMatchEnemies; enemy++) {
+            positions[enemy] = cv::Point2f(xDist(rng), yDist(rng));
+            velocities[enemy] = cv::Point2f(speedDist(rng), speedDist(rng));
+            despawnTimes[enemy] = lifeDist(rng);
+        }
+        
+        PositionTracker tracker;
+        tracker.SetDisplayGeometry(DisplayGeometry(field.width, field.height));
+        if (archived) {
+            tracker.OpenArchive(archivePath);
+        } else if (mode == "unbounded") {
+            tracker.SetFinishedRetention(kSessionSeconds);
+            tracker.SetIndexRetention(0.0);
+        }
+        
+        int frames = static_cast<int>(kSessionSeconds * fps);
+        size_t peakInMemory = 0;
+        std::vector<EnemyDetection> detections;
+        for (int frame = 0; frame < frames; frame++) {
+            double timestamp = frame / fps;
+            detections.clear();
+            
+            for (int enemy = 0; enemy < kMatchEnemies; enemy++) {
+                if (timestamp >= despawnTimes[enemy]) {
+                    positions[enemy] = cv::Point2f(xDist(rng), yDist(rng));
+                    velocities[enemy] = cv::Point2f(speedDist(rng), speedDist(rng));
+                    spawnTimes[enemy] = timestamp + respawnDist(rng);
+                    despawnTimes[enemy] = spawnTimes[enemy] + lifeDist(rng);
+                }
+                if (timestamp < spawnTimes[enemy]) continue;
+                
+                positions[enemy] += velocities[enemy] * static_cast<float>(1.0 / fps);
+                if (positions[enemy].x < 0 || positions[enemy].x >= field.width) velocities[enemy].x = -velocities[enemy].x;
+                if (positions[enemy].y < 0 || positions[enemy].y >= field.height) velocities[enemy].y = -velocities[enemy].y;
+                if (detectDist(rng) > kDetectionRate) continue;
+                
+                EnemyDetection detection;
+                detection.center = positions[enemy] + cv::Point2f(jitterDist(rng), jitterDist(rng));
+                detection.boundingBox = cv::Rect(static_cast<int>(detection.center.x) - 20, static_cast<int>(detection.center.y) - 40, 40, 80);
+                detection.confidence = 0.9;
+                detection.enemyType = "enemy";
+                detection.timestamp = timestamp;
+                detections.push_back(detection);
+            }
+            
+            tracker.UpdateEnemyPositions(detections, timestamp);
+            peakInMemory = std::max(peakInMemory, tracker.GetTrajectoryCount());
+        }
+        
+        MemoryBenchmarkResult result;
+        result.mode = mode;
+        result.sessionSeconds = kSessionSeconds;
+        result.trajectoriesCreated = tracker.GetAllTrajectories().size() + tracker.GetDiscardedCount();
+        result.peakInMemory = peakInMemory;
+        result.archived = tracker.GetArchivedCount();
+        result.discarded = tracker.GetDiscardedCount();
+        result.archiveKilobytes = archived ? std::filesystem::file_size(archivePath, error) / 1024.0 : 0.0;
+        result.indexMegabytes = tracker.GetPositionIndex().MemoryBytes() / (1024.0 * 1024.0);
+        result.averageUpdateMs = tracker.GetAssociationStats().averageUpdateMs;
+        results.push_back(result);
+        
+        std::cout << "[TrackingBenchmark] " << result.mode << " session: " << result.trajectoriesCreated << " trajectories, peak "
+                  << result.peakInMemory << " in memory" << std::endl;
+    }
+    
+    for (size_t i = 1; i < results.size(); i++) {
+        if (results[i].trajectoriesCreated != results[0].trajectoriesCreated) {
+            std::cerr << "[TrackingBenchmark] " << results[i].mode << " session reports " << results[i].trajectoriesCreated
+                      << " trajectories, expected " << results[0].trajectoriesCreated << std::endl;
+        }
+    }
+    std::filesystem::remove(archivePath, error);
+    
+    return results;
+}
+
+void TrackingBenchmark::PrintResults(const std::vector<TrackingBenchmarkResult>& results) {
+    std::cout << "\n=== TRACKING BENCHMARK ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Scenario" << std::setw(8) << "Tracks" << std::setw(8) << "Index"
+              << std::setw(8) << "Method" << std::setw(11) << "Motion"
+              << std::right << std::setw(10) << "Avg ms" << std::setw(10) << "Peak ms" << std::setw(10) << "FPS"
+              << std::setw(10) << "Allocs" << std::setw(10) << "Cand/Det" << std::setw(10) << "Innov px" << std::setw(10) << "Jitter"
+              << std::setw(10) << "Switches" << std::setw(8) << "IDs" << std::endl;
+    
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(10) << TrackingScenarioToString(result.scenario) << std::setw(8) << result.trackCount
+                  << std::setw(8) << (result.spatialGrid ? "grid" : "linear") << std::setw(8) << AssociationMethodToString(result.method)
+                  << std::setw(11) << MotionModelToString(result.motionModel)
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << result.averageUpdateMs << std::setw(10) << result.peakUpdateMs
+                  << std::setprecision(0) << std::setw(10) << result.framesPerSecond
+                  << std::setprecision(1) << std::setw(10) << result.allocationsPerFrame
+                  << std::setw(10) << result.candidatesPerDetection
+                  << std::setw(10) << result.averageInnovation << std::setw(10) << result.velocityJitter
+                  << std::setw(10) << result.idSwitches << std::setw(8) << result.trajectoriesCreated << std::endl;
+    }
+    if (!AllocationCounter::IsEnabled()) {
+        std::cout << "Allocs not counted, configure with -DGAME_TRAINER_COUNT_ALLOCATIONS=ON" << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void TrackingBenchmark::PrintHistoryResults(const std::vector<HistoryBenchmarkResult>& results) {
+    std::cout << "\n=== TRAJECTORY HISTORY BENCHMARK ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Storage" << std::setw(8) << "Tracks" << std::setw(8) << "FPS"
+              << std::right << std::setw(12) << "ns/update" << std::setw(14) << "Bytes/track" << std::endl;
+    
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(10) << result.storage << std::setw(8) << result.trackCount
+                  << std::setw(8) << std::setprecision(0) << std::fixed << result.fps
+                  << std::right << std::setprecision(1) << std::setw(12) << result.nanosecondsPerUpdate
+                  << std::setprecision(0) << std::setw(14) << result.bytesPerTrack << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void TrackingBenchmark::PrintIndexResults(const std::vector<IndexBenchmarkResult>& results) {
+    std::cout << "\n=== SPATIO-TEMPORAL INDEX BENCHMARK ===" << std::endl;
+    std::cout << std::left << std::setw(10) << "Query" << std::setw(12) << "Positions"
+              << std::right << std::setw(12) << "Linear us" << std::setw(12) << "Index us"
+              << std::setw(10) << "Speedup" << std::setw(10) << "Matches" << std::endl;
+    
+    for (const auto& result : results) {
+        double speedup = result.indexedMicroseconds > 0.0 ? result.linearMicroseconds / result.indexedMicroseconds : 0.0;
+        std::cout << std::left << std::setw(10) << result.query << std::setw(12) << result.positions
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << result.linearMicroseconds << std::setw(12) << result.indexedMicroseconds
+                  << std::setprecision(0) << std::setw(9) << speedup << "x" << std::setw(10) << result.matches << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void TrackingBenchmark::PrintMemoryResults(const std::vector<MemoryBenchmarkResult>& results) {
+    std::cout << "\n=== BOUNDED TRACKER BENCHMARK ===" << std::endl;
+    std::cout << std::left << std::setw(11) << "Mode" << std::setw(10) << "Session"
+              << std::right << std::setw(8) << "Tracks" << std::setw(10) << "Peak mem" << std::setw(10) << "Archived"
+              << std::setw(11) << "Discarded"
+              << std::setw(12) << "Archive KB" << std::setw(10) << "Index MB" << std::setw(10) << "Avg ms" << std::endl;
+    
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(11) << result.mode << std::setw(10)
+                  << (std::to_string(static_cast<int>(result.sessionSeconds)) + "s")
+                  << std::right << std::setw(8) << result.trajectoriesCreated << std::setw(10) << result.peakInMemory
+                  << std::setw(10) << result.archived << std::setw(11) << result.discarded << std::fixed << std::setprecision(0) << std::setw(12) << result.archiveKilobytes
+                  << std::setprecision(1) << std::setw(10) << result.indexMegabytes
+                  << std::setprecision(3) << std::setw(10) << result.averageUpdateMs << std::endl;
+    }
+    std::cout << std::endl;
+}
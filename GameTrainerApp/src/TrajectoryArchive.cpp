@@ -0,0 +1,313 @@
+#include "TrajectoryArchive.h"
+#include "PositionTracker.h"
+#include "RecordFile.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+namespace {
+const char kArchiveMagic[4] = { 'G', 'T', 'T', 'A' };
+const uint32_t kArchiveVersion = 1;
+
+const uint8_t kEncodingRaw = 0;
+const uint8_t kEncodingDelta = 1;
+
+const double kPositionScale = 16.0;         // 1/16 px
+const double kTimeScale = 1000000.0;        // Microseconds
+const uint8_t kVisibleBit = 0x80;
+
+uint8_t EncodeMovementPattern(const std::string& pattern) {
+    if (pattern == "stationary") return 1;
+    if (pattern == "moving_straight") return 2;
+    if (pattern == "moving") return 3;
+    if (pattern == "erratic") return 4;
+    if (pattern == "insufficient_data") return 5;
+    return 0;
+}
+
+std::string DecodeMovementPattern(uint8_t pattern) {
+    switch (pattern) {
+        case 1: return "stationary";
+        case 2: return "moving_straight";
+        case 3: return "moving";
+        case 4: return "erratic";
+        case 5: return "insufficient_data";
+        default: return "unknown";
+    }
+}
+
+void WriteVarint(std::vector<uint8_t>& buffer, int64_t value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(zigzag));
+}
+
+bool ReadVarint(const uint8_t*& data, const uint8_t* end, int64_t& value) {
+    uint64_t zigzag = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (data >= end) {
+            return false;
+        }
+        uint8_t byte = *data++;
+        zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DecodeSamples(const TrajectoryRecordHeader& record, const uint8_t* data, TrajectoryHistory& history) {
+    const uint8_t* end = data + record.payloadBytes;
+    history.SetMaxCapacity(record.sampleCount);
+
+    if (record.encoding == kEncodingRaw) {
+        if (record.payloadBytes != record.sampleCount * sizeof(TrajectorySampleRecord)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < record.sampleCount; i++) {
+            TrajectorySampleRecord sample;
+            std::memcpy(&sample, data + i * sizeof(sample), sizeof(sample));
+            history.Push(cv::Point2f(sample.x, sample.y), sample.timestamp, sample.confidence / 255.0f, sample.visible != 0);
+        }
+        return true;
+    }
+
+    if (record.encoding != kEncodingDelta) {
+        return false;
+    }
+
+    int64_t time = 0, x = 0, y = 0;
+    for (uint32_t i = 0; i < record.sampleCount; i++) {
+        int64_t timeDelta, xDelta, yDelta;
+        if (!ReadVarint(data, end, timeDelta) || !ReadVarint(data, end, xDelta) ||
+            !ReadVarint(data, end, yDelta) || data >= end) {
+            return false;
+        }
+        uint8_t flags = *data++;
+        time += timeDelta;
+        x += xDelta;
+        y += yDelta;
+        history.Push(cv::Point2f(static_cast<float>(x / kPositionScale), static_cast<float>(y / kPositionScale)),
+                     record.firstSeen + time / kTimeScale, (flags & ~kVisibleBit) / 127.0f, (flags & kVisibleBit) != 0);
+    }
+    return data == end;
+}
+}
+
+TrajectoryArchive::TrajectoryArchive()
+    : compressed(true), frameWidth(0), frameHeight(0), recordCount(0), sampleCount(0), bytesWritten(0) {
+}
+
+TrajectoryArchive::~TrajectoryArchive() {
+    Close();
+}
+
+bool TrajectoryArchive::Open(const std::string& path, bool compress, int width, int height) {
+    Close();
+
+    filename = path;
+    compressed = compress;
+    frameWidth = std::max(0, std::min(width, 0xFFFF));
+    frameHeight = std::max(0, std::min(height, 0xFFFF));
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[TrajectoryArchive] Failed to open trajectory archive " << filename << std::endl;
+        return false;
+    }
+
+    TrajectoryArchiveHeader header;
+    std::memcpy(header.magic, kArchiveMagic, sizeof(header.magic));
+    header.version = kArchiveVersion;
+    header.frameWidth = static_cast<uint16_t>(frameWidth);
+    header.frameHeight = static_cast<uint16_t>(frameHeight);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.flush();
+
+    recordCount = 0;
+    sampleCount = 0;
+    bytesWritten = sizeof(header);
+    return file.good();
+}
+
+bool TrajectoryArchive::Append(const EnemyTrajectory& trajectory) {
+    if (!IsOpen()) {
+        return false;
+    }
+
+    const TrajectoryHistory& history = trajectory.history;
+    payload.clear();
+
+    if (compressed) {
+        // Deltas between quantized values, so rounding never accumulates
+        int64_t previousTime = 0, previousX = 0, previousY = 0;
+        for (size_t i = 0; i < history.Size(); i++) {
+            cv::Point2f position = history.Position(i);
+            int64_t time = std::llround((history.Timestamp(i) - trajectory.firstSeen) * kTimeScale);
+            int64_t x = std::llround(position.x * kPositionScale);
+            int64_t y = std::llround(position.y * kPositionScale);
+            WriteVarint(payload, time - previousTime);
+            WriteVarint(payload, x - previousX);
+            WriteVarint(payload, y - previousY);
+
+            float confidence = std::max(0.0f, std::min(1.0f, history.Confidence(i)));
+            uint8_t flags = static_cast<uint8_t>(confidence * 127.0f + 0.5f);
+            payload.push_back(history.IsVisible(i) ? (flags | kVisibleBit) : flags);
+
+            previousTime = time;
+            previousX = x;
+            previousY = y;
+        }
+    } else {
+        payload.resize(history.Size() * sizeof(TrajectorySampleRecord));
+        for (size_t i = 0; i < history.Size(); i++) {
+            cv::Point2f position = history.Position(i);
+            TrajectorySampleRecord sample;
+            sample.timestamp = history.Timestamp(i);
+            sample.x = position.x;
+            sample.y = position.y;
+            sample.confidence = static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, history.Confidence(i))) * 255.0f);
+            sample.visible = history.IsVisible(i) ? 1 : 0;
+            std::memcpy(payload.data() + i * sizeof(sample), &sample, sizeof(sample));
+        }
+    }
+
+    TrajectoryRecordHeader record;
+    record.trackId = trajectory.trackId;
+    record.sampleCount = static_cast<uint32_t>(history.Size());
+    record.payloadBytes = static_cast<uint32_t>(payload.size());
+    record.encoding = compressed ? kEncodingDelta : kEncodingRaw;
+    record.movementPattern = EncodeMovementPattern(trajectory.movementPattern);
+    record.reserved = 0;
+    record.firstSeen = trajectory.firstSeen;
+    record.lastSeen = trajectory.lastSeen;
+    record.velocityX = trajectory.velocity.x;
+    record.velocityY = trajectory.velocity.y;
+    record.movementSpeed = static_cast<float>(trajectory.movementSpeed);
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+    // Readers map the file while it is still being written
+    file.flush();
+    if (!file.good()) {
+        std::cerr << "[TrajectoryArchive] Failed to append trajectory " << PositionTracker::EnemyName(trajectory.trackId) << std::endl;
+        return false;
+    }
+
+    recordCount++;
+    sampleCount += history.Size();
+    bytesWritten += sizeof(record) + payload.size();
+    return true;
+}
+
+void TrajectoryArchive::Close() {
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+void TrajectoryArchive::Reset() {
+    Close();
+    filename.clear();
+    recordCount = 0;
+    sampleCount = 0;
+    bytesWritten = 0;
+}
+
+bool TrajectoryArchive::IsOpen() const {
+    return file.is_open();
+}
+
+bool TrajectoryArchive::IsCompressed() const {
+    return compressed;
+}
+
+int TrajectoryArchive::GetFrameWidth() const {
+    return frameWidth;
+}
+
+int TrajectoryArchive::GetFrameHeight() const {
+    return frameHeight;
+}
+
+const std::string& TrajectoryArchive::GetFilename() const {
+    return filename;
+}
+
+size_t TrajectoryArchive::GetRecordCount() const {
+    return recordCount;
+}
+
+size_t TrajectoryArchive::GetSampleCount() const {
+    return sampleCount;
+}
+
+uint64_t TrajectoryArchive::GetBytesWritten() const {
+    return bytesWritten;
+}
+
+bool TrajectoryArchive::ReadHeader(const std::string& path, TrajectoryArchiveHeader& header) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    return RecordReader::MatchesFormat(header, kArchiveMagic, kArchiveVersion);
+}
+
+bool TrajectoryArchive::ForEach(const std::string& path, const std::function<bool(const EnemyTrajectory&)>& visit) {
+    MappedFile mapped;
+    if (!mapped.Open(path) || mapped.Size() < sizeof(TrajectoryArchiveHeader)) {
+        return false;
+    }
+
+    RecordReader reader(mapped);
+    TrajectoryArchiveHeader header;
+    if (!reader.ReadHeader(header, kArchiveMagic, kArchiveVersion)) {
+        std::cerr << "[TrajectoryArchive] Unsupported trajectory archive format: " << path << std::endl;
+        return false;
+    }
+
+    TrajectoryRecordHeader record;
+    while (reader.Peek(record)) {
+        if (!reader.Fits(sizeof(record) + record.payloadBytes)) {
+            break;
+        }
+        reader.Skip(sizeof(record));
+
+        EnemyTrajectory trajectory;
+        trajectory.trackId = record.trackId;
+        trajectory.firstSeen = record.firstSeen;
+        trajectory.lastSeen = record.lastSeen;
+        trajectory.isActive = false;
+        trajectory.velocity = cv::Point2f(record.velocityX, record.velocityY);
+        trajectory.movementSpeed = record.movementSpeed;
+        trajectory.movementPattern = DecodeMovementPattern(record.movementPattern);
+        trajectory.motion.initialized = false;
+        trajectory.prediction.timestamp = -1.0;
+
+        if (!DecodeSamples(record, reader.Current(), trajectory.history)) {
+            std::cerr << "[TrajectoryArchive] Corrupt record for trajectory " << record.trackId << " in " << path << std::endl;
+            return false;
+        }
+        reader.Skip(record.payloadBytes);
+        trajectory.predictedNextPosition = trajectory.history.Empty() ? cv::Point2f(0, 0) : trajectory.history.Back();
+
+        if (!visit(trajectory)) {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool TrajectoryArchive::Load(const std::string& path, std::vector<EnemyTrajectory>& trajectories) {
+    return ForEach(path, [&trajectories](const EnemyTrajectory& trajectory) {
+        trajectories.push_back(trajectory);
+        return true;
+    });
+}
@@ -0,0 +1,213 @@
+#include "TrajectoryHistory.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const size_t kInitialCapacity = 16;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t power = 1;
+    while (power < value) {
+        power <<= 1;
+    }
+    return power;
+}
+}
+
+TrajectoryHistory::TrajectoryHistory(size_t maxCapacity)
+    : head(0), count(0), maxCapacity(RoundUpToPowerOfTwo(std::max<size_t>(2, maxCapacity))),
+      pathLength(0.0), pathDuration(0.0), sumX(0.0), sumY(0.0) {
+}
+
+size_t TrajectoryHistory::Slot(size_t index) const {
+    // Capacity is always a power of two
+    return (head + index) & (xs.size() - 1);
+}
+
+void TrajectoryHistory::Reallocate(size_t capacity) {
+    std::vector<float> newXs(capacity), newYs(capacity), newConfidences(capacity);
+    std::vector<double> newTimestamps(capacity);
+    std::vector<uint8_t> newVisible(capacity);
+    for (size_t i = 0; i < count; i++) {
+        size_t slot = Slot(i);
+        newXs[i] = xs[slot];
+        newYs[i] = ys[slot];
+        newConfidences[i] = confidences[slot];
+        newTimestamps[i] = timestamps[slot];
+        newVisible[i] = visible[slot];
+    }
+
+    xs.swap(newXs);
+    ys.swap(newYs);
+    confidences.swap(newConfidences);
+    timestamps.swap(newTimestamps);
+    visible.swap(newVisible);
+    head = 0;
+}
+
+void TrajectoryHistory::PopFront() {
+    size_t oldest = Slot(0);
+    if (count >= 2) {
+        size_t next = Slot(1);
+        double timeDiff = timestamps[next] - timestamps[oldest];
+        if (timeDiff > 0) {
+            pathLength -= std::hypot(xs[next] - xs[oldest], ys[next] - ys[oldest]);
+            pathDuration -= timeDiff;
+        }
+    }
+    sumX -= xs[oldest];
+    sumY -= ys[oldest];
+
+    head = (head + 1) & (xs.size() - 1);
+    count--;
+
+    // Restart the sums rather than let rounding drift accumulate
+    if (count <= 1) {
+        pathLength = 0.0;
+        pathDuration = 0.0;
+        sumX = count == 1 ? xs[head] : 0.0;
+        sumY = count == 1 ? ys[head] : 0.0;
+    }
+}
+
+void TrajectoryHistory::SetMaxCapacity(size_t capacity) {
+    maxCapacity = RoundUpToPowerOfTwo(std::max<size_t>(2, capacity));
+    while (count > maxCapacity) {
+        PopFront();
+    }
+    if (xs.size() > maxCapacity) {
+        Reallocate(maxCapacity);
+    }
+}
+
+void TrajectoryHistory::Push(const cv::Point2f& position, double timestamp, float confidence, bool isVisible) {
+    if (count == xs.size()) {
+        if (xs.size() < maxCapacity) {
+            Reallocate(xs.empty() ? std::min(kInitialCapacity, maxCapacity) : std::min(xs.size() * 2, maxCapacity));
+        } else {
+            PopFront();
+        }
+    }
+
+    if (count > 0) {
+        size_t last = Slot(count - 1);
+        double timeDiff = timestamp - timestamps[last];
+        if (timeDiff > 0) {
+            pathLength += std::hypot(position.x - xs[last], position.y - ys[last]);
+            pathDuration += timeDiff;
+        }
+    }
+
+    size_t slot = Slot(count);
+    xs[slot] = position.x;
+    ys[slot] = position.y;
+    confidences[slot] = confidence;
+    timestamps[slot] = timestamp;
+    visible[slot] = isVisible ? 1 : 0;
+    sumX += position.x;
+    sumY += position.y;
+    count++;
+}
+
+size_t TrajectoryHistory::ExpireBefore(double cutoffTime) {
+    size_t expired = 0;
+    while (count > 0 && timestamps[head] < cutoffTime) {
+        PopFront();
+        expired++;
+    }
+    return expired;
+}
+
+void TrajectoryHistory::Clear() {
+    head = 0;
+    count = 0;
+    pathLength = 0.0;
+    pathDuration = 0.0;
+    sumX = 0.0;
+    sumY = 0.0;
+}
+
+size_t TrajectoryHistory::Size() const {
+    return count;
+}
+
+bool TrajectoryHistory::Empty() const {
+    return count == 0;
+}
+
+size_t TrajectoryHistory::Capacity() const {
+    return xs.size();
+}
+
+size_t TrajectoryHistory::MaxCapacity() const {
+    return maxCapacity;
+}
+
+size_t TrajectoryHistory::MemoryBytes() const {
+    size_t perSample = 3 * sizeof(float) + sizeof(double) + sizeof(uint8_t);
+    return sizeof(TrajectoryHistory) + xs.capacity() * perSample;
+}
+
+cv::Point2f TrajectoryHistory::Position(size_t index) const {
+    size_t slot = Slot(index);
+    return cv::Point2f(xs[slot], ys[slot]);
+}
+
+double TrajectoryHistory::Timestamp(size_t index) const {
+    return timestamps[Slot(index)];
+}
+
+float TrajectoryHistory::Confidence(size_t index) const {
+    return confidences[Slot(index)];
+}
+
+bool TrajectoryHistory::IsVisible(size_t index) const {
+    return visible[Slot(index)] != 0;
+}
+
+cv::Point2f TrajectoryHistory::Back() const {
+    return Position(count - 1);
+}
+
+double TrajectoryHistory::BackTimestamp() const {
+    return Timestamp(count - 1);
+}
+
+double TrajectoryHistory::PathLength() const {
+    return pathLength;
+}
+
+double TrajectoryHistory::PathDuration() const {
+    return pathDuration;
+}
+
+cv::Point2f TrajectoryHistory::Centroid() const {
+    if (count == 0) {
+        return cv::Point2f(0, 0);
+    }
+    return cv::Point2f(static_cast<float>(sumX / count), static_cast<float>(sumY / count));
+}
+
+double TrajectoryHistory::MeanDistanceFrom(const cv::Point2f& center) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    // At most two contiguous runs, each a plain loop the compiler can vectorize
+    size_t firstLength = std::min(count, xs.size() - head);
+    size_t runs[2][2] = { { head, firstLength }, { 0, count - firstLength } };
+
+    double total = 0.0;
+    for (const auto& run : runs) {
+        const float* runXs = xs.data() + run[0];
+        const float* runYs = ys.data() + run[0];
+        float runTotal = 0.0f;
+        for (size_t i = 0; i < run[1]; i++) {
+            float dx = runXs[i] - center.x;
+            float dy = runYs[i] - center.y;
+            runTotal += std::sqrt(dx * dx + dy * dy);
+        }
+        total += runTotal;
+    }
+    return total / count;
+}
@@ -1,20 +1,76 @@
 #include "VideoRecorder.h"
+#include "CodecBenchmark.h"
 #include <iostream>
 #include <filesystem>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <fstream>
+
+std::string BackpressurePolicyToString(BackpressurePolicy policy) {
+    switch (policy) {
+        case BackpressurePolicy::BLOCK: return "BLOCK";
+        case BackpressurePolicy::DROP_OLDEST: return "DROP_OLDEST";
+        case BackpressurePolicy::DROP_NEWEST: return "DROP_NEWEST";
+        case BackpressurePolicy::DEGRADE_RESOLUTION: return "DEGRADE_RESOLUTION";
+        default: return "UNKNOWN";
+    }
+}
+
+namespace {
+    size_t StoredBytes(const FrameBuffer& bufferFrame) {
+        return bufferFrame.frame.total() * bufferFrame.frame.elemSize() + bufferFrame.encoded.size();
+    }
+    
+    const int kCompressionThreads = 2;
+}
 
 VideoRecorder::VideoRecorder() 
-    : isRecording(false), isInitialized(false), frameWidth(1280), frameHeight(720),
-      fps(30.0), bufferSize(300), codec(cv::VideoWriter::fourcc('M', 'P', '4', 'V')) {
+    : isRecording(false), isInitialized(false), isBuffering(true), frameWidth(1280), frameHeight(720),
+      fps(30.0), bufferSize(300), replayDuration(30.0), codec(cv::VideoWriter::fourcc('M', 'P', '4', 'V')),
+      writerApi(cv::CAP_ANY), containerExtension(".mp4"), codecPinned(false),
+      replayBudgetBytes(256 * 1024 * 1024), bufferedBytes(0), nextBufferSequence(0), compressReplayBuffer(true),
+      replayJpegQuality(90), stopCompressionThreads(false), compressedFrameCount(0), compressTotalMs(0.0),
+      stopClipThread(false), savedClipCount(0), stopEncoderThread(false), encodeQueueCapacity(60), encodeQueuePixels(0),
+      backpressurePolicy(BackpressurePolicy::BLOCK), encoderThrottleMs(0.0), encoderStats(), encodeTotalMs(0.0), encodeCpuSeconds(0.0), encodedFrameBytes(0.0),
+      isSegmented(false), segmentDuration(2.0), currentSegment(), isRawRecording(false), rawWriterStats(), rawFramesCommitted(0), burnInOverlays(false), writeProxy(false), proxyScale(0.25),
+      thumbnailInterval(0.0), stopProxyThread(false), lastThumbnailTime(0.0), proxyFramesWritten(0),
+      proxyFramesDropped(0) {
     outputPath = "./recordings/";
+    clipThread = std::thread(&VideoRecorder::ClipWorker, this);
+    for (int i = 0; i < kCompressionThreads; i++) {
+        compressionThreads.emplace_back(&VideoRecorder::CompressionWorker, this);
+    }
 }
 
 VideoRecorder::~VideoRecorder() {
     if (isRecording) {
         StopRecording();
     }
+    
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        stopCompressionThreads = true;
+        compressionQueue.clear();
+        stopClipThread = true;
+        for (auto& request : pendingClips) {
+            readyClips.push_back(std::move(request));
+        }
+        pendingClips.clear();
+    }
+    clipCondition.notify_all();
+    compressionCondition.notify_all();
+    
+    for (auto& thread : compressionThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    
+    if (clipThread.joinable()) {
+        clipThread.join();
+    }
+    
     ClearBuffer();
 }
 
@@ -24,6 +80,23 @@ bool VideoRecorder::Initialize(int width, int height, double frameRate) {
     fps = frameRate;
     
     std::filesystem::create_directories(outputPath);
+    if (!codecPinned) {
+        ApplyCodecBenchmark();
+    }
+    
+    // Enough slots for a full encoder queue plus the raw frames the replay
+    // buffer holds: a second of compression backlog, or the whole buffer and
+    // clip post-roll when it is stored uncompressed
+    cv::Size poolFrameSize(frameWidth, frameHeight);
+    size_t replaySlots = compressReplayBuffer
+        ? static_cast<size_t>(fps)
+        : static_cast<size_t>(bufferSize) + static_cast<size_t>(fps * 2);
+    size_t poolCapacity = replaySlots + encodeQueueCapacity + 8;
+    if (!framePool) {
+        framePool = std::make_shared<FramePool>(poolCapacity, poolFrameSize);
+    } else if (framePool->GetFrameSize() != poolFrameSize) {
+        framePool->Reset(std::max(poolCapacity, framePool->GetCapacity()), poolFrameSize);
+    }
     
     isInitialized = true;
     std::cout << "[VideoRecorder] Initialized with resolution " << width << "x" << height 
@@ -31,6 +104,32 @@ bool VideoRecorder::Initialize(int width, int height, double frameRate) {
     return true;
 }
 
+bool VideoRecorder::Initialize(const DisplayGeometry& geometry, double frameRate) {
+    return Initialize(geometry.width, geometry.height, frameRate);
+}
+
+bool VideoRecorder::ApplyCodecBenchmark() {
+    std::vector<CodecBenchmarkResult> results;
+    std::string benchmarkFile = outputPath + "codec_benchmark.csv";
+    if (!CodecBenchmark::LoadResults(benchmarkFile, results)) {
+        return false;
+    }
+    
+    CodecBenchmarkResult recommendation;
+    if (!CodecBenchmark::Recommend(results, cv::Size(frameWidth, frameHeight), fps, recommendation)) {
+        std::cerr << "[VideoRecorder] No usable codec in " << benchmarkFile << ", keeping defaults" << std::endl;
+        return false;
+    }
+    
+    codec = recommendation.fourcc;
+    writerApi = recommendation.backendApi;
+    containerExtension = recommendation.extension;
+    std::cout << "[VideoRecorder] Using benchmarked codec " << recommendation.backend << "/" << recommendation.codec
+              << " (" << recommendation.encodeFps << " FPS encode, " << recommendation.bitrateMbps << " Mbps, "
+              << recommendation.psnr << " dB)" << std::endl;
+    return true;
+}
+
 void VideoRecorder::SetOutputPath(const std::string& path) {
     outputPath = path;
     if (!outputPath.empty() && outputPath.back() != '/') {
@@ -47,6 +146,41 @@ void VideoRecorder::SetBufferSize(int size) {
     std::cout << "[VideoRecorder] Buffer size set to " << bufferSize << " frames" << std::endl;
 }
 
+void VideoRecorder::SetReplayDuration(double seconds) {
+    replayDuration = std::max(1.0, seconds);
+    std::cout << "[VideoRecorder] Replay duration set to " << replayDuration << " seconds" << std::endl;
+}
+
+void VideoRecorder::SetFramePool(std::shared_ptr<FramePool> pool) {
+    framePool = pool;
+    if (framePool) {
+        std::cout << "[VideoRecorder] Using shared frame pool (" << framePool->GetCapacity() << " frames)" << std::endl;
+    }
+}
+
+std::shared_ptr<FramePool> VideoRecorder::GetFramePool() const {
+    return framePool;
+}
+
+void VideoRecorder::SetReplayBudget(size_t megabytes) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    replayBudgetBytes = megabytes * 1024 * 1024;
+    
+    if (replayBudgetBytes > 0) {
+        std::cout << "[VideoRecorder] Replay buffer budget set to " << megabytes << " MB" << std::endl;
+    } else {
+        std::cout << "[VideoRecorder] Replay buffer budget disabled, bounded by " << bufferSize << " frames" << std::endl;
+    }
+}
+
+void VideoRecorder::SetReplayCompression(bool enabled, int jpegQuality) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    compressReplayBuffer = enabled;
+    replayJpegQuality = std::max(1, std::min(100, jpegQuality));
+    std::cout << "[VideoRecorder] Replay compression " << (enabled ? "enabled" : "disabled")
+              << " (JPEG quality " << replayJpegQuality << ")" << std::endl;
+}
+
 bool VideoRecorder::StartRecording(const std::string& filename) {
     if (!isInitialized) {
         std::cerr << "[VideoRecorder] Not initialized" << std::endl;
@@ -60,30 +194,183 @@ bool VideoRecorder::StartRecording(const std::string& filename) {
     
     currentFilename = outputPath + filename;
     
-    videoWriter.open(currentFilename, codec, fps, cv::Size(frameWidth, frameHeight));
+    videoWriter.open(currentFilename, writerApi, codec, fps, cv::Size(frameWidth, frameHeight));
     
     if (!videoWriter.isOpened()) {
         std::cerr << "[VideoRecorder] Failed to open video file: " << currentFilename << std::endl;
         return false;
     }
     
+    isSegmented = false;
+    isRawRecording = false;
+    overlaySidecar.Open(OverlaySidecar::SidecarFilenameFor(currentFilename));
+    timestampIndex.Open(FrameTimestampIndex::IndexFilenameFor(currentFilename));
+    if (writeProxy) {
+        StartProxyEncoder(currentFilename);
+    }
+    StartEncoder();
+    
+    isRecording = true;
+    std::cout << "[VideoRecorder] Started recording to " << currentFilename
+              << " (encoder queue " << encodeQueueCapacity << " frames, "
+              << BackpressurePolicyToString(backpressurePolicy) << ")" << std::endl;
+    
+    return true;
+}
+
+bool VideoRecorder::StartSegmentedRecording(const std::string& prefix, double segmentSeconds) {
+    if (!isInitialized) {
+        std::cerr << "[VideoRecorder] Not initialized" << std::endl;
+        return false;
+    }
+    
+    if (isRecording) {
+        std::cerr << "[VideoRecorder] Already recording" << std::endl;
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        segmentPrefix = prefix;
+        segmentDuration = std::max(0.5, segmentSeconds);
+        segments.clear();
+        pendingManifests.clear();
+        currentSegment = RecordingSegment();
+        currentSegment.index = -1;
+    }
+    
+    // Segments are opened by the encoder as frames arrive, each one starting on a keyframe
+    currentFilename = outputPath + prefix + "_segments.csv";
+    std::ofstream indexFile(currentFilename);
+    if (!indexFile.is_open()) {
+        std::cerr << "[VideoRecorder] Failed to create segment index: " << currentFilename << std::endl;
+        return false;
+    }
+    indexFile << "index,filename,start_time,end_time,frame_count\n";
+    indexFile.close();
+    
+    isSegmented = true;
+    isRawRecording = false;
+    if (writeProxy) {
+        StartProxyEncoder(outputPath + prefix + containerExtension);
+    }
+    StartEncoder();
+    
+    isRecording = true;
+    std::cout << "[VideoRecorder] Started segmented recording " << prefix << " ("
+              << segmentDuration << "s segments, index " << currentFilename << ")" << std::endl;
+    
+    return true;
+}
+
+bool VideoRecorder::StartRawRecording(const std::string& filename, double preallocateSeconds) {
+    if (!isInitialized) {
+        std::cerr << "[VideoRecorder] Not initialized" << std::endl;
+        return false;
+    }
+    
+    if (isRecording) {
+        std::cerr << "[VideoRecorder] Already recording" << std::endl;
+        return false;
+    }
+    
+    currentFilename = outputPath + filename;
+    size_t preallocateFrames = static_cast<size_t>(std::max(0.0, preallocateSeconds) * fps);
+    if (!rawWriter.Open(currentFilename, cv::Size(frameWidth, frameHeight), CV_8UC3, preallocateFrames)) {
+        std::cerr << "[VideoRecorder] Failed to open raw frame file: " << currentFilename << std::endl;
+        return false;
+    }
+    
+    // Training data must keep every pixel, so never trade resolution for throughput
+    if (backpressurePolicy == BackpressurePolicy::DEGRADE_RESOLUTION) {
+        SetBackpressurePolicy(BackpressurePolicy::BLOCK);
+    }
+    
+    isSegmented = false;
+    isRawRecording = true;
+    pendingRawFrames.clear();
+    rawFramesCommitted = 0;
+    overlaySidecar.Open(OverlaySidecar::SidecarFilenameFor(currentFilename));
+    timestampIndex.Open(FrameTimestampIndex::IndexFilenameFor(currentFilename));
+    if (writeProxy) {
+        StartProxyEncoder(currentFilename.substr(0, currentFilename.rfind('.')) + containerExtension);
+    }
+    StartEncoder();
+    
     isRecording = true;
-    std::cout << "[VideoRecorder] Started recording to " << currentFilename << std::endl;
+    std::cout << "[VideoRecorder] Started raw recording to " << currentFilename
+              << " (encoder queue " << encodeQueueCapacity << " frames, "
+              << BackpressurePolicyToString(backpressurePolicy) << ")" << std::endl;
     
     return true;
 }
 
+RawFrameWriterStats VideoRecorder::GetRawWriterStats() const {
+    std::lock_guard<std::mutex> lock(encoderMutex);
+    return rawWriterStats;
+}
+
+void VideoRecorder::StartEncoder() {
+    {
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        encodeQueue.clear();
+        encodeQueuePixels = 0;
+        encoderStats = EncoderStats();
+        encodeTotalMs = 0.0;
+        encodeCpuSeconds = 0.0;
+        encodedFrameBytes = 0.0;
+        rawWriterStats = RawFrameWriterStats();
+        stopEncoderThread = false;
+        recordingStartTime = std::chrono::steady_clock::now();
+    }
+    encoderThread = std::thread(&VideoRecorder::EncoderWorker, this);
+}
+
 void VideoRecorder::StopRecording() {
     if (!isRecording) {
         return;
     }
     
-    WriteBufferedFrames();
+    // The encoder drains whatever is still queued before it exits
+    {
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        stopEncoderThread = true;
+    }
+    encoderCondition.notify_all();
+    encoderSpaceCondition.notify_all();
+    
+    if (encoderThread.joinable()) {
+        encoderThread.join();
+    }
     
+    if (isSegmented) {
+        CloseSegment();
+    }
     videoWriter.release();
+    if (isRawRecording) {
+        rawWriter.Close();
+        CommitRawFrames();
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        rawWriterStats = rawWriter.GetStats();
+    }
+    overlaySidecar.Close();
+    timestampIndex.Close();
+    StopProxyEncoder();
     
     isRecording = false;
-    std::cout << "[VideoRecorder] Stopped recording. File saved: " << currentFilename << std::endl;
+    std::cout << "[VideoRecorder] Stopped recording. File saved: " << currentFilename
+              << " (" << encoderStats.framesEncoded << " frames encoded, "
+              << encoderStats.framesDropped << " dropped)" << std::endl;
+    
+    // Clips that ran past the end of the recording keep what was captured
+    std::vector<ClipManifest> unresolved;
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        unresolved.swap(pendingManifests);
+    }
+    for (const auto& manifest : unresolved) {
+        SaveSegmentClip(manifest.startTime, manifest.endTime, manifest.filename);
+    }
 }
 
 bool VideoRecorder::IsRecording() const {
@@ -91,89 +378,968 @@ bool VideoRecorder::IsRecording() const {
 }
 
 void VideoRecorder::AddFrame(const cv::Mat& frame, double timestamp) {
-    if (!isRecording) {
+    AddFrameWithOverlay(frame, OverlaySidecar::FromPositions(timestamp, std::vector<cv::Point2f>(), frame.size()));
+}
+
+void VideoRecorder::AddFrameWithEnemies(const cv::Mat& frame, double timestamp, const std::vector<cv::Point2f>& enemyPositions) {
+    AddFrameWithOverlay(frame, OverlaySidecar::FromPositions(timestamp, enemyPositions, frame.size()));
+}
+
+void VideoRecorder::AddFrameWithOverlay(const cv::Mat& frame, const OverlayFrame& overlay) {
+    if (!isRecording && !isBuffering) {
         return;
     }
     
-    cv::Mat resizedFrame;
-    if (frame.cols != frameWidth || frame.rows != frameHeight) {
-        cv::resize(frame, resizedFrame, cv::Size(frameWidth, frameHeight));
+    FrameBuffer bufferFrame;
+    bufferFrame.timestamp = overlay.timestamp;
+    bufferFrame.sequence = 0;
+    if (!OverlaySidecar::IsEmpty(overlay)) {
+        bufferFrame.overlay = std::make_shared<const OverlayFrame>(overlay);
+    }
+    
+    bool sizeMatches = frame.cols == frameWidth && frame.rows == frameHeight;
+    
+    if (framePool && sizeMatches && framePool->Owns(frame)) {
+        // Pooled frames are immutable once handed over, so the buffer and
+        // encoder hold another reference instead of a copy
+        bufferFrame.frame = frame;
+    } else if (framePool) {
+        bufferFrame.frame = framePool->CopyIn(frame);
+    } else if (!sizeMatches) {
+        cv::resize(frame, bufferFrame.frame, cv::Size(frameWidth, frameHeight));
     } else {
-        resizedFrame = frame.clone();
+        bufferFrame.frame = frame.clone();
     }
     
-    videoWriter.write(resizedFrame);
+    if (isRecording) {
+        EnqueueForEncoding(bufferFrame);
+    }
     
-    AddFrameToBuffer(resizedFrame, timestamp);
+    if (isBuffering) {
+        AddFrameToBuffer(bufferFrame);
+    }
 }
 
-void VideoRecorder::AddFrameWithEnemies(const cv::Mat& frame, double timestamp, const std::vector<cv::Point2f>& enemyPositions) {
-    if (!isRecording) {
+const cv::Mat& VideoRecorder::RenderFrame(const FrameBuffer& bufferFrame, cv::Mat& scratch) {
+    // Compressed replay frames are only decoded when a clip is written
+    if (bufferFrame.frame.empty() && !bufferFrame.encoded.empty()) {
+        cv::imdecode(bufferFrame.encoded, cv::IMREAD_COLOR, &scratch);
+        
+        if (burnInOverlays && bufferFrame.overlay) {
+            OverlaySidecar::Render(scratch, *bufferFrame.overlay);
+        }
+        return scratch;
+    }
+    
+    // Overlays normally live in the sidecar, so most frames go out untouched
+    bool sizeMatches = bufferFrame.frame.cols == frameWidth && bufferFrame.frame.rows == frameHeight;
+    bool drawOverlay = burnInOverlays && bufferFrame.overlay;
+    if (!drawOverlay && sizeMatches) {
+        return bufferFrame.frame;
+    }
+    
+    // The buffer is shared with the replay buffer and other holders, so
+    // annotations go onto a scratch frame that is reused between writes
+    if (sizeMatches) {
+        bufferFrame.frame.copyTo(scratch);
+        if (framePool) {
+            framePool->RecordCopy();
+        }
+    } else {
+        // Degraded frames are scaled back up so the stream keeps one resolution
+        cv::resize(bufferFrame.frame, scratch, cv::Size(frameWidth, frameHeight), 0, 0, cv::INTER_NEAREST);
+    }
+    
+    if (drawOverlay) {
+        OverlaySidecar::Render(scratch, *bufferFrame.overlay);
+    }
+    
+    return scratch;
+}
+
+void VideoRecorder::AddFrameToBuffer(const FrameBuffer& incomingFrame) {
+    double timestamp = incomingFrame.timestamp;
+    
+    bool clipReady = false;
+    bool compress = false;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        
+        FrameBuffer bufferFrame = incomingFrame;
+        bufferFrame.sequence = nextBufferSequence++;
+        
+        frameBuffer.push_back(bufferFrame);
+        bufferedBytes += StoredBytes(bufferFrame);
+        TrimBuffer(timestamp);
+        
+        if (compressReplayBuffer) {
+            compressionQueue.push_back(bufferFrame);
+            compress = true;
+        }
+        
+        for (auto it = pendingClips.begin(); it != pendingClips.end();) {
+            if (timestamp >= it->startTime && timestamp <= it->endTime) {
+                it->frames.push_back(bufferFrame);
+            }
+            
+            if (timestamp >= it->endTime) {
+                readyClips.push_back(std::move(*it));
+                it = pendingClips.erase(it);
+                clipReady = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    if (compress) {
+        compressionCondition.notify_one();
+    }
+    
+    if (clipReady) {
+        clipCondition.notify_one();
+    }
+}
+
+void VideoRecorder::TrimBuffer(double newestTimestamp) {
+    // With a budget the buffer is bounded by bytes, so history grows as frames
+    // compress. Without one it falls back to a fixed frame count.
+    while (frameBuffer.size() > 1) {
+        bool overBudget = replayBudgetBytes > 0
+            ? bufferedBytes > replayBudgetBytes
+            : frameBuffer.size() > static_cast<size_t>(bufferSize);
+        bool tooOld = newestTimestamp - frameBuffer.front().timestamp > replayDuration;
+        
+        if (!overBudget && !tooOld) {
+            break;
+        }
+        
+        bufferedBytes -= StoredBytes(frameBuffer.front());
+        frameBuffer.pop_front();
+    }
+}
+
+void VideoRecorder::CompressionWorker() {
+    std::vector<uchar> encoded;
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    
+    while (true) {
+        compressionCondition.wait(lock, [this] { return stopCompressionThreads || !compressionQueue.empty(); });
+        
+        if (stopCompressionThreads) {
+            break;
+        }
+        
+        FrameBuffer job = std::move(compressionQueue.front());
+        compressionQueue.pop_front();
+        
+        // Evicted before a worker got to it
+        if (frameBuffer.empty() || job.sequence < frameBuffer.front().sequence) {
+            continue;
+        }
+        
+        std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, replayJpegQuality};
+        lock.unlock();
+        
+        auto compressStart = std::chrono::steady_clock::now();
+        bool encodedOk = cv::imencode(".jpg", job.frame, encoded, params);
+        double compressMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - compressStart).count();
+        job.frame.release();
+        
+        lock.lock();
+        
+        compressedFrameCount++;
+        compressTotalMs += compressMs;
+        
+        if (!encodedOk || frameBuffer.empty() || job.sequence < frameBuffer.front().sequence) {
+            continue;
+        }
+        
+        // Sequence numbers are contiguous, so the entry is found by offset
+        FrameBuffer& entry = frameBuffer[job.sequence - frameBuffer.front().sequence];
+        bufferedBytes -= StoredBytes(entry);
+        entry.encoded = encoded;
+        entry.frame.release();
+        bufferedBytes += StoredBytes(entry);
+        
+        // Clips still collecting post-roll hold their own copy of the entry
+        for (auto& request : pendingClips) {
+            if (request.frames.empty() || job.sequence < request.frames.front().sequence) {
+                continue;
+            }
+            
+            size_t offset = job.sequence - request.frames.front().sequence;
+            if (offset < request.frames.size() && request.frames[offset].sequence == job.sequence) {
+                request.frames[offset].encoded = encoded;
+                request.frames[offset].frame.release();
+            }
+        }
+
+    }
+}
+
+void VideoRecorder::EnqueueForEncoding(const FrameBuffer& bufferFrame) {
+    // The queue is bounded by pixels rather than frames, so a degraded frame
+    // takes a quarter of a slot and the queue rides out longer encoder stalls
+    const size_t slotPixels = static_cast<size_t>(frameWidth) * frameHeight;
+    const size_t capacityPixels = encodeQueueCapacity * slotPixels;
+    
+    bool degrade = false;
+    if (backpressurePolicy == BackpressurePolicy::DEGRADE_RESOLUTION) {
+        std::lock_guard<std::mutex> lock(encoderMutex);
+        degrade = encodeQueuePixels >= capacityPixels / 2;
+    }
+    
+    FrameBuffer queuedFrame = bufferFrame;
+    if (degrade) {
+        cv::resize(bufferFrame.frame, queuedFrame.frame, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+    }
+    
+    std::unique_lock<std::mutex> lock(encoderMutex);
+    encoderStats.framesSubmitted++;
+    if (degrade) {
+        encoderStats.framesDegraded++;
+    }
+    
+    if (encodeQueuePixels + queuedFrame.frame.total() > capacityPixels) {
+        switch (backpressurePolicy) {
+            case BackpressurePolicy::BLOCK: {
+                auto waitStart = std::chrono::steady_clock::now();
+                encoderSpaceCondition.wait(lock, [&] {
+                    return stopEncoderThread || encodeQueuePixels + queuedFrame.frame.total() <= capacityPixels;
+                });
+                encoderStats.blockedMs += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - waitStart).count();
+                break;
+            }
+            case BackpressurePolicy::DROP_NEWEST:
+                encoderStats.framesDropped++;
+                return;
+            case BackpressurePolicy::DROP_OLDEST:
+            case BackpressurePolicy::DEGRADE_RESOLUTION:
+                // Even half-resolution frames no longer fit, so shed the stalest ones
+                while (!encodeQueue.empty() && encodeQueuePixels + queuedFrame.frame.total() > capacityPixels) {
+                    encodeQueuePixels -= encodeQueue.front().frame.total();
+                    encodeQueue.pop_front();
+                    encoderStats.framesDropped++;
+                }
+                break;
+        }
+    }
+    
+    encodeQueuePixels += queuedFrame.frame.total();
+    encodeQueue.push_back(queuedFrame);
+    encoderStats.maxQueueDepth = std::max(encoderStats.maxQueueDepth, encodeQueue.size());
+    lock.unlock();
+    
+    encoderCondition.notify_one();
+}
+
+void VideoRecorder::EncoderWorker() {
+    cv::Mat scratch;
+    std::unique_lock<std::mutex> lock(encoderMutex);
+    
+    while (true) {
+        encoderCondition.wait(lock, [this] { return stopEncoderThread || !encodeQueue.empty(); });
+        
+        if (encodeQueue.empty()) {
+            break;
+        }
+        
+        FrameBuffer bufferFrame = std::move(encodeQueue.front());
+        encodeQueue.pop_front();
+        encodeQueuePixels -= bufferFrame.frame.total();
+        
+        lock.unlock();
+        encoderSpaceCondition.notify_one();
+        
+        if (isSegmented &&
+            (currentSegment.index < 0 || bufferFrame.timestamp >= currentSegment.startTime + segmentDuration)) {
+            CloseSegment();
+            OpenSegment(bufferFrame.timestamp);
+        }
+        
+        const cv::Mat& renderedFrame = RenderFrame(bufferFrame, scratch);
+        OverlayFrame record = bufferFrame.overlay
+            ? *bufferFrame.overlay
+            : OverlaySidecar::FromPositions(bufferFrame.timestamp, std::vector<cv::Point2f>(), renderedFrame.size());
+        
+        double cpuStart = RawFrameWriter::ThreadCpuSeconds();
+        auto encodeStart = std::chrono::steady_clock::now();
+        if (isRawRecording) {
+            // Raw frames are staged and written in batches, so their records
+            // wait until the batch reaches the container
+            pendingRawFrames.push_back(record);
+            rawWriter.Append(renderedFrame, bufferFrame.timestamp);
+        } else {
+            videoWriter.write(renderedFrame);
+        }
+        if (encoderThrottleMs > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(encoderThrottleMs));
+        }
+        auto encodeEnd = std::chrono::steady_clock::now();
+        double cpuSeconds = RawFrameWriter::ThreadCpuSeconds() - cpuStart;
+        double frameBytes = static_cast<double>(renderedFrame.total() * renderedFrame.elemSize());
+        
+        if (writeProxy && proxyThread.joinable()) {
+            EnqueueProxyFrame(renderedFrame, bufferFrame.timestamp);
+        }
+        
+        if (isRawRecording) {
+            CommitRawFrames();
+        } else {
+            WriteFrameRecords(record, static_cast<uint32_t>(isSegmented ? currentSegment.frameCount : encoderStats.framesEncoded));
+        }
+        
+        if (isSegmented) {
+            std::lock_guard<std::mutex> segmentLock(segmentMutex);
+            currentSegment.endTime = bufferFrame.timestamp + 1.0 / fps;
+            currentSegment.frameCount++;
+        }
+        
+        // Hand the buffer back to the pool before waiting for the next frame
+        bufferFrame.frame.release();
+        
+        lock.lock();
+        
+        if (!isRawRecording) {
+            encoderStats.framesEncoded++;
+        }
+        encodeTotalMs += std::chrono::duration<double, std::milli>(encodeEnd - encodeStart).count();
+        encodeCpuSeconds += cpuSeconds;
+        encodedFrameBytes += frameBytes;
+        if (isRawRecording) {
+            rawWriterStats = rawWriter.GetStats();
+        }
+        
+        double elapsedSeconds = std::chrono::duration<double>(encodeEnd - recordingStartTime).count();
+        if (elapsedSeconds > 0.0) {
+            encoderStats.encoderFps = encoderStats.framesEncoded / elapsedSeconds;
+        }
+    }
+}
+
+void VideoRecorder::WriteFrameRecords(OverlayFrame record, uint32_t frameNumber) {
+    if (overlaySidecar.IsOpen()) {
+        record.frameNumber = frameNumber;
+        overlaySidecar.Append(record);
+    }
+    
+    // The writer assumes constant fps, so keep the real capture time of every frame
+    if (timestampIndex.IsOpen()) {
+        timestampIndex.Append(frameNumber, record.timestamp);
+    }
+}
+
+void VideoRecorder::CommitRawFrames() {
+    size_t framesWritten = rawWriter.GetStats().framesWritten;
+    size_t committed = 0;
+    while (rawFramesCommitted < framesWritten && !pendingRawFrames.empty()) {
+        WriteFrameRecords(pendingRawFrames.front(), static_cast<uint32_t>(rawFramesCommitted));
+        pendingRawFrames.pop_front();
+        rawFramesCommitted++;
+        committed++;
+    }
+    
+    // Whatever is neither on disk nor staged was rejected by the writer or
+    // lost with a failed batch, and those are always the newest frames
+    size_t lost = 0;
+    while (pendingRawFrames.size() > rawWriter.GetStagedFrameCount()) {
+        pendingRawFrames.pop_back();
+        lost++;
+    }
+    
+    std::lock_guard<std::mutex> lock(encoderMutex);
+    encoderStats.framesEncoded += committed;
+    encoderStats.framesDropped += lost;
+}
+
+void VideoRecorder::EnableProxy(double scale, double thumbnailSeconds) {
+    if (isRecording) {
+        std::cerr << "[VideoRecorder] Proxy settings apply from the next recording" << std::endl;
+    }
+    
+    writeProxy = true;
+    proxyScale = std::max(0.05, std::min(1.0, scale));
+    thumbnailInterval = std::max(0.0, thumbnailSeconds);
+    
+    std::cout << "[VideoRecorder] Review proxy enabled at " << static_cast<int>(frameWidth * proxyScale) << "x"
+              << static_cast<int>(frameHeight * proxyScale);
+    if (thumbnailInterval > 0.0) {
+        std::cout << ", thumbnail every " << thumbnailInterval << "s";
+    }
+    std::cout << std::endl;
+}
+
+void VideoRecorder::DisableProxy() {
+    writeProxy = false;
+    std::cout << "[VideoRecorder] Review proxy disabled" << std::endl;
+}
+
+std::string VideoRecorder::GetProxyFilename() const {
+    return proxyFilename;
+}
+
+std::string VideoRecorder::ProxyFilenameFor(const std::string& masterFilename) {
+    size_t dot = masterFilename.rfind('.');
+    size_t slash = masterFilename.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return masterFilename + "_proxy.mp4";
+    }
+    return masterFilename.substr(0, dot) + "_proxy" + masterFilename.substr(dot);
+}
+
+std::string VideoRecorder::ThumbnailStripFilenameFor(const std::string& masterFilename) {
+    size_t dot = masterFilename.rfind('.');
+    size_t slash = masterFilename.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return masterFilename + "_thumbs.jpg";
+    }
+    return masterFilename.substr(0, dot) + "_thumbs.jpg";
+}
+
+bool VideoRecorder::StartProxyEncoder(const std::string& masterFilename) {
+    cv::Size proxySize(std::max(2, static_cast<int>(frameWidth * proxyScale)) & ~1,
+                       std::max(2, static_cast<int>(frameHeight * proxyScale)) & ~1);
+    
+    proxyFilename = ProxyFilenameFor(masterFilename);
+    thumbnailStripFilename = ThumbnailStripFilenameFor(masterFilename);
+    proxyWriter.open(proxyFilename, writerApi, codec, fps, proxySize);
+    if (!proxyWriter.isOpened()) {
+        std::cerr << "[VideoRecorder] Failed to open proxy file: " << proxyFilename << std::endl;
+        proxyFilename.clear();
+        return false;
+    }
+    
+    if (!proxyPool || proxyPool->GetFrameSize() != proxySize) {
+        proxyPool = std::make_unique<FramePool>(encodeQueueCapacity + 4, proxySize);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(proxyMutex);
+        proxyQueue.clear();
+        thumbnails.clear();
+        lastThumbnailTime = -thumbnailInterval;
+        proxyFramesWritten = 0;
+        proxyFramesDropped = 0;
+        stopProxyThread = false;
+    }
+    proxyThread = std::thread(&VideoRecorder::ProxyWorker, this);
+    
+    std::cout << "[VideoRecorder] Writing review proxy " << proxyFilename << " at "
+              << proxySize.width << "x" << proxySize.height << std::endl;
+    return true;
+}
+
+void VideoRecorder::StopProxyEncoder() {
+    if (!proxyThread.joinable()) {
         return;
     }
     
-    cv::Mat annotatedFrame = frame.clone();
+    {
+        std::lock_guard<std::mutex> lock(proxyMutex);
+        stopProxyThread = true;
+    }
+    proxyCondition.notify_all();
+    proxyThread.join();
+    
+    proxyWriter.release();
     
-    for (const auto& pos : enemyPositions) {
-        cv::circle(annotatedFrame, pos, 5, cv::Scalar(0, 255, 0), -1);
-        cv::circle(annotatedFrame, pos, 15, cv::Scalar(0, 255, 0), 2);
+    if (!thumbnails.empty()) {
+        SaveThumbnailStrip();
     }
     
-    AddFrame(annotatedFrame, timestamp);
+    std::cout << "[VideoRecorder] Proxy saved: " << proxyFilename << " (" << proxyFramesWritten
+              << " frames, " << proxyFramesDropped << " dropped)" << std::endl;
 }
 
-void VideoRecorder::AddFrameToBuffer(const cv::Mat& frame, double timestamp) {
-    FrameBuffer bufferFrame;
-    bufferFrame.frame = frame.clone();
-    bufferFrame.timestamp = timestamp;
+void VideoRecorder::EnqueueProxyFrame(const cv::Mat& renderedFrame, double timestamp) {
+    // The one downscale feeds both the proxy encoder and the thumbnail strip
+    FrameBuffer proxyFrame;
+    proxyFrame.frame = proxyPool->Acquire();
+    proxyFrame.timestamp = timestamp;
+    proxyFrame.sequence = 0;
+    cv::resize(renderedFrame, proxyFrame.frame, proxyPool->GetFrameSize(), 0, 0, cv::INTER_AREA);
+    
+    {
+        std::lock_guard<std::mutex> lock(proxyMutex);
+        
+        // The proxy is best effort and must never hold back the master
+        if (proxyQueue.size() >= encodeQueueCapacity) {
+            proxyQueue.pop_front();
+            proxyFramesDropped++;
+        }
+        proxyQueue.push_back(proxyFrame);
+    }
+    proxyCondition.notify_one();
+}
+
+void VideoRecorder::ProxyWorker() {
+    const size_t maxThumbnails = 256;
+    const int thumbnailHeight = 90;
+    
+    std::unique_lock<std::mutex> lock(proxyMutex);
+    
+    while (true) {
+        proxyCondition.wait(lock, [this] { return stopProxyThread || !proxyQueue.empty(); });
+        
+        if (proxyQueue.empty()) {
+            break;
+        }
+        
+        FrameBuffer proxyFrame = std::move(proxyQueue.front());
+        proxyQueue.pop_front();
+        
+        lock.unlock();
+        
+        proxyWriter.write(proxyFrame.frame);
+        
+        bool takeThumbnail = thumbnailInterval > 0.0 && thumbnails.size() < maxThumbnails &&
+                             proxyFrame.timestamp - lastThumbnailTime >= thumbnailInterval;
+        if (takeThumbnail) {
+            cv::Mat thumbnail;
+            int thumbnailWidth = proxyFrame.frame.cols * thumbnailHeight / std::max(1, proxyFrame.frame.rows);
+            cv::resize(proxyFrame.frame, thumbnail, cv::Size(thumbnailWidth, thumbnailHeight), 0, 0, cv::INTER_AREA);
+            thumbnails.push_back(thumbnail);
+            lastThumbnailTime = proxyFrame.timestamp;
+        }
+        
+        proxyFrame.frame.release();
+        
+        lock.lock();
+        proxyFramesWritten++;
+    }
+}
+
+bool VideoRecorder::SaveThumbnailStrip() {
+    cv::Mat strip;
+    cv::hconcat(thumbnails, strip);
+    
+    if (!cv::imwrite(thumbnailStripFilename, strip)) {
+        std::cerr << "[VideoRecorder] Failed to save thumbnail strip: " << thumbnailStripFilename << std::endl;
+        return false;
+    }
+    
+    std::cout << "[VideoRecorder] Saved thumbnail strip " << thumbnailStripFilename << " (" << thumbnails.size()
+              << " thumbnails)" << std::endl;
+    thumbnails.clear();
+    return true;
+}
+
+bool VideoRecorder::OpenSegment(double timestamp) {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    
+    std::ostringstream name;
+    name << segmentPrefix << "_seg" << std::setw(5) << std::setfill('0') << segments.size() << containerExtension;
     
-    frameBuffer.push(bufferFrame);
+    currentSegment = RecordingSegment();
+    currentSegment.index = static_cast<int>(segments.size());
+    currentSegment.filename = name.str();
+    currentSegment.startTime = timestamp;
+    currentSegment.endTime = timestamp;
+    currentSegment.frameCount = 0;
     
-    while (frameBuffer.size() > bufferSize) {
-        frameBuffer.pop();
+    videoWriter.open(outputPath + currentSegment.filename, writerApi, codec, fps, cv::Size(frameWidth, frameHeight));
+    if (!videoWriter.isOpened()) {
+        std::cerr << "[VideoRecorder] Failed to open segment: " << currentSegment.filename << std::endl;
+        return false;
     }
+    
+    // Each segment gets its own sidecars so frame numbers match the file
+    overlaySidecar.Open(OverlaySidecar::SidecarFilenameFor(outputPath + currentSegment.filename));
+    timestampIndex.Open(FrameTimestampIndex::IndexFilenameFor(outputPath + currentSegment.filename));
+    return true;
 }
 
-void VideoRecorder::WriteBufferedFrames() {
-    std::cout << "[VideoRecorder] Writing " << frameBuffer.size() << " buffered frames" << std::endl;
+void VideoRecorder::CloseSegment() {
+    std::vector<ClipManifest> readyManifests;
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        
+        if (currentSegment.index < 0 || currentSegment.frameCount == 0) {
+            return;
+        }
+        
+        videoWriter.release();
+        overlaySidecar.Close();
+        timestampIndex.Close();
+        segments.push_back(currentSegment);
+        
+        std::ofstream indexFile(outputPath + segmentPrefix + "_segments.csv", std::ios::app);
+        indexFile << currentSegment.index << "," << currentSegment.filename << ","
+                  << std::fixed << std::setprecision(3) << currentSegment.startTime << ","
+                  << currentSegment.endTime << "," << currentSegment.frameCount << "\n";
+        
+        currentSegment.index = -1;
+        
+        // Clips whose range is now fully on disk can be resolved to segments
+        for (auto it = pendingManifests.begin(); it != pendingManifests.end();) {
+            if (it->endTime <= segments.back().endTime) {
+                readyManifests.push_back(*it);
+                it = pendingManifests.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
     
-    while (!frameBuffer.empty()) {
-        const auto& bufferFrame = frameBuffer.front();
-        videoWriter.write(bufferFrame.frame);
-        frameBuffer.pop();
+    for (const auto& manifest : readyManifests) {
+        SaveSegmentClip(manifest.startTime, manifest.endTime, manifest.filename);
     }
 }
 
-void VideoRecorder::ClearBuffer() {
-    while (!frameBuffer.empty()) {
-        frameBuffer.pop();
+bool VideoRecorder::SaveSegmentClip(double startTime, double endTime, const std::string& filename) {
+    if (endTime <= startTime) {
+        std::cerr << "[VideoRecorder] Invalid clip range " << startTime << "s - " << endTime << "s" << std::endl;
+        return false;
+    }
+    
+    ClipManifest manifest;
+    manifest.filename = filename;
+    manifest.startTime = startTime;
+    manifest.endTime = endTime;
+    
+    {
+        std::lock_guard<std::mutex> lock(segmentMutex);
+        
+        if (!isSegmented && segments.empty()) {
+            std::cerr << "[VideoRecorder] No segmented recording to clip from" << std::endl;
+            return false;
+        }
+        
+        // The tail of the range is still being encoded, resolve it once its segment closes
+        if (segments.empty() || endTime > segments.back().endTime) {
+            if (isRecording) {
+                pendingManifests.push_back(manifest);
+                std::cout << "[VideoRecorder] Clip " << filename << " waiting for segment covering " << endTime << "s" << std::endl;
+                return true;
+            }
+        }
+        
+        for (const auto& segment : segments) {
+            if (segment.endTime <= startTime || segment.startTime >= endTime) {
+                continue;
+            }
+            
+            ClipSegmentRef ref;
+            ref.filename = segment.filename;
+            ref.inPoint = std::max(0.0, startTime - segment.startTime);
+            ref.outPoint = std::min(segment.endTime, endTime) - segment.startTime;
+            manifest.segments.push_back(ref);
+        }
+    }
+    
+    if (manifest.segments.empty()) {
+        std::cerr << "[VideoRecorder] No recorded segments cover " << startTime << "s - " << endTime << "s" << std::endl;
+        return false;
+    }
+    
+    return WriteManifest(manifest);
+}
+
+bool VideoRecorder::WriteManifest(const ClipManifest& manifest) {
+    std::string path = outputPath + manifest.filename;
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "[VideoRecorder] Failed to write clip manifest: " << path << std::endl;
+        return false;
+    }
+    
+    file << "ffconcat version 1.0\n";
+    file << std::fixed << std::setprecision(3);
+    file << "# clip " << manifest.startTime << " " << manifest.endTime << "\n";
+    for (const auto& ref : manifest.segments) {
+        file << "file '" << ref.filename << "'\n";
+        if (ref.inPoint > 0.0) {
+            file << "inpoint " << ref.inPoint << "\n";
+        }
+        file << "outpoint " << ref.outPoint << "\n";
+    }
+    
+    std::cout << "[VideoRecorder] Saved clip manifest " << manifest.filename << " (" << manifest.segments.size()
+              << " segments, " << manifest.startTime << "s - " << manifest.endTime << "s)" << std::endl;
+    return true;
+}
+
+std::vector<RecordingSegment> VideoRecorder::GetSegments() const {
+    std::lock_guard<std::mutex> lock(segmentMutex);
+    return segments;
+}
+
+std::vector<RecordingSegment> VideoRecorder::LoadSegmentIndex(const std::string& filename) {
+    std::vector<RecordingSegment> loaded;
+    
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "[VideoRecorder] Failed to open segment index: " << filename << std::endl;
+        return loaded;
+    }
+    
+    std::string line;
+    std::getline(file, line); // Skip header
+    
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string token;
+        RecordingSegment segment;
+        
+        std::getline(ss, token, ',');
+        segment.index = std::stoi(token);
+        std::getline(ss, segment.filename, ',');
+        std::getline(ss, token, ',');
+        segment.startTime = std::stod(token);
+        std::getline(ss, token, ',');
+        segment.endTime = std::stod(token);
+        std::getline(ss, token, ',');
+        segment.frameCount = std::stoi(token);
+        
+        loaded.push_back(segment);
     }
+    
+    return loaded;
+}
+
+bool VideoRecorder::LoadClipManifest(const std::string& filename, ClipManifest& manifest) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "[VideoRecorder] Failed to open clip manifest: " << filename << std::endl;
+        return false;
+    }
+    
+    manifest = ClipManifest();
+    manifest.filename = filename;
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string directive;
+        ss >> directive;
+        
+        if (directive == "#") {
+            std::string tag;
+            ss >> tag;
+            if (tag == "clip") {
+                ss >> manifest.startTime >> manifest.endTime;
+            }
+        } else if (directive == "file") {
+            ClipSegmentRef ref;
+            size_t open = line.find('\'');
+            size_t close = line.rfind('\'');
+            ref.filename = open != std::string::npos && close > open ? line.substr(open + 1, close - open - 1) : "";
+            ref.inPoint = 0.0;
+            ref.outPoint = 0.0;
+            manifest.segments.push_back(ref);
+        } else if (directive == "inpoint" && !manifest.segments.empty()) {
+            ss >> manifest.segments.back().inPoint;
+        } else if (directive == "outpoint" && !manifest.segments.empty()) {
+            ss >> manifest.segments.back().outPoint;
+        }
+    }
+    
+    return !manifest.segments.empty();
+}
+
+void VideoRecorder::ClearBuffer() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    frameBuffer.clear();
+    compressionQueue.clear();
+    bufferedBytes = 0;
 }
 
 void VideoRecorder::StartBuffering() {
+    isBuffering = true;
     std::cout << "[VideoRecorder] Started buffering frames" << std::endl;
 }
 
 void VideoRecorder::StopBuffering() {
+    isBuffering = false;
     std::cout << "[VideoRecorder] Stopped buffering frames" << std::endl;
-    WriteBufferedFrames();
 }
 
 size_t VideoRecorder::GetBufferSize() const {
+    std::lock_guard<std::mutex> lock(bufferMutex);
     return frameBuffer.size();
 }
 
+ReplayBufferStats VideoRecorder::GetReplayBufferStats() const {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    
+    ReplayBufferStats stats = ReplayBufferStats();
+    stats.frames = frameBuffer.size();
+    stats.bytes = bufferedBytes;
+    stats.budgetBytes = replayBudgetBytes;
+    
+    for (const auto& bufferFrame : frameBuffer) {
+        if (!bufferFrame.encoded.empty()) {
+            stats.compressedFrames++;
+        }
+    }
+    
+    if (frameBuffer.size() > 1) {
+        stats.historySeconds = frameBuffer.back().timestamp - frameBuffer.front().timestamp;
+    }
+    if (bufferedBytes > 0) {
+        stats.secondsPerMB = stats.historySeconds / (bufferedBytes / (1024.0 * 1024.0));
+        stats.averageFrameKB = bufferedBytes / 1024.0 / frameBuffer.size();
+    }
+    stats.averageCompressMs = compressedFrameCount > 0 ? compressTotalMs / compressedFrameCount : 0.0;
+    return stats;
+}
+
+bool VideoRecorder::SaveClip(double startTime, double endTime, const std::string& filename) {
+    if (!isInitialized) {
+        std::cerr << "[VideoRecorder] Not initialized" << std::endl;
+        return false;
+    }
+    
+    if (endTime <= startTime) {
+        std::cerr << "[VideoRecorder] Invalid clip range " << startTime << "s - " << endTime << "s" << std::endl;
+        return false;
+    }
+    
+    ClipRequest request;
+    request.startTime = startTime;
+    request.endTime = endTime;
+    request.filename = outputPath + filename;
+    request.proxyScale = writeProxy ? proxyScale : 0.0;
+    
+    bool clipReady = false;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        
+        if (!frameBuffer.empty() && frameBuffer.front().timestamp > startTime) {
+            std::cout << "[VideoRecorder] Pre-roll truncated to " << frameBuffer.front().timestamp
+                      << "s (requested " << startTime << "s)" << std::endl;
+        }
+        
+        for (const auto& bufferFrame : frameBuffer) {
+            if (bufferFrame.timestamp >= startTime && bufferFrame.timestamp <= endTime) {
+                request.frames.push_back(bufferFrame);
+            }
+        }
+        
+        if (!frameBuffer.empty() && frameBuffer.back().timestamp >= endTime) {
+            readyClips.push_back(std::move(request));
+            clipReady = true;
+        } else {
+            pendingClips.push_back(std::move(request));
+        }
+    }
+    
+    if (clipReady) {
+        clipCondition.notify_one();
+    }
+    
+    std::cout << "[VideoRecorder] Queued clip " << filename << " (" << startTime << "s - " << endTime << "s)" << std::endl;
+    return true;
+}
+
+size_t VideoRecorder::GetPendingClipCount() const {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return pendingClips.size() + readyClips.size();
+}
+
+size_t VideoRecorder::GetSavedClipCount() const {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return savedClipCount;
+}
+
+void VideoRecorder::ClipWorker() {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    
+    while (true) {
+        clipCondition.wait(lock, [this] { return stopClipThread || !readyClips.empty(); });
+        
+        if (readyClips.empty()) {
+            break;
+        }
+        
+        ClipRequest request = std::move(readyClips.front());
+        readyClips.pop_front();
+        
+        lock.unlock();
+        WriteClip(request);
+        lock.lock();
+        
+        savedClipCount++;
+    }
+}
+
+bool VideoRecorder::WriteClip(const ClipRequest& request) {
+    if (request.frames.empty()) {
+        std::cerr << "[VideoRecorder] No buffered frames for clip " << request.filename << std::endl;
+        return false;
+    }
+    
+    cv::VideoWriter clipWriter(request.filename, writerApi, codec, fps, cv::Size(frameWidth, frameHeight));
+    if (!clipWriter.isOpened()) {
+        std::cerr << "[VideoRecorder] Failed to open clip file: " << request.filename << std::endl;
+        return false;
+    }
+    
+    OverlaySidecar clipSidecar;
+    clipSidecar.Open(OverlaySidecar::SidecarFilenameFor(request.filename));
+    FrameTimestampIndex clipTimestamps;
+    clipTimestamps.Open(FrameTimestampIndex::IndexFilenameFor(request.filename));
+    
+    // Clips are written off the capture path, so the proxy is encoded inline
+    // rather than through the best-effort proxy queue
+    cv::VideoWriter clipProxyWriter;
+    cv::Size proxySize;
+    if (request.proxyScale > 0.0) {
+        proxySize = cv::Size(std::max(2, static_cast<int>(frameWidth * request.proxyScale)) & ~1,
+                             std::max(2, static_cast<int>(frameHeight * request.proxyScale)) & ~1);
+        std::string clipProxyFilename = ProxyFilenameFor(request.filename);
+        clipProxyWriter.open(clipProxyFilename, writerApi, codec, fps, proxySize);
+        if (!clipProxyWriter.isOpened()) {
+            std::cerr << "[VideoRecorder] Failed to open clip proxy file: " << clipProxyFilename << std::endl;
+        }
+    }
+    
+    cv::Mat scratch;
+    cv::Mat proxyFrame;
+    for (const auto& bufferFrame : request.frames) {
+        const cv::Mat& renderedFrame = RenderFrame(bufferFrame, scratch);
+        clipWriter.write(renderedFrame);
+        if (clipProxyWriter.isOpened()) {
+            cv::resize(renderedFrame, proxyFrame, proxySize, 0, 0, cv::INTER_AREA);
+            clipProxyWriter.write(proxyFrame);
+        }
+        
+        OverlayFrame record = bufferFrame.overlay
+            ? *bufferFrame.overlay
+            : OverlaySidecar::FromPositions(bufferFrame.timestamp, std::vector<cv::Point2f>(), renderedFrame.size());
+        record.frameNumber = static_cast<uint32_t>(clipSidecar.GetRecordCount());
+        clipSidecar.Append(record);
+        clipTimestamps.Append(record.frameNumber, bufferFrame.timestamp);
+    }
+    clipSidecar.Close();
+    clipTimestamps.Close();
+    clipWriter.release();
+    clipProxyWriter.release();
+    
+    std::cout << "[VideoRecorder] Saved clip " << request.filename << " with " << request.frames.size()
+              << " frames (" << request.frames.front().timestamp << "s - "
+              << request.frames.back().timestamp << "s)" << std::endl;
+    return true;
+}
+
 std::string VideoRecorder::GenerateFilename(const std::string& prefix, double timestamp) {
     auto now = std::chrono::system_clock::now();
     auto time = std::chrono::system_clock::to_time_t(now);
     std::tm tm;
+#ifdef _WIN32
     localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
     
     std::ostringstream oss;
     oss << prefix << "_"
         << std::put_time(&tm, "%Y%m%d_%H%M%S")
         << "_" << std::fixed << std::setprecision(0) << timestamp
-        << ".mp4";
+        << containerExtension;
     
     return oss.str();
 }
@@ -183,9 +1349,85 @@ bool VideoRecorder::SaveFrameAsImage(const cv::Mat& frame, const std::string& fi
     return cv::imwrite(fullPath, frame);
 }
 
-void VideoRecorder::SetCodec(int newCodec) {
+void VideoRecorder::SetBurnInOverlays(bool enabled) {
+    burnInOverlays = enabled;
+    std::cout << "[VideoRecorder] Overlay burn-in " << (enabled ? "enabled" : "disabled")
+              << ", sidecar metadata is always written" << std::endl;
+}
+
+void VideoRecorder::SetCodec(int newCodec, int api, const std::string& extension) {
     codec = newCodec;
-    std::cout << "[VideoRecorder] Codec set to " << codec << std::endl;
+    writerApi = api;
+    containerExtension = extension;
+    codecPinned = true;
+    std::cout << "[VideoRecorder] Codec set to " << codec << " (" << containerExtension << ")" << std::endl;
+}
+
+std::string VideoRecorder::GetContainerExtension() const {
+    return containerExtension;
+}
+
+void VideoRecorder::SetEncodeQueueCapacity(size_t frames) {
+    std::lock_guard<std::mutex> lock(encoderMutex);
+    encodeQueueCapacity = std::max<size_t>(1, frames);
+    std::cout << "[VideoRecorder] Encoder queue capacity set to " << encodeQueueCapacity << " frames" << std::endl;
+}
+
+void VideoRecorder::SetBackpressurePolicy(BackpressurePolicy policy) {
+    std::lock_guard<std::mutex> lock(encoderMutex);
+    backpressurePolicy = policy;
+    std::cout << "[VideoRecorder] Backpressure policy set to " << BackpressurePolicyToString(policy) << std::endl;
+}
+
+void VideoRecorder::SetEncoderThrottle(double milliseconds) {
+    std::lock_guard<std::mutex> lock(encoderMutex);
+    encoderThrottleMs = std::max(0.0, milliseconds);
+    std::cout << "[VideoRecorder] Encoder throttle set to " << encoderThrottleMs << " ms per frame" << std::endl;
+}
+
+BackpressurePolicy VideoRecorder::GetBackpressurePolicy() const {
+    return backpressurePolicy;
+}
+
+EncoderStats VideoRecorder::GetEncoderStats() const {
+    std::lock_guard<std::mutex> lock(encoderMutex);
+    
+    EncoderStats stats = encoderStats;
+    stats.queueDepth = encodeQueue.size();
+    stats.queueCapacity = encodeQueueCapacity;
+    stats.averageEncodeMs = stats.framesEncoded > 0 ? encodeTotalMs / stats.framesEncoded : 0.0;
+    stats.averageCpuMs = stats.framesEncoded > 0 ? encodeCpuSeconds * 1000.0 / stats.framesEncoded : 0.0;
+    stats.inputGBps = encodeTotalMs > 0.0 ? encodedFrameBytes / (encodeTotalMs / 1000.0) / 1e9 : 0.0;
+    return stats;
+}
+
+void VideoRecorder::PrintEncoderStats() const {
+    EncoderStats stats = GetEncoderStats();
+    
+    std::cout << "\n=== ENCODER STATS ===" << std::endl;
+    std::cout << "Backpressure Policy: " << BackpressurePolicyToString(backpressurePolicy) << std::endl;
+    std::cout << "Queue Depth: " << stats.queueDepth << "/" << stats.queueCapacity
+              << " (peak " << stats.maxQueueDepth << ")" << std::endl;
+    std::cout << "Frames Submitted: " << stats.framesSubmitted << std::endl;
+    std::cout << "Frames Encoded: " << stats.framesEncoded << std::endl;
+    std::cout << "Frames Dropped: " << stats.framesDropped << std::endl;
+    std::cout << "Frames Degraded: " << stats.framesDegraded << std::endl;
+    std::cout << "Encoder FPS: " << std::fixed << std::setprecision(1) << stats.encoderFps << std::endl;
+    std::cout << "Output: " << (isRawRecording ? "raw frames" : "encoded video") << std::endl;
+    std::cout << "Average Encode Time: " << std::setprecision(2) << stats.averageEncodeMs << " ms ("
+              << stats.averageCpuMs << " ms CPU)" << std::endl;
+    std::cout << "Input Throughput: " << std::setprecision(3) << stats.inputGBps << " GB/s" << std::endl;
+    if (isRawRecording) {
+        RawFrameWriterStats rawStats = GetRawWriterStats();
+        std::cout << "Raw Disk Throughput: " << rawStats.throughputGBps << " GB/s over " << rawStats.writeCalls
+                  << " writes (" << (rawStats.directIo ? "direct" : "buffered") << " I/O)" << std::endl;
+    }
+    std::cout << "Caller Blocked: " << std::setprecision(1) << stats.blockedMs << " ms" << std::endl;
+    if (!proxyFilename.empty()) {
+        std::cout << "Proxy: " << proxyFilename << " (" << proxyFramesWritten << " frames, "
+                  << proxyFramesDropped << " dropped)" << std::endl;
+    }
+    std::cout << std::endl;
 }
 
 void VideoRecorder::PrintRecordingInfo() const {
@@ -194,16 +1436,37 @@ void VideoRecorder::PrintRecordingInfo() const {
     std::cout << "Recording: " << (isRecording ? "YES" : "NO") << std::endl;
     std::cout << "Resolution: " << frameWidth << "x" << frameHeight << std::endl;
     std::cout << "FPS: " << fps << std::endl;
+    std::cout << "Codec: " << codec << " via backend " << writerApi << ", " << containerExtension << std::endl;
     std::cout << "Output Path: " << outputPath << std::endl;
     std::cout << "Current File: " << currentFilename << std::endl;
-    std::cout << "Buffer Size: " << frameBuffer.size() << "/" << bufferSize << std::endl;
+    std::cout << "Buffer Size: " << GetBufferSize() << "/" << bufferSize << std::endl;
+    std::cout << "Pending Clips: " << GetPendingClipCount() << std::endl;
+    std::cout << "Saved Clips: " << GetSavedClipCount() << std::endl;
+    if (framePool) {
+        FramePoolStats poolStats = framePool->GetStats();
+        std::cout << "Frame Pool: " << poolStats.inUse << "/" << poolStats.capacity << " in use, "
+                  << poolStats.copiesPerFrame << " copies/frame, "
+                  << poolStats.overflowAllocations << " overflow allocations" << std::endl;
+    }
     std::cout << std::endl;
 }
 
 void VideoRecorder::PrintBufferInfo() const {
+    ReplayBufferStats stats = GetReplayBufferStats();
+    
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    
     std::cout << "\n=== FRAME BUFFER INFO ===" << std::endl;
-    std::cout << "Buffer Size: " << frameBuffer.size() << " frames" << std::endl;
-    std::cout << "Max Buffer Size: " << bufferSize << " frames" << std::endl;
+    std::cout << "Buffer Size: " << frameBuffer.size() << " frames (" << stats.compressedFrames << " compressed)" << std::endl;
+    if (replayBudgetBytes > 0) {
+        std::cout << "Memory: " << stats.bytes / (1024 * 1024) << "/" << replayBudgetBytes / (1024 * 1024) << " MB" << std::endl;
+    } else {
+        std::cout << "Max Buffer Size: " << bufferSize << " frames" << std::endl;
+    }
+    std::cout << "Replay Duration: " << replayDuration << " seconds" << std::endl;
+    std::cout << "History: " << stats.historySeconds << "s (" << stats.secondsPerMB << " s/MB)" << std::endl;
+    std::cout << "Avg Frame Size: " << stats.averageFrameKB << " KB" << std::endl;
+    std::cout << "Avg Compression Time: " << stats.averageCompressMs << " ms/frame" << std::endl;
     
     if (!frameBuffer.empty()) {
         std::cout << "Oldest Frame: " << frameBuffer.front().timestamp << "s" << std::endl;
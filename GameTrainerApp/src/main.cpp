@@ -2,13 +2,29 @@
 #include "ScreenCapture.h"
 #include "InputTracker.h"
 #include "ReviewInterface.h"
+#include "OfflineAnalyzer.h"
+#include "CodecBenchmark.h"
+#include "TrackingBenchmark.h"
+#include "ClipIndexBenchmark.h"
+#include "HeatmapAccumulator.h"
+#include "SyntheticChecks.h"
+#include <filesystem>
+#include <set>
+#include <thread>
 
 int main() {
     std::cout << "GameTrainerApp initialized successfully." << std::endl;
     std::cout << "=== GAME TRAINER APP ===" << std::endl;
     std::cout << "1. Background Recording Mode" << std::endl;
     std::cout << "2. Review Mode (Post-Match Analysis)" << std::endl;
-    std::cout << "Choose mode (1 or 2): ";
+    std::cout << "3. Offline Re-Analysis (Recorded Video)" << std::endl;
+    std::cout << "4. Codec Benchmark" << std::endl;
+    std::cout << "5. Tracking Benchmark" << std::endl;
+    std::cout << "6. Session Heatmaps" << std::endl;
+    std::cout << "7. Synthetic Checks" << std::endl;
+    std::cout << "8. Clip Index Benchmark" << std::endl;
+    std::cout << "9. Segmented vs Sequential Analysis" << std::endl;
+    std::cout << "Choose mode (1-9): ";
     
     int mode;
     std::cin >> mode;
@@ -47,6 +63,143 @@ int main() {
         reviewInterface.GenerateTechnicalReport();
         reviewInterface.ShowImprovementPlan();
         
+    } else if (mode == 3) {
+        std::cout << "\n=== OFFLINE RE-ANALYSIS ===" << std::endl;
+        std::cout << "Video file: ";
+        
+        std::string videoPath;
+        std::cin >> videoPath;
+        std::cout << "Map name: ";
+        
+        std::string mapName;
+        std::cin >> mapName;
+        
+        OfflineAnalyzer offlineAnalyzer;
+        offlineAnalyzer.SetMapName(mapName);
+        OfflineAnalysisResult result;
+        if (offlineAnalyzer.Analyze(videoPath, result)) {
+            offlineAnalyzer.PrintResult(result);
+        } else {
+            std::cout << "Offline analysis failed." << std::endl;
+        }
+        
+    } else if (mode == 4) {
+        std::cout << "\n=== CODEC BENCHMARK ===" << std::endl;
+        std::cout << "Recorded video to use, or 'synthetic': ";
+        
+        std::string videoPath;
+        std::cin >> videoPath;
+        
+        CodecBenchmark benchmark;
+        if (videoPath != "synthetic") {
+            benchmark.LoadRecordedFrames(videoPath);
+        }
+        
+        std::vector<CodecBenchmarkResult> results = benchmark.Run();
+        CodecBenchmark::PrintResults(results);
+        CodecBenchmark::SaveResults("./recordings/codec_benchmark.csv", results);
+        
+        CodecBenchmarkResult recommendation;
+        if (CodecBenchmark::Recommend(results, cv::Size(1920, 1080), 60.0, recommendation)) {
+            std::cout << "Recommended for 1920x1080 @ 60 FPS: " << recommendation.backend << "/"
+                      << recommendation.codec << " (" << recommendation.extension << ")" << std::endl;
+        } else {
+            std::cout << "No codec could be opened on this system." << std::endl;
+        }
+        
+    } else if (mode == 5) {
+        std::cout << "\n=== TRACKING BENCHMARK ===" << std::endl;
+        
+        TrackingBenchmark benchmark;
+        std::vector<TrackingBenchmarkResult> results = benchmark.Run();
+        TrackingBenchmark::PrintResults(results);
+        TrackingBenchmark::PrintHistoryResults(benchmark.RunHistory());
+        TrackingBenchmark::PrintIndexResults(benchmark.RunSpatialIndex());
+        TrackingBenchmark::PrintMemoryResults(benchmark.RunBoundedMemory());
+        
+    } else if (mode == 6) {
+        std::cout << "\n=== SESSION HEATMAPS ===" << std::endl;
+        std::cout << "Session directory: ";
+        
+        std::string directory;
+        std::cin >> directory;
+        
+        // A session's heatmap file already covers its archive, and carries its own map name
+        std::error_code error;
+        std::set<std::string> heatmapSessions;
+        std::vector<std::filesystem::path> archivePaths;
+        std::vector<HeatmapSource> sources;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.path().extension() == ".gthm") {
+                heatmapSessions.insert(entry.path().stem().string());
+                sources.push_back({ entry.path().string(), "unknown" });
+            } else if (entry.path().extension() == ".gtta") {
+                archivePaths.push_back(entry.path());
+            }
+        }
+        std::vector<std::filesystem::path> archiveOnly;
+        for (const auto& path : archivePaths) {
+            if (heatmapSessions.count(path.stem().string()) == 0) {
+                archiveOnly.push_back(path);
+            }
+        }
+        if (!archiveOnly.empty()) {
+            std::cout << archiveOnly.size() << " session(s) only have a trajectory archive." << std::endl;
+            std::cout << "Map name for trajectory archives: ";
+            
+            std::string archiveMapName;
+            std::cin >> archiveMapName;
+            for (const auto& path : archiveOnly) {
+                sources.push_back({ path.string(), archiveMapName });
+            }
+        }
+        
+        HeatmapAccumulator heatmaps;
+        if (sources.empty() || !HeatmapAccumulator::Build(sources, static_cast<int>(std::thread::hardware_concurrency()), heatmaps)) {
+            std::cout << "No session heatmaps or trajectory archives could be read." << std::endl;
+        } else {
+            heatmaps.PrintSummary();
+            
+            std::filesystem::create_directories("./recordings", error);
+            cv::Size gridSize = heatmaps.GetResolutions().back();
+            for (const auto& mapName : heatmaps.GetMapNames()) {
+                for (HeatmapLayer layer : { HeatmapLayer::ENEMY_PRESENCE, HeatmapLayer::KILLER_POSITIONS }) {
+                    cv::Mat image = heatmaps.Render(mapName, layer, gridSize, cv::Size(1280, 720));
+                    if (image.empty()) continue;
+                    
+                    std::string filename = "./recordings/heatmap_" + mapName + "_" + HeatmapLayerToString(layer) + ".png";
+                    if (cv::imwrite(filename, image)) {
+                        std::cout << "Saved " << filename << std::endl;
+                    }
+                }
+            }
+        }
+        
+    } else if (mode == 7) {
+        SyntheticChecks checks;
+        SyntheticChecks::PrintResults(checks.Run());
+        
+    } else if (mode == 8) {
+        std::cout << "\n=== CLIP INDEX BENCHMARK ===" << std::endl;
+        
+        ClipIndexBenchmark benchmark;
+        ClipIndexBenchmark::PrintResults(benchmark.Run());
+        
+    } else if (mode == 9) {
+        std::cout << "\n=== SEGMENTED VS SEQUENTIAL ANALYSIS ===" << std::endl;
+        std::cout << "Video file: ";
+        
+        std::string videoPath;
+        std::cin >> videoPath;
+        
+        OfflineAnalyzer offlineAnalyzer;
+        OfflineComparison comparison;
+        if (offlineAnalyzer.Compare(videoPath, comparison)) {
+            offlineAnalyzer.PrintComparison(comparison);
+        } else {
+            std::cout << "Offline analysis failed." << std::endl;
+        }
+        
     } else {
         std::cout << "Invalid mode selected." << std::endl;
     }